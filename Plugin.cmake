@@ -28,6 +28,7 @@ set(OCPN_RELEASE_REPO
     CACHE STRING 
     "Default repository for tagged builds not matching 'beta'"
 )
+option(RADAR_BENCHMARK "Build the headless benchmarks and the navico-source test tool" OFF)
 
 #
 # -------  Plugin setup --------
@@ -72,6 +73,8 @@ set(SRC
   include/RadarCanvas.h
   include/RadarControl.h
   include/RadarControlItem.h
+  include/RadarCapture.h
+  include/RadarCaptureFile.h
   include/RadarDraw.h
   include/RadarDrawShader.h
   include/RadarDrawVertex.h
@@ -81,9 +84,17 @@ set(SRC
   include/Arpa.h
   include/RadarPanel.h
   include/RadarReceive.h
+  include/RadarReplay.h
+  include/RadarTelemetry.h
   include/RadarType.h
   include/SelectDialog.h
+  include/SeqLock.h
+  include/SocketReactor.h
   include/SoftwareControlSet.h
+  include/SpokeHistory.h
+  include/SpokePipeline.h
+  include/SpokePyramid.h
+  include/SpokeQueue.h
   include/TextureFont.h
   include/TrailBuffer.h
   include/drawutil.h
@@ -91,7 +102,9 @@ set(SRC
   include/pi_common.h
   include/radar_pi.h
   include/shaderutil.h
+  include/simdutil.h
   include/socketutil.h
+  include/spokeutil.h
 
   # Source files that are repeatedly included to get a 
   # different effect every time
@@ -104,6 +117,7 @@ set(SRC
   include/emulator/EmulatorControlSet.h
   include/emulator/EmulatorControlsDialog.h
   include/emulator/EmulatorReceive.h
+  include/emulator/EmulatorScenario.h
   include/emulator/emulatortype.h
   include/garminhd/GarminHDControl.h
   include/garminhd/GarminHDControlSet.h
@@ -120,6 +134,7 @@ set(SRC
   include/navico/NavicoControl.h
   include/navico/NavicoControlSet.h
   include/navico/NavicoControlsDialog.h
+  include/navico/NavicoFrame.h
   include/navico/NavicoLocate.h
   include/navico/NavicoReceive.h
   include/navico/br24type.h
@@ -136,6 +151,7 @@ set(SRC
   include/raymarine/RME120type.h
   include/raymarine/RMQuantumtype.h
   include/raymarine/RaymarineCommon.h
+  include/raymarine/RaymarineDecode.h
   include/raymarine/RaymarineLocate.h
   include/raymarine/RMQuantumControlsDialog.h
   include/raymarine/RMQuantumControl.h
@@ -148,6 +164,7 @@ set(SRC
   src/MessageBox.cpp
   src/OptionsDialog.cpp
   src/RadarCanvas.cpp
+  src/RadarCapture.cpp
   src/RadarDraw.cpp
   src/RadarDrawShader.cpp
   src/RadarDrawVertex.cpp
@@ -155,18 +172,28 @@ set(SRC
   src/RadarInfo.cpp
   src/Arpa.cpp
   src/RadarPanel.cpp
+  src/RadarReplay.cpp
+  src/RadarTelemetry.cpp
   src/SelectDialog.cpp
+  src/SocketReactor.cpp
+  src/SpokeHistory.cpp
+  src/SpokePipeline.cpp
+  src/SpokePyramid.cpp
+  src/SpokeQueue.cpp
   src/TextureFont.cpp
   src/TrailBuffer.cpp
   src/drawutil.cpp
   src/icons.cpp
   src/radar_pi.cpp
   src/shaderutil.cpp
+  src/simdutil.cpp
   src/socketutil.cpp
+  src/spokeutil.cpp
 
   src/emulator/EmulatorControl.cpp
   src/emulator/EmulatorControlsDialog.cpp
   src/emulator/EmulatorReceive.cpp
+  src/emulator/EmulatorScenario.cpp
   src/garminhd/GarminHDControl.cpp
   src/garminhd/GarminHDControlsDialog.cpp
   src/garminhd/GarminHDReceive.cpp
@@ -181,6 +208,7 @@ set(SRC
   src/raymarine/RMQuantumControl.cpp
   src/raymarine/RME120ControlsDialog.cpp
   src/raymarine/RaymarineReceive.cpp
+  src/raymarine/RaymarineDecode.cpp
   src/raymarine/RaymarineLocate.cpp
   src/raymarine/RMQuantumControlsDialog.cpp
 )
@@ -202,6 +230,38 @@ macro(late_init)
     ${CMAKE_CURRENT_LIST_DIR}/include/navico
     ${CMAKE_CURRENT_LIST_DIR}/include/raymarine
   )
+
+  if (RADAR_BENCHMARK)
+    # Standalone, does not link to wxWidgets or OpenGL
+    add_executable(radar-bench ${CMAKE_CURRENT_LIST_DIR}/src/Pipeline-bench.cpp)
+    target_include_directories(radar-bench PRIVATE ${CMAKE_CURRENT_LIST_DIR}/include)
+    if (NOT MSVC)
+      target_link_libraries(radar-bench m)
+    endif ()
+    add_executable(condition-bench ${CMAKE_CURRENT_LIST_DIR}/src/SpokeCondition-bench.cpp)
+    target_include_directories(condition-bench PRIVATE ${CMAKE_CURRENT_LIST_DIR}/include)
+    add_executable(raymarine-decode-bench
+      ${CMAKE_CURRENT_LIST_DIR}/src/raymarine/RaymarineDecode-bench.cpp
+    )
+    target_include_directories(raymarine-decode-bench PRIVATE
+      ${CMAKE_CURRENT_LIST_DIR}/include
+      ${CMAKE_CURRENT_LIST_DIR}/include/raymarine
+    )
+    add_executable(garminhd-decode-bench
+      ${CMAKE_CURRENT_LIST_DIR}/src/garminhd/GarminHDDecode-bench.cpp
+    )
+    target_include_directories(garminhd-decode-bench PRIVATE
+      ${CMAKE_CURRENT_LIST_DIR}/include
+    )
+    if (UNIX)
+      # Stand-in Navico radar for end-to-end tests of the receive path
+      add_executable(navico-source ${CMAKE_CURRENT_LIST_DIR}/src/navico/NavicoSource.cpp)
+      target_include_directories(navico-source PRIVATE
+        ${CMAKE_CURRENT_LIST_DIR}/include
+      )
+      target_link_libraries(navico-source m)
+    endif ()
+  endif ()
 endmacro ()
 
 macro(add_plugin_libraries)
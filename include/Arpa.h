@@ -39,6 +39,7 @@
 #include "Kalman.h"
 #include "Matrix.h"
 #include "RadarInfo.h"
+#include "SpokeHistory.h"
 
 PLUGIN_BEGIN_NAMESPACE
 
@@ -112,6 +113,12 @@ public:
     bool MultiPix(int ang, int rad);
 
 private:
+    // The history plane that Pix() looks at
+    HistoryPlane GetPixPlane()
+    {
+        return m_check_for_duplicate ? HISTORY_CONTOUR : HISTORY_TARGET;
+    }
+
     RadarInfo* m_ri;
     radar_pi* m_pi;
     KalmanFilter* m_kalman;
@@ -163,9 +170,12 @@ public:
     }
     void ClearContours();
     int GetTargetCount() { return m_number_of_targets; }
+    int64_t GetRefreshMicros() { return m_refresh_micros; }
 
 private:
     int m_number_of_targets;
+    int64_t m_refresh_micros; // How long the last RefreshArpaTargets took,
+                              // which only runs while ARPA is in use
     ArpaTarget* m_targets[MAX_NUMBER_OF_TARGETS];
     wxLongLong m_doppler_arpa_update_time[SPOKES_MAX];
 
@@ -175,7 +185,6 @@ private:
     void AcquireOrDeleteMarpaTarget(ExtendedPosition p, int status);
     void CalculateCentroid(ArpaTarget* t);
     void DrawContour(ArpaTarget* t);
-    bool Pix(int ang, int rad, bool doppler);
     void SearchDopplerTargets();
     bool IsAtLeastOneRadarTransmitting();
 };
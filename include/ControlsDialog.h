@@ -137,6 +137,7 @@ public:
         m_hide_temporarily = true;
 
         m_from_control = 0;
+        m_controls_epoch = 0;
 
         m_panel_position = wxDefaultPosition;
 
@@ -346,6 +347,9 @@ protected:
     // Edit Controls
     RadarControlButton* m_from_control; // Only set when in edit mode
 
+    uint32_t m_controls_epoch; // RadarInfo::m_controls_epoch when the buttons
+                               // were last updated
+
     // The 'edit' control has these buttons:
     wxButton* m_plus_ten_button;
     wxButton* m_plus_button;
@@ -459,6 +463,7 @@ protected:
     void SetMenuAutoHideTimeout();
     void SwitchTo(wxBoxSizer* to, const wxChar* name);
     bool UpdateSizersButtonsShown();
+    void UpdateControlButtons(bool refreshAll);
 
 public:
     void Resize(bool force);
@@ -593,9 +598,7 @@ class RadarControlButton : public wxButton {
     friend class RadarRangeControlButton;
 
 public:
-    RadarControlButton() {
-
-    };
+    RadarControlButton() { m_version = 0; };
 
     RadarControlButton(ControlsDialog* parent, wxWindowID id,
         const wxString& label, ControlInfo& ctrl, RadarControlItem* item,
@@ -626,6 +629,7 @@ public:
 
         this->SetFont(m_parent->m_pi->m_font);
         m_item = item;
+        m_version = 0;
         UpdateLabel(true);
     }
 
@@ -646,6 +650,7 @@ public:
 private:
     wxString firstLine;
     bool m_no_edit;
+    uint32_t m_version; // Of m_item when the label was last set
 
     ControlsDialog* m_parent;
     radar_pi* m_pi; // could be accessed through m_parent but the M_SETTINGS
@@ -97,8 +97,7 @@ public:
     /*
      * Check if data is in this GuardZone, if so update bogeyCount
      */
-    void ProcessSpoke(
-        SpokeBearing angle, uint8_t* data, uint8_t* hist, size_t len);
+    void ProcessSpoke(SpokeBearing angle, uint8_t* data, size_t len);
 
     // Find targets inside the zone
     void SearchTargets();
@@ -126,6 +125,7 @@ private:
     int m_bogey_count; // complete cycle
     int m_running_count; // current swipe
 
+    void AddReturns(uint8_t* data, size_t len, size_t range_start, size_t range_end);
     void UpdateSettings();
 };
 
@@ -0,0 +1,105 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _RADARCAPTURE_H_
+#define _RADARCAPTURE_H_
+
+#include "RadarCaptureFile.h"
+#include "radar_pi.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+#define RADAR_CAPTURE_EXTENSION wxT("rcap")
+
+// How many bytes of frames may be waiting for the writer before we start
+// dropping frames, so that a slow disk never stalls a receive thread.
+#define RADAR_CAPTURE_QUEUE_MAX (32 * 1024 * 1024)
+
+//
+// Writes a capture file for one radar.
+//
+// AddFrame() and MarkRotation() are called by the receive thread; they only
+// copy the frame into a queue. The actual file writes are done by this thread.
+//
+
+class RadarCapture : public wxThread {
+public:
+    RadarCapture(RadarInfo* ri);
+    ~RadarCapture();
+
+    bool Open(const wxString& filename);
+    void Close();
+
+    void AddFrame(const uint8_t* data, size_t len, wxLongLong time,
+        const NetworkAddress& source);
+    void MarkRotation();
+    wxString GetStatusText();
+
+    void* Entry(void);
+
+    wxString m_filename;
+
+private:
+    struct CaptureBlock {
+        CaptureBlock* next;
+        bool rotation; // Marks start of rotation, no record
+        RadarCaptureRecord record;
+        uint8_t data[1]; // Really record.len bytes
+    };
+
+    size_t WriteBlocks(CaptureBlock* block);
+    void WriteIndex();
+
+    RadarInfo* m_ri;
+    FILE* m_file;
+    wxSemaphore m_wakeup; // Posted when blocks are queued or on Close()
+
+    wxCriticalSection m_exclusive; // protects the following
+    CaptureBlock* m_head;
+    CaptureBlock* m_tail;
+    size_t m_queued_bytes;
+    bool m_stop;
+    uint32_t m_frames; // Frames accepted into the queue
+    uint32_t m_dropped; // Frames dropped because queue was full
+
+    // Only used by the writer thread
+    uint64_t m_offset; // Current file offset
+    uint64_t m_last_record_offset;
+    int64_t m_last_record_time;
+    uint32_t m_records; // Records written so far
+    RadarCaptureIndexEntry* m_index;
+    size_t m_index_count;
+    size_t m_index_allocated;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _RADARCAPTURE_H_ */
@@ -0,0 +1,101 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _RADARCAPTUREFILE_H_
+#define _RADARCAPTUREFILE_H_
+
+#include <stdint.h>
+
+//
+// Raw radar capture file.
+//
+// The capture recorder stores every raw frame that a receive thread passes to
+// its decoder, so that a session can be replayed offline later. All values are
+// stored in host byte order (little endian on all supported platforms).
+//
+// The layout of a capture file is:
+//
+//   RadarCaptureFileHeader
+//   RadarCaptureRecord + payload    (repeated, one per raw frame)
+//   RadarCaptureIndexEntry          (repeated, one per antenna rotation)
+//   RadarCaptureTrailer
+//
+// The trailer is at a fixed offset from the end of the file and points at the
+// index, so a reader can seek straight to any rotation. A file without a valid
+// trailer (for instance because the plugin crashed) can still be read
+// sequentially.
+//
+// This header only uses plain types, so that standalone tools such as
+// radar-bench and navico-source can read capture files without wxWidgets.
+//
+
+#define RADAR_CAPTURE_MAGIC "RADARCAP"
+#define RADAR_CAPTURE_INDEX_MAGIC "RCAPINDX"
+#define RADAR_CAPTURE_VERSION (1)
+
+#pragma pack(push, 1)
+
+struct RadarCaptureFileHeader {
+    char magic[8]; // RADAR_CAPTURE_MAGIC
+    uint32_t version; // RADAR_CAPTURE_VERSION
+    uint32_t radar_type; // RadarType of the recorded radar
+    uint32_t spokes; // Spokes per rotation of that radar type
+    uint32_t spoke_len_max; // Max spoke length of that radar type
+    int64_t start_time; // Millis since epoch when recording started
+};
+
+struct RadarCaptureRecord {
+    uint32_t len; // Length of the payload following this record
+    uint16_t radar_type; // RadarType that received the frame
+    uint16_t flags; // Reserved, 0
+    int64_t time; // Receive time, millis since epoch
+    uint32_t source_addr; // IPv4 address of the radar, network order
+    uint16_t source_port; // Port of the radar, network order
+    uint16_t reserved;
+};
+
+struct RadarCaptureIndexEntry {
+    uint64_t offset; // File offset of the record in which a rotation starts
+    int64_t time; // Receive time of that record
+    uint32_t record; // Sequence number of that record, counting from 0
+    uint32_t reserved;
+};
+
+struct RadarCaptureTrailer {
+    uint64_t index_offset; // File offset of the first RadarCaptureIndexEntry
+    uint32_t index_count; // Number of RadarCaptureIndexEntry
+    uint32_t record_count; // Number of RadarCaptureRecord in the file
+    char magic[8]; // RADAR_CAPTURE_INDEX_MAGIC
+};
+
+#pragma pack(pop)
+
+#endif /* _RADARCAPTUREFILE_H_ */
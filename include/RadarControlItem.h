@@ -32,6 +32,8 @@
 #ifndef _RADAR_CONTROL_ITEM_H_
 #define _RADAR_CONTROL_ITEM_H_
 
+#include <atomic>
+
 #include "pi_common.h"
 
 PLUGIN_BEGIN_NAMESPACE
@@ -44,6 +46,16 @@ class radar_pi;
 //
 // Some controls are always only just a value.
 // Some other controls have state as well.
+//
+// The value and state can be read from any thread without a lock, so the
+// spoke processing thread can read them for every spoke. Writers are
+// serialised by m_exclusive, which also keeps the button copy consistent.
+//
+// Every change of what the button should show increments the version, and
+// the epoch of the radar that owns the item when SetEpoch() was called. A
+// control dialog can then skip all items of a radar whose epoch has not moved,
+// and each button can skip an item whose version it has already shown, even
+// when the item is shared between radars.
 
 enum RadarControlState {
     RCS_OFF = -1,
@@ -71,6 +83,8 @@ public:
                                     // sets proper value + mod
         m_button_s = RCS_OFF;
         m_mod = true;
+        m_version = 1; // So that a button that has seen version 0 shows it
+        m_epoch = 0;
         m_min = VALUE_NOT_SET;
         m_max = VALUE_NOT_SET;
         m_fraction = 0;
@@ -78,6 +92,7 @@ public:
 
     // The copy constructor
     RadarControlItem(const RadarControlItem& other)
+        : RadarControlItem()
     {
         Update(other.m_value, other.m_state);
     }
@@ -91,6 +106,10 @@ public:
         return *this;
     }
 
+    // Changes are counted in `epoch` as well, which belongs to the radar
+    // that owns this item. Set once, before any other thread uses the item.
+    void SetEpoch(std::atomic<uint32_t>* epoch) { m_epoch = epoch; }
+
     // The assignment constructor to allow "item = value"
     RadarControlItem& operator=(int v)
     {
@@ -102,9 +121,9 @@ public:
     {
         wxCriticalSectionLocker lock(m_exclusive);
         if (v != m_button_v || s != m_button_s) {
-            m_mod = true;
             m_button_v = v;
             m_button_s = s;
+            Modified();
         }
         m_value = v;
         m_state = s;
@@ -115,8 +134,8 @@ public:
         wxCriticalSectionLocker lock(m_exclusive);
 
         if (s != m_button_s) {
-            m_mod = true;
             m_button_s = s;
+            Modified();
         }
         m_state = s;
     };
@@ -158,20 +177,15 @@ public:
         return m_button_v;
     }
 
-    int GetValue()
-    {
-        wxCriticalSectionLocker lock(m_exclusive);
-
-        return m_value;
-    }
+    int GetValue() { return m_value.load(std::memory_order_relaxed); }
 
     RadarControlState GetState()
     {
-        wxCriticalSectionLocker lock(m_exclusive);
-
-        return m_state;
+        return m_state.load(std::memory_order_relaxed);
     }
 
+    uint32_t GetVersion() { return m_version.load(std::memory_order_acquire); }
+
     bool IsModified()
     {
         wxCriticalSectionLocker lock(m_exclusive);
@@ -211,12 +225,24 @@ public:
     }
 
 protected:
+    // Called with m_exclusive held when the button copy changes
+    void Modified()
+    {
+        m_mod = true;
+        m_version.fetch_add(1, std::memory_order_release);
+        if (m_epoch) {
+            m_epoch->fetch_add(1, std::memory_order_release);
+        }
+    }
+
     wxCriticalSection m_exclusive;
-    int m_value;
+    std::atomic<int> m_value;
     int m_button_v;
-    RadarControlState m_state;
+    std::atomic<RadarControlState> m_state;
     RadarControlState m_button_s;
     bool m_mod;
+    std::atomic<uint32_t> m_version;
+    std::atomic<uint32_t>* m_epoch;
     int m_max; // added for Raymarine
     int m_min;
 
@@ -247,8 +273,8 @@ public:
         wxCriticalSectionLocker lock(m_exclusive);
 
         if (v != m_button_v) {
-            m_mod = true;
             m_button_v = v;
+            Modified();
         }
         m_value = v;
     };
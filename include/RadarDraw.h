@@ -52,6 +52,23 @@ public:
     virtual ~RadarDraw() = 0;
 
     static void GetDrawingMethods(wxArrayString& methods);
+
+protected:
+    RadarDraw()
+    {
+        m_lut_transparency = -1;
+        m_lut_version = 0;
+    }
+
+    // Strength straight to packed RGBA bytes, see RadarInfo::BuildColourLUT().
+    // Each draw method keeps its own table, so it needs no lock other than the
+    // one the draw method holds anyway.
+    const uint32_t* GetColourLUT(RadarInfo* ri, int transparency);
+
+private:
+    int m_lut_transparency;
+    uint32_t m_lut_version; // RadarInfo::m_colour_map_version it was built from
+    uint32_t m_lut[UINT8_MAX + 1];
 };
 
 PLUGIN_END_NAMESPACE
@@ -33,6 +33,7 @@
 #define _RADARDRAWSHADER_H_
 
 #include "RadarDraw.h"
+#include "SpokePyramid.h"
 
 PLUGIN_BEGIN_NAMESPACE
 
@@ -52,6 +53,10 @@ public:
         m_format = GL_RGBA;
         m_channels = SHADER_COLOR_CHANNELS;
         m_data = 0;
+        m_pyramid = 0;
+        m_level = 0;
+        m_transparency = 0;
+        m_drawn_generation = 0;
         m_spokes = 0;
         m_spoke_len_max = 0;
     }
@@ -70,11 +75,15 @@ private:
     wxCriticalSection m_exclusive; // protects the following data structures
     unsigned char*
         m_data; // [SHADER_COLOR_CHANNELS * m_spokes * m_spoke_len_max];
+    SpokePyramid* m_pyramid; // The received spokes, at all levels
+    int m_level; // Pyramid level that is in m_data and the texture
+    int m_transparency; // Of the last spoke received
+    uint32_t m_drawn_generation; // Generation the texture was last uploaded for
     size_t m_spokes;
     size_t m_spoke_len_max;
 
-    int m_start_line; // First line received since last draw, or -1
-    int m_lines; // # of lines received since last draw
+    int m_start_line; // First line (of m_level) received since last draw, or -1
+    int m_lines; // # of lines (of m_level) received since last draw
 
     int m_format;
     int m_channels;
@@ -85,6 +94,9 @@ private:
     GLuint m_program;
 
     void Reset();
+    void DrawRadarImage(double pixels_per_sample);
+    void ConvertLine(size_t line, uint32_t generation);
+    void SetLevel(int level);
 };
 
 PLUGIN_END_NAMESPACE
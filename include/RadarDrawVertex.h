@@ -33,6 +33,7 @@
 #define _RADARDRAWVERTEX_H_
 
 #include "RadarDraw.h"
+#include "SpokePyramid.h"
 #include "drawutil.h"
 
 PLUGIN_BEGIN_NAMESPACE
@@ -47,6 +48,10 @@ public:
 
         m_ri = ri;
         m_vertices = 0;
+        m_spoke_info = 0;
+        m_pyramid = 0;
+        m_level = 0;
+        m_transparency = 0;
         m_count = 0;
         m_oom = false;
         m_spokes = 0;
@@ -77,8 +82,8 @@ private:
 
     struct VertexPoint {
         Point xy;
-        GLubyte red;
-        GLubyte green;
+        GLubyte red; // red, green, blue and alpha are filled as one
+        GLubyte green; // packed value from RadarDraw::GetColourLUT()
         GLubyte blue;
         GLubyte alpha;
     };
@@ -89,14 +94,27 @@ private:
         size_t count;
         size_t allocated;
         GeoPosition spoke_pos;
+        uint32_t generation; // RadarInfo::m_image_generation it was built in
     };
 
+    struct SpokeInfo {
+        time_t timeout;
+        GeoPosition spoke_pos;
+        uint32_t generation;
+    };
+
+    void SetLevel(double pixels_per_sample);
+    void BuildLine(size_t row);
     void SetBlob(VertexLine* line, int angle_begin, int angle_end, int r1,
-        int r2, GLubyte red, GLubyte green, GLubyte blue, GLubyte alpha);
+        int r2, uint32_t rgba);
 
     void Reset();
     wxCriticalSection m_exclusive; // protects the following
-    VertexLine* m_vertices;
+    VertexLine* m_vertices; // [m_spokes], of which the first GetSpokes(m_level) are used
+    SpokeInfo* m_spoke_info; // [m_spokes], when and where each spoke was received
+    SpokePyramid* m_pyramid; // The received spokes, at all levels
+    int m_level; // Pyramid level that m_vertices is built from
+    int m_transparency; // Of the last spoke received
     unsigned int m_count;
     bool m_oom;
 };
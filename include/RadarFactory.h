@@ -41,6 +41,8 @@ public:
     static ControlsDialog* MakeControlsDialog(size_t radarType, int radar);
     static RadarReceive* MakeRadarReceive(
         size_t radarType, radar_pi* pi, RadarInfo* ri);
+    static RadarReceive* MakeRadarDecoder(
+        size_t radarType, radar_pi* pi, RadarInfo* ri);
     static RadarControl* MakeRadarControl(
         size_t radarType, radar_pi* pi, RadarInfo* ri);
     static size_t GetRadarRanges(
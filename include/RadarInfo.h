@@ -32,9 +32,13 @@
 #ifndef _RADAR_INFO_H_
 #define _RADAR_INFO_H_
 
+#include <atomic>
+
 #include "ControlsDialog.h"
 #include "RadarControlItem.h"
 #include "RadarReceive.h"
+#include "RadarTelemetry.h"
+#include "SeqLock.h"
 #include "radar_pi.h"
 
 PLUGIN_BEGIN_NAMESPACE
@@ -43,7 +47,11 @@ class RadarDraw;
 class RadarCanvas;
 class RadarPanel;
 class GuardZoneBogey;
+class RadarCapture;
 class RadarInfo;
+class SpokeHistory;
+class SpokePipeline;
+class SpokeQueue;
 class TrailBuffer;
 
 struct DrawInfo {
@@ -69,12 +77,15 @@ enum {
 
 class RadarInfo {
     friend class TrailBuffer;
+    friend class SpokePipeline;
 
 public:
     wxString m_name; // Either "Radar", "Radar A", "Radar B".
     radar_pi* m_pi; // Pointer back to the plugin
     size_t m_radar; // Which radar this is [0..RADARS>
     RadarType m_radar_type; // Which radar type
+    wxString m_config_radar_type; // Radar%dType to save when m_radar_type was
+                                  // taken from a replay file, else empty
     size_t m_spokes; // # of spokes per rotation
     size_t m_spoke_len_max; // Max # of bytes per spoke
     size_t m_no_transmit_zones;
@@ -104,7 +115,18 @@ public:
     double m_panel_zoom; // zooming factor for the panel image
 
     Arpa* m_arpa;
-    wxCriticalSection m_exclusive;
+    wxCriticalSection m_exclusive; // protects the history, guard zones and ARPA
+                                   // targets. Held by the spoke processing
+                                   // thread for every spoke.
+    wxCriticalSection m_draw_lock; // protects m_draw_panel.draw and
+                                   // m_draw_overlay.draw. Held by the spoke
+                                   // processing thread to use them and by the
+                                   // GUI thread to replace them. Taken after
+                                   // m_exclusive when both are needed.
+    wxCriticalSection m_receive_exclusive; // protects m_statistics and m_capture.
+                                           // Only held briefly, so that the
+                                           // receive thread never waits for
+                                           // drawing or ARPA.
 
     /* User radar settings */
 
@@ -170,6 +192,8 @@ public:
     RadarControlItem m_coarse_tune;
     RadarControlItem m_magnetron_current;
     RadarControlItem m_color_gain;
+    std::atomic<uint32_t> m_controls_epoch; // Incremented by every change of
+                                            // the controls above
     uint8_t m_stay_alive_type;
 
     bool m_showManualValueInAuto; // Does radar adjust manual value in auto
@@ -194,10 +218,13 @@ public:
 
     /* Abstractions of our own. Some filled by RadarReceive. */
 
-    time_t m_radar_timeout; // When we consider the radar no longer valid
-    time_t m_data_timeout; // When we consider the data to be obsolete (radar no
-                           // longer sending data)
-    time_t m_stayalive_timeout; // When we will send another stayalive ping
+    std::atomic<time_t>
+        m_radar_timeout; // When we consider the radar no longer valid
+    std::atomic<time_t>
+        m_data_timeout; // When we consider the data to be obsolete (radar no
+                        // longer sending data)
+    std::atomic<time_t>
+        m_stayalive_timeout; // When we will send another stayalive ping
 #define STAYALIVE_TIMEOUT (1) // Send data every 1 seconds to ping radar
 #define DATA_TIMEOUT (5)
 
@@ -209,19 +236,23 @@ public:
     double m_ebl[ORIENTATION_NUMBER][BEARING_LINES];
     double m_vrm[BEARING_LINES];
     receive_statistics m_statistics;
+    RadarTelemetry m_telemetry; // Receive health, has its own lock
 
     struct line_history {
-        uint8_t* line;
         wxLongLong time;
         GeoPosition pos;
     };
 
     line_history* m_history;
+    wxLongLong GetHistoryTime(SpokeBearing angle);
+    SpokeHistory* m_history_bits; // Strong returns per spoke, for ARPA
+    std::atomic<uint32_t> m_image_generation; // Bumped by ResetSpokes(), older drawn spokes are empty
 
     int m_old_range;
     int m_dir_lat;
     int m_dir_lon;
     TrailBuffer* m_trails;
+    SpokePipeline* m_pipeline; // The stages of ProcessRadarSpoke
 
     // Timed Transmit
     time_t m_idle_standby; // When we will change to standby
@@ -242,6 +273,13 @@ public:
         RadarControlButton* button);
     void ProcessRadarSpoke(SpokeBearing angle, SpokeBearing bearing,
         uint8_t* data, size_t len, int range_meters, wxLongLong time);
+    uint8_t* ReserveRadarSpoke(size_t len);
+    void QueueRadarSpoke(SpokeBearing angle, SpokeBearing bearing,
+        uint8_t* data, size_t len, int range_meters, wxLongLong time);
+    void UpdateQueueStatistics();
+    void SetSpokeQueueBlocking(bool blocking);
+    void DrainSpokeQueue();
+    uint64_t GetSpokesProcessed();
     void RefreshDisplay();
     void RenderGuardZone();
     void ResetRadarImage();
@@ -255,29 +293,19 @@ public:
     void CalculateRotationSpeed(SpokeBearing angle);
     void UpdateTransmitState();
     void RequestRadarState(RadarState state);
-    int GetDrawTime()
-    {
-        wxCriticalSectionLocker lock(m_exclusive);
-        return IsPaneShown() ? m_draw_time_ms : 0;
-    };
-    int GetDopplerCount()
-    {
-        wxCriticalSectionLocker lock(m_exclusive);
-        int r = m_doppler_count;
-        m_doppler_count = 0;
-        return r;
-    }
+    bool StartCapture(const wxString& filename);
+    void StopCapture();
+    void CaptureFrame(const uint8_t* data, size_t len, wxLongLong time, const NetworkAddress& source);
+    wxString GetCaptureStatus();
+    int GetDrawTime() { return IsPaneShown() ? m_draw_time_ms.load() : 0; };
+    int GetDopplerCount() { return m_doppler_count.exchange(0); }
     bool IsPaneShown();
 
-    void resetTimeout(time_t now)
-    {
-        wxCriticalSectionLocker lock(m_exclusive);
-
-        m_radar_timeout = now + WATCHDOG_TIMEOUT;
-    };
+    void resetTimeout(time_t now) { m_radar_timeout = now + WATCHDOG_TIMEOUT; };
 
     void UpdateControlState(bool all);
     void ComputeColourMap();
+    void BuildColourLUT(int transparency, uint32_t* rgba);
     double GetBrightness();  // Returns brightness factor for current color scheme
     void ComputeTargetTrails();
     void CheckTimedTransmit();
@@ -293,9 +321,11 @@ public:
     void SampleCourse(int angle);
     int GetOrientation();
     void ClearTrails();
+    // Only called on the GUI thread, which makes it the single writer of
+    // m_radar_position.
     void SetRadarPosition(GeoPosition boat_pos, double heading)
     {
-        wxCriticalSectionLocker lock(m_exclusive);
+        GeoPosition radar_pos = boat_pos;
 
         if (m_antenna_starboard.GetValue() != 0
             || m_antenna_forward.GetValue() != 0) {
@@ -305,15 +335,14 @@ public:
                 = (double)m_antenna_forward.GetValue() / 1852 / 60;
             double dist_starboard
                 = (double)m_antenna_starboard.GetValue() / 1852 / 60;
-            m_radar_position.lat
+            radar_pos.lat
                 = dist_forward * cosine - dist_starboard * sine + boat_pos.lat;
-            m_radar_position.lon
+            radar_pos.lon
                 = (dist_forward * sine + dist_starboard * cosine)
                     / cos(deg2rad(boat_pos.lat))
                 + boat_pos.lon;
-        } else {
-            m_radar_position = boat_pos;
         }
+        m_radar_position.Store(radar_pos);
     }
 
     bool GetRadarPosition(GeoPosition* pos);
@@ -340,6 +369,7 @@ public:
     // m_settings.display_option.
     PixelColour m_colour_map_rgb[BLOB_COLOURS];
     BlobColour m_colour_map[UINT8_MAX + 1];
+    std::atomic<uint32_t> m_colour_map_version; // Bumped by ComputeColourMap()
 
     // Speedup PolarToCartesian lookup (angle,radius) -> (x, y)
     PolarToCartesianLookup* m_polar_lookup;
@@ -366,21 +396,29 @@ private:
 
     int m_previous_auto_range_meters;
 
-    //  wxCriticalSection m_exclusive;  // protects the following two
+    // m_draw_lock protects the following two
     DrawInfo m_draw_panel; // Draw onto our own panel
     DrawInfo m_draw_overlay; // Abstract painting method
 
     int m_verbose;
-    int m_draw_time_ms; // Number of millis spent drawing
-    int m_doppler_count; // Number of doppler approaching pixels seen
+    std::atomic<int> m_draw_time_ms; // Number of millis spent drawing
+    std::atomic<int>
+        m_doppler_count; // Number of doppler approaching pixels seen
 
     wxString m_range_text;
 
-    BlobColour m_trail_colour[TRAIL_MAX_REVOLUTIONS + 1];
+    uint8_t m_trail_colour[TRAIL_MAX_REVOLUTIONS + 1]; // BlobColour per trail age, for spokeutil.h
 
     int m_previous_orientation;
 
-    GeoPosition m_radar_position;
+    SeqLock<GeoPosition> m_radar_position;
+
+    wxCriticalSection m_address_exclusive; // protects the radar addresses and
+                                           // location info in the accessors
+
+    RadarCapture* m_capture; // Raw frame recorder, protected by m_receive_exclusive
+    SpokeBearing m_capture_last_angle; // Previous queued angle, receive thread only
+    SpokeQueue* m_spoke_queue; // Decoded spokes waiting for ProcessRadarSpoke
 };
 
 PLUGIN_END_NAMESPACE
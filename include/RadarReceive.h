@@ -36,10 +36,16 @@
 
 PLUGIN_BEGIN_NAMESPACE
 
+class SocketReactor;
+
 //
 // The base class for a specific implementation of a thread
 // that receives data from a radar.
 //
+// Implementations that override StartOnReactor can instead have their
+// sockets served by the shared SocketReactor, in which case the thread is
+// never started.
+//
 
 class RadarReceive : public wxThread {
 public:
@@ -49,12 +55,47 @@ public:
         Create(1024 * 1024); // Stack size, be liberal
         m_pi = pi; // This allows you to access the main plugin stuff
         m_ri = ri; // and this the per-radar stuff
+        m_reactor = 0;
     }
 
     virtual ~RadarReceive() { }
 
     virtual void* Entry(void) = 0;
 
+    /*
+     * Start
+     *
+     * Start receiving, on the reactor when one is passed and the
+     * implementation supports it, otherwise by running the thread.
+     */
+    bool Start(SocketReactor* reactor)
+    {
+        if (reactor) {
+            m_reactor = reactor;
+            if (StartOnReactor()) {
+                return true;
+            }
+            m_reactor = 0;
+        }
+        return StartThread();
+    }
+
+    /*
+     * Stop
+     *
+     * Stop receiving and wait until no more data will be processed.
+     */
+    void Stop()
+    {
+        if (m_reactor) {
+            StopOnReactor();
+            m_reactor = 0;
+            return;
+        }
+        Shutdown();
+        Wait();
+    }
+
     /*
      * GetInfoStatus
      *
@@ -77,9 +118,50 @@ public:
     virtual void Shutdown(void) = 0;
     virtual SOCKET GetCommSocket() { return INVALID_SOCKET; }
 
+    /*
+     * ReplayFrame
+     *
+     * Decode a raw frame that was recorded by RadarCapture as if it was just
+     * received from the radar, from the recorded source at the recorded time.
+     * Called by RadarReplay on an object whose thread is never started.
+     */
+    virtual void ReplayFrame(const uint8_t* data, size_t len, wxLongLong time,
+        const NetworkAddress& source) {};
+
+    /*
+     * OnTimer
+     *
+     * Called from the main thread on every plugin timer tick, for work
+     * that has to be done on the main thread.
+     */
+    virtual void OnTimer() {};
+
 protected:
+    /*
+     * StartThread
+     *
+     * Run the thread, after setting up anything that only it needs.
+     */
+    virtual bool StartThread() { return Run() == wxTHREAD_NO_ERROR; }
+
+    /*
+     * StartOnReactor
+     *
+     * Add a handler and its sockets to m_reactor, or return false to have
+     * the thread run instead.
+     */
+    virtual bool StartOnReactor() { return false; }
+
+    /*
+     * StopOnReactor
+     *
+     * Remove the handler and its sockets from m_reactor and close them.
+     */
+    virtual void StopOnReactor() {};
+
     radar_pi* m_pi;
     RadarInfo* m_ri;
+    SocketReactor* m_reactor; // Set while served by the reactor
 };
 
 PLUGIN_END_NAMESPACE
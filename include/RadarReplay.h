@@ -0,0 +1,111 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _RADARREPLAY_H_
+#define _RADARREPLAY_H_
+
+#include "RadarCapture.h"
+#include "RadarReceive.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+//
+// A receive thread that plays back a capture file written by RadarCapture.
+//
+// The raw frames are fed into the normal receive object for the recorded
+// radar type (which is constructed but never started as a thread), so the
+// data follows exactly the same decode -> ProcessRadarSpoke -> trails ->
+// guard zone -> ARPA path as live data does.
+//
+// Speed 1 plays back in real time, N plays back N times faster and 0 plays
+// back as fast as the decoders can go.
+//
+
+class RadarReplay : public RadarReceive {
+public:
+    RadarReplay(radar_pi* pi, RadarInfo* ri, const wxString& filename,
+        double speed)
+        : RadarReceive(pi, ri)
+    {
+        m_filename = filename;
+        m_speed = speed;
+        m_shutdown = false;
+        m_decoder = 0;
+        m_map = 0;
+        m_map_len = 0;
+        m_receive_socket = GetLocalhostServerTCPSocket();
+        m_send_socket = GetLocalhostSendTCPSocket(m_receive_socket);
+        SetInfoStatus(wxString::Format(
+            wxT("%s: %s"), m_ri->m_name.c_str(), _("Initializing")));
+        LOG_RECEIVE(wxT("%s replay thread created"), m_ri->m_name.c_str());
+    };
+
+    ~RadarReplay();
+
+    void* Entry(void);
+    void Shutdown(void);
+    wxString GetInfoStatus();
+
+    static bool ReadFileHeader(
+        const wxString& filename, RadarCaptureFileHeader* header);
+
+private:
+    bool MapFile();
+    void UnmapFile();
+    void ReplayFile();
+    bool WaitMillis(int64_t millis);
+
+    wxString m_filename;
+    double m_speed;
+    volatile bool m_shutdown;
+
+    RadarReceive* m_decoder; // Receive object for recorded radar type
+
+    uint8_t* m_map; // Capture file contents
+    size_t m_map_len;
+
+    SOCKET m_receive_socket; // Where we listen for message from m_send_socket
+    SOCKET m_send_socket; // A message to this socket will interrupt select()
+                          // and allow immediate shutdown
+
+    wxCriticalSection m_lock; // Protects m_status
+    wxString m_status; // Userfriendly string
+
+    void SetInfoStatus(wxString status)
+    {
+        wxCriticalSectionLocker lock(m_lock);
+        m_status = status;
+    }
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _RADARREPLAY_H_ */
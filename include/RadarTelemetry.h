@@ -0,0 +1,140 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _RADARTELEMETRY_H_
+#define _RADARTELEMETRY_H_
+
+#include "pi_common.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+//
+// Receive health of one radar.
+//
+// The receive thread reports every frame it decodes and the spoke processing
+// thread reports how long it waited for RadarInfo::m_exclusive and when the
+// antenna completes a rotation. Every holder of m_exclusive that matters, the
+// spoke processing thread and the ARPA refresh, reports how long it held it.
+// Totals count from the start of the plugin; rates, maxima and percentiles are
+// for the last complete TELEMETRY_WINDOW_MICROS window, so any number of
+// readers can take a snapshot without disturbing each other.
+//
+
+#define TELEMETRY_WINDOW_MICROS (1000000)
+#define TELEMETRY_DECODE_BUCKETS (16)  // Bucket i counts decode times < 2^i us, the last one the rest
+#define TELEMETRY_ROTATIONS (16)       // Rotation periods kept to compute the jitter
+
+struct RadarTelemetryWindow {
+    int64_t packets;
+    int64_t bytes;
+    int64_t decode[TELEMETRY_DECODE_BUCKETS];
+    int64_t decode_max; // us
+    int64_t gaps;
+    int64_t gap_total; // us
+    int64_t gap_max; // us
+    int64_t lock_waits;
+    int64_t lock_wait_total; // us
+    int64_t lock_wait_max; // us
+    int64_t lock_holds;
+    int64_t lock_hold_total; // us
+    int64_t lock_hold_max; // us
+    int64_t socket_drops;
+};
+
+struct RadarTelemetrySnapshot {
+    // Totals since the start
+    int64_t packets;
+    int64_t bytes;
+    int64_t decode[TELEMETRY_DECODE_BUCKETS]; // Histogram of decode time per frame
+    int64_t lock_waits;
+    int64_t lock_wait_total; // us
+    int64_t lock_holds;
+    int64_t lock_hold_total; // us
+    int64_t socket_drops; // Datagrams the kernel dropped because the socket buffer was full
+
+    // Last complete window
+    double packets_per_second;
+    double bytes_per_second;
+    int decode_p50; // us
+    int decode_p99; // us
+    int decode_max; // us
+    double gap_mean; // us between frames seen by the receive thread
+    int gap_max; // us
+    double lock_wait_mean; // us per spoke
+    int lock_wait_max; // us
+    double lock_hold_mean; // us per hold
+    int lock_hold_max; // us
+    int socket_drops_per_second;
+
+    // Last TELEMETRY_ROTATIONS rotations
+    int rotations;
+    double rotation_period; // ms
+    double rotation_jitter; // ms, standard deviation of the period
+};
+
+class RadarTelemetry {
+public:
+    RadarTelemetry();
+
+    // Monotonic time in microseconds, for the start_time arguments below
+    static int64_t Now();
+
+    void AddFrame(size_t len, int64_t start_time, uint32_t socket_drops);
+    void AddLockWait(int64_t start_time);
+    void AddLockHold(int64_t start_time);
+    void AddRotation(int period_millis);
+
+    void GetSnapshot(RadarTelemetrySnapshot* snapshot);
+    static wxString FormatJSON(const wxString& name, wxLongLong time,
+        const RadarTelemetrySnapshot& snapshot);
+    // Escape a string for use inside a JSON string literal
+    static wxString JSONEscape(const wxString& str);
+
+private:
+    void Roll(int64_t now);
+
+    wxCriticalSection m_exclusive; // protects all of the following
+
+    RadarTelemetryWindow m_total;
+    RadarTelemetryWindow m_current;
+    RadarTelemetryWindow m_last;
+    int64_t m_window_start;
+    int64_t m_last_window_length;
+    int64_t m_last_frame;
+    uint32_t m_last_socket_drops;
+
+    int m_rotation[TELEMETRY_ROTATIONS];
+    int m_rotations;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _RADARTELEMETRY_H_ */
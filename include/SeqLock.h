@@ -0,0 +1,110 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _SEQLOCK_H_
+#define _SEQLOCK_H_
+
+#include <string.h>
+
+#include <atomic>
+#include <type_traits>
+
+#include "pi_common.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+//
+// A small value that is written now and then and read all the time, such as
+// the radar position. Readers never block the writer or each other: they copy
+// the value and try again when a write happened in the meantime, which the
+// sequence number shows by being odd during a write or different afterwards.
+//
+// The value is kept in atomic words so that a read that overlaps a write is
+// not a data race, just a copy that is thrown away. There can only be one
+// writer at a time; callers that write from several threads must serialise
+// those writes themselves.
+//
+
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+
+public:
+    SeqLock()
+        : m_sequence(0)
+    {
+        for (size_t i = 0; i < WORDS; i++) {
+            m_word[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Store(const T& value)
+    {
+        uint64_t word[WORDS] = { 0 };
+        uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+
+        memcpy(word, &value, sizeof(T));
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++) {
+            m_word[i].store(word[i], std::memory_order_relaxed);
+        }
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    T Load() const
+    {
+        uint64_t word[WORDS];
+        uint32_t sequence;
+
+        do {
+            sequence = m_sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; i++) {
+                word[i] = m_word[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((sequence & 1) != 0 || m_sequence.load(std::memory_order_relaxed) != sequence);
+
+        T value;
+        memcpy(&value, word, sizeof(T));
+        return value;
+    }
+
+private:
+    static const size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> m_sequence;
+    std::atomic<uint64_t> m_word[WORDS];
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _SEQLOCK_H_ */
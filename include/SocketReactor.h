@@ -0,0 +1,115 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _SOCKETREACTOR_H_
+#define _SOCKETREACTOR_H_
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include "pi_common.h"
+#include "socketutil.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+//
+// Something that owns sockets served by a SocketReactor.
+//
+// OnReadable is called when one of its sockets has data, OnTick about once
+// every tick interval given to AddHandler. Both run on the reactor thread, never at the
+// same time, so a handler needs no more locking than it would need when
+// running its own thread.
+//
+
+class SocketReactorHandler {
+public:
+    virtual void OnReadable(SOCKET socket) = 0;
+    virtual void OnTick() { }
+    virtual ~SocketReactorHandler() { }
+};
+
+//
+// A single thread that waits for all registered sockets using epoll and
+// calls their handlers, instead of every locator running its own select()
+// loop. Shutdown wakes it immediately through an eventfd, as does adding a
+// handler that wants to tick more often than REACTOR_TICK_MILLIS.
+//
+// Only available on Linux; elsewhere Start() fails and the callers fall back
+// to their own threads.
+//
+
+#define REACTOR_TICK_MILLIS (1000)
+
+class SocketReactor : public wxThread {
+public:
+    SocketReactor();
+    ~SocketReactor();
+
+    static bool IsSupported();
+
+    bool Start();
+    void Shutdown(void);
+
+    // Add and remove handlers and sockets. May be called from any thread,
+    // including from within a handler. Once a Remove call returns the
+    // handler will not be called again for that socket.
+    void AddHandler(
+        SocketReactorHandler* handler, int tick_millis = REACTOR_TICK_MILLIS);
+    void RemoveHandler(SocketReactorHandler* handler);
+    bool Add(SOCKET socket, SocketReactorHandler* handler);
+    void Remove(SOCKET socket);
+
+protected:
+    void* Entry(void);
+
+private:
+    struct Handler {
+        SocketReactorHandler* handler;
+        std::chrono::milliseconds tick;
+        std::chrono::steady_clock::time_point next_tick;
+    };
+
+    std::chrono::steady_clock::time_point Tick();
+    void Wake();
+
+    int m_epoll;
+    int m_wake;
+    volatile bool m_shutdown;
+
+    wxCriticalSection m_exclusive; // protects the following, held while calling handlers
+    std::map<SOCKET, SocketReactorHandler*> m_sockets;
+    std::vector<Handler> m_handlers;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _SOCKETREACTOR_H_ */
@@ -0,0 +1,112 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _SPOKEHISTORY_H_
+#define _SPOKEHISTORY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef PLUGIN_BEGIN_NAMESPACE  // Standalone tools define their own
+#include "pi_common.h"
+#endif
+#include "simdutil.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+//
+// The strong returns of the last rotation that ARPA and the guard zones search
+// for targets. Every flag is a separate plane of one bit per sample, packed in
+// 64 bit words, so a spoke of 1024 samples takes 16 words per plane.
+//
+// When a spoke arrives every strong return is set in both the target and the
+// contour plane. A blob that becomes a target is cleared from the target plane
+// so that it is not found again in the same rotation, but stays in the contour
+// plane so that targets can still be checked for duplicates. A blob that is too
+// small is cleared from both. The doppler plane marks approaching doppler
+// returns.
+//
+// Clear() does not touch the planes: it starts a new generation, and every row
+// that was written in an older generation reads as empty until the next spoke
+// at that bearing calls MarkRow().
+//
+// Not locked itself, used with RadarInfo::m_exclusive held. Does not need
+// wxWidgets, so that radar-bench searches the same history as ARPA.
+//
+
+enum HistoryPlane { HISTORY_TARGET, HISTORY_CONTOUR, HISTORY_DOPPLER, HISTORY_PLANES };
+
+class SpokeHistory {
+public:
+    SpokeHistory(size_t spokes, size_t spoke_len_max);
+    ~SpokeHistory();
+
+    size_t GetWords() { return m_words; }
+    uint64_t* GetRow(HistoryPlane plane, int angle)
+    {
+        return m_plane[plane] + angle * m_words;
+    }
+    void MarkRow(int angle) { m_row_generation[angle] = m_generation; }
+    bool IsCurrent(int angle) { return m_row_generation[angle] == m_generation; }
+    bool Get(HistoryPlane plane, int angle, int rad)
+    {
+        return IsCurrent(angle) && ((GetRow(plane, angle)[rad >> 6] >> (rad & 63)) & 1) != 0;
+    }
+
+    void Clear();
+    size_t ConditionRow(int angle, uint8_t* data, size_t len, size_t main_bang, uint8_t threshold, uint8_t strong);
+    void ClearRange(HistoryPlane plane, int angle, int r_first, int r_last);
+    int Find(HistoryPlane plane, bool doppler, int angle, int r_first, int r_end);
+    int Count(HistoryPlane plane, bool doppler, int angle_first, int angle_last, int r_first, int r_last);
+    bool HasContour(HistoryPlane plane, bool doppler, int angle, int rad, int length);
+
+private:
+    int ModSpokes(int angle) { return (angle % (int)m_spokes + (int)m_spokes) % (int)m_spokes; }
+    bool Pix(HistoryPlane plane, bool doppler, int angle, int rad)
+    {
+        if (rad <= 0 || rad >= (int)m_spoke_len_max) {
+            return false;
+        }
+        angle = ModSpokes(angle);
+        return Get(plane, angle, rad) && (!doppler || Get(HISTORY_DOPPLER, angle, rad));
+    }
+
+    size_t m_spokes;
+    size_t m_spoke_len_max;
+    size_t m_words; // per spoke per plane
+    uint64_t* m_plane[HISTORY_PLANES]; // [m_spokes * m_words]
+    uint32_t m_generation; // Incremented by Clear()
+    uint32_t* m_row_generation; // [m_spokes], generation each row was written in
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _SPOKEHISTORY_H_ */
@@ -0,0 +1,137 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _SPOKEPIPELINE_H_
+#define _SPOKEPIPELINE_H_
+
+#include <atomic>
+
+#include "radar_pi.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+//
+// The processing of a received spoke, split into stages.
+//
+// RadarInfo::ProcessRadarSpoke() fills in a SpokeContext and runs it through
+// the stages in order, with m_ri->m_exclusive held. A stage whose feature is
+// not in use (IsActive() false) is skipped without doing any work. Stages can
+// also be switched off per radar with the "Radar<n>SpokeStagesOff" setting, a
+// comma separated list of stage names; the stages that the rest of the
+// pipeline depends on cannot be switched off.
+//
+// The time spent in every stage is measured, so that it can be shown as
+// ns/spoke in the statistics. The counters are atomic so that they can be
+// read without taking m_exclusive.
+//
+
+#define SPOKE_STAGES (12)
+
+struct SpokeContext {
+    SpokeBearing angle; // Bearing (relative to Boat)  at which the spoke is seen.
+    SpokeBearing bearing; // Bearing (relative to North) at which the spoke is seen.
+    uint8_t* data; // A line of len bytes, each byte represents strength at that distance.
+    size_t len; // Number of returns
+    size_t trail_len; // Number of returns that trails are computed for
+    int range_meters; // Range (in meters) of this data
+    wxLongLong time; // Time at which the spoke was received
+    bool stabilized_mode; // Store at 'bearing' instead of 'angle' in the panel
+};
+
+class SpokeStage {
+public:
+    SpokeStage(RadarInfo* ri, const char* name, bool required)
+    {
+        m_ri = ri;
+        m_name = name;
+        m_required = required;
+    }
+    virtual ~SpokeStage() { }
+
+    // Is the feature that this stage implements in use?
+    virtual bool IsActive() { return true; }
+    // Process the spoke. Returns false when the spoke should not be processed
+    // any further.
+    virtual bool Process(SpokeContext* spoke) = 0;
+
+    const char* GetName() { return m_name; }
+    bool IsRequired() { return m_required; }
+
+protected:
+    RadarInfo* m_ri;
+
+private:
+    const char* m_name;
+    bool m_required;
+};
+
+struct SpokeStageTiming {
+    const char* name;
+    bool enabled;
+    int spokes; // Spokes processed since the last GetTimings()
+    int ns_per_spoke;
+};
+
+class SpokePipeline {
+public:
+    SpokePipeline(RadarInfo* ri);
+    ~SpokePipeline();
+
+    void Process(SpokeContext* spoke);
+
+    bool SetStageEnabled(const wxString& name, bool enabled);
+    void SetDisabledStages(const wxString& names);
+    wxString GetDisabledStages();
+    size_t GetTimings(SpokeStageTiming* timings);
+
+private:
+    class CourseStage;
+    class GeometryStage;
+    class ConditionStage;
+    class GuardZoneStage;
+    class ExtremeRangeStage;
+    class OverlayStage;
+    class TrailsStage;
+    class PanelStage;
+
+    void Add(SpokeStage* stage);
+
+    RadarInfo* m_ri;
+    size_t m_count;
+    SpokeStage* m_stage[SPOKE_STAGES];
+    std::atomic<bool> m_enabled[SPOKE_STAGES];
+    std::atomic<int64_t> m_spokes[SPOKE_STAGES];
+    std::atomic<int64_t> m_ns[SPOKE_STAGES];
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _SPOKEPIPELINE_H_ */
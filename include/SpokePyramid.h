@@ -0,0 +1,91 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _SPOKEPYRAMID_H_
+#define _SPOKEPYRAMID_H_
+
+#include "radar_pi.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+#define PYRAMID_LEVELS (3) // Full resolution, 1/2 and 1/4 in both spokes and range
+
+//
+// The polar image at decreasing resolutions, so that the draw methods do not
+// have to convert or upload every sample when the image is shown so small that
+// many samples end up on a single screen pixel.
+//
+// Level 0 holds the spokes as received. Each sample of level n is the maximum
+// of two by two samples of level n - 1 (two spokes, two ranges), so that small
+// or weak targets are not averaged away. The coarser levels are updated as each
+// spoke arrives.
+//
+// Every row remembers the RadarInfo::m_image_generation it was written in. When
+// pooling, a neighbouring row from an older generation counts as empty.
+//
+// Not locked itself, used with the lock of the owning RadarDraw held.
+//
+
+class SpokePyramid {
+public:
+    SpokePyramid(size_t spokes, size_t spoke_len_max);
+    ~SpokePyramid();
+
+    void SetSpoke(SpokeBearing angle, uint8_t* data, size_t len, uint32_t generation);
+    int ChooseLevel(double pixels_per_sample);
+
+    size_t GetSpokes(int level) { return m_level[level].spokes; }
+    size_t GetSpokeLen(int level) { return m_level[level].spoke_len; }
+    uint8_t* GetRow(int level, size_t row)
+    {
+        return m_level[level].data + row * m_level[level].spoke_len;
+    }
+    bool IsCurrent(int level, size_t row, uint32_t generation)
+    {
+        return m_level[level].generation[row] == generation;
+    }
+
+private:
+    struct Level {
+        size_t spokes;
+        size_t spoke_len;
+        uint8_t* data; // [spokes * spoke_len]
+        uint32_t* generation; // [spokes]
+    };
+
+    size_t m_spokes;
+    size_t m_spoke_len_max;
+    Level m_level[PYRAMID_LEVELS];
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _SPOKEPYRAMID_H_ */
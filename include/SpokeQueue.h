@@ -0,0 +1,115 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _SPOKEQUEUE_H_
+#define _SPOKEQUEUE_H_
+
+#include <atomic>
+
+#include "radar_pi.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Number of decoded spokes that can be waiting for the processing thread.
+// About half a rotation for the radars with the most spokes; must be a power of 2.
+#define SPOKE_QUEUE_SIZE (1024)
+
+//
+// Single producer, single consumer ring of decoded spokes.
+//
+// The receive thread decodes each spoke and calls Push(), which copies the
+// spoke into a free slot. A decoder that first asks Reserve() for the slot can
+// decode straight into it, and then Push() does not copy. This thread takes
+// the spokes off the ring and passes them to RadarInfo::ProcessRadarSpoke()
+// while holding m_ri->m_exclusive and m_ri->m_draw_lock. So when the UI
+// thread holds either for a long time the spokes pile up here instead of in
+// the kernel socket buffer.
+//
+// For a live radar Push() never blocks: when the ring is full the spoke is
+// dropped and counted. A replay reads from a file that will not overflow, so
+// it calls SetBlocking(true) and then Push() waits for a free slot instead.
+//
+
+class SpokeQueue : public wxThread {
+public:
+    SpokeQueue(RadarInfo* ri, size_t spoke_len_max);
+    ~SpokeQueue();
+
+    bool Start();
+    void Stop();
+
+    uint8_t* Reserve(size_t len);
+    bool Push(SpokeBearing angle, SpokeBearing bearing, const uint8_t* data,
+        size_t len, int range_meters, wxLongLong time);
+    void GetStatistics(int* depth, int* high_water, int* overflows);
+    void SetBlocking(bool blocking) { m_blocking = blocking; }
+    void Drain();
+    uint64_t GetProcessed() { return m_processed; }
+
+    void* Entry(void);
+
+private:
+    struct QueuedSpoke {
+        SpokeBearing angle;
+        SpokeBearing bearing;
+        size_t len;
+        int range_meters;
+        wxLongLong time;
+        uint8_t* data; // m_spoke_len_max bytes in m_data
+    };
+
+    RadarInfo* m_ri;
+    size_t m_spoke_len_max;
+    QueuedSpoke m_spokes[SPOKE_QUEUE_SIZE];
+    uint8_t* m_data; // SPOKE_QUEUE_SIZE * m_spoke_len_max
+
+    wxSemaphore m_wakeup; // Posted when the ring becomes non-empty or on Stop()
+    std::atomic<bool> m_stop;
+
+    bool WaitForDepth(int max_depth);
+
+    std::atomic<bool> m_blocking; // Push() waits for a free slot
+    std::atomic<bool> m_producer_waiting; // Producer wants m_space posted
+    wxSemaphore m_space; // Posted when a slot is freed and the producer waits
+
+    // m_head is only written by the producer, m_tail only by the consumer.
+    // Both count upwards and wrap at 2^32, the slot is the count modulo the size.
+    std::atomic<uint32_t> m_head;
+    std::atomic<uint32_t> m_tail;
+
+    std::atomic<int> m_high_water; // Max depth since last GetStatistics()
+    std::atomic<int> m_overflows; // Spokes dropped since last GetStatistics()
+    std::atomic<uint64_t> m_processed; // Spokes processed since Start()
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _SPOKEQUEUE_H_ */
@@ -33,6 +33,7 @@
 #define _DRAWUTIL_H_
 
 #include "pi_common.h"
+#include "spokeutil.h"
 
 PLUGIN_BEGIN_NAMESPACE
 
@@ -48,11 +49,6 @@ typedef struct {
     float y;
 } Point;
 
-typedef struct {
-    int16_t x;
-    int16_t y;
-} PointInt;
-
 // Allocated arrays are not two dimensional, so we make
 // up a macro that makes it look that way. Note the 'stride'
 // which is the length of the 2nd dimension, not the 1st.
@@ -110,6 +106,11 @@ public:
     {
         return M_XYI((angle + m_spokes) % m_spokes, radius);
     };
+    // All points of one spoke, for the loops in spokeutil.h
+    const PointInt* GetPointIntRow(size_t angle)
+    {
+        return &M_XYI((angle + m_spokes) % m_spokes, 0);
+    }
 };
 
 extern void DrawRoundRect(
@@ -32,16 +32,26 @@
 #ifndef _EMULATORRECEIVE_H_
 #define _EMULATORRECEIVE_H_
 
+#include "EmulatorScenario.h"
 #include "RadarReceive.h"
-#include "socketutil.h"
+#include "SocketReactor.h"
 
 PLUGIN_BEGIN_NAMESPACE
 
 //
 // An intermediary class that implements the common parts of any Emulator radar.
 //
+// It is a timer driven producer: every few ms OnTick() generates the spokes
+// that are due at the configured spoke count and rotation speed, so it can
+// load the spoke pipeline up to and beyond what real radars send. OnTick() is
+// called by the shared SocketReactor when there is one, otherwise by the
+// receive thread. It has no sockets.
+//
+// With an EmulatorScenario configured it renders the moving targets of the
+// scenario instead of the fixed test pattern.
+//
 
-class EmulatorReceive : public RadarReceive {
+class EmulatorReceive : public RadarReceive, public SocketReactorHandler {
 public:
     EmulatorReceive(radar_pi* pi, RadarInfo* ri)
         : RadarReceive(pi, ri)
@@ -49,32 +59,60 @@ public:
         m_shutdown = false;
         m_next_spoke = 0;
         m_next_rotation = 0;
-        m_receive_socket = GetLocalhostServerTCPSocket();
-        m_send_socket = GetLocalhostSendTCPSocket(m_receive_socket);
+        m_spokes_due = 0.;
+        m_random = 0x9E3779B9;
+        m_new_rotation = false;
+        m_last_tick = 0;
+        m_spokes_per_micro = 0.;
+        m_scenario = 0;
+        if (!M_SETTINGS.emulator_scenario.IsEmpty()) {
+            m_scenario = new EmulatorScenario();
+            if (!m_scenario->Load(
+                    M_SETTINGS.emulator_scenario, IsFirstEmulator())) {
+                delete m_scenario;
+                m_scenario = 0;
+            }
+        }
         LOG_RECEIVE(wxT("%s receive thread created"), m_ri->m_name.c_str());
     };
 
     ~EmulatorReceive()
     {
-        closesocket(m_receive_socket);
-        closesocket(m_send_socket);
+        if (m_scenario) {
+            delete m_scenario;
+        }
     }
 
     void* Entry(void);
     void Shutdown(void);
     wxString GetInfoStatus();
+    void OnTimer();
+
+    // SocketReactorHandler
+    void OnReadable(SOCKET) { }
+    void OnTick();
+
+protected:
+    bool StartOnReactor();
+    void StopOnReactor();
 
 private:
-    void EmulateFakeBuffer(void);
+    void StartEmulating();
+    bool IsFirstEmulator();
+    bool EmulateFakeBuffer(size_t spokes);
+    void EmulateSpoke(int angle, int bearing, uint8_t* data, size_t len,
+        int range_meters, bool max_range, int* spots);
 
     volatile bool m_shutdown;
 
     int m_next_spoke; // emulator next spoke
     int m_next_rotation; // slowly rotate emulator
-
-    SOCKET m_receive_socket; // Where we listen for message from m_send_socket
-    SOCKET m_send_socket; // A message to this socket will interrupt select()
-                          // and allow immediate shutdown
+    double m_spokes_due; // Spokes that should have been sent, but weren't yet
+    uint32_t m_random; // xorshift state for the clutter
+    bool m_new_rotation; // A rotation was completed in the last batch
+    int64_t m_last_tick; // RadarTelemetry::Now() of the previous OnTick()
+    double m_spokes_per_micro;
+    EmulatorScenario* m_scenario; // Moving targets, or 0 for the test pattern
 };
 
 PLUGIN_END_NAMESPACE
@@ -0,0 +1,130 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _EMULATORSCENARIO_H_
+#define _EMULATORSCENARIO_H_
+
+#include "radar_pi.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+//
+// A scenario of moving targets for the emulator, with ground truth.
+//
+// The scenario is read from a text file with one item per line:
+//
+//   ownship <lat> <lon> <course> <speed>   own ship start, degrees and knots
+//   target <range> <bearing> <course> <speed> [<size>]
+//                                          metres, degrees true, knots, metres
+//   random <count> <min range> <max range> <max speed> [<max size>]
+//   dropout <percent>                      chance a target is missed in a sweep
+//   clutter <percent>                      overrides EmulatorClutter
+//   seed <number>                          for 'random' and 'dropout'
+//   truth <filename>                       append the true positions here
+//
+// Targets are placed relative to the own ship at the start and then move in
+// a flat frame in metres around that point. Without an 'ownship' line the
+// own ship follows the boat position that the plugin already has. With one,
+// the scenario moves the own ship itself and passes it to OpenCPN as RMC and
+// HDT sentences, so ARPA sees the same boat motion that is rendered.
+//
+// Once per rotation one JSON line is appended to the truth file with the own
+// ship, every target and the ARPA target count and refresh time, so tracking
+// latency and acquisition time can be measured against the TTM sentences
+// that ARPA sends. The refresh time is that of the last RefreshArpaTargets(),
+// which the plugin only runs while ARPA is in use, so it stays 0 or stale
+// until a guard zone with ARPA or a target is active.
+//
+// When several emulators run the same scenario only the first one is the
+// owner: it moves the own ship, sends the NMEA and writes the truth file.
+// The others start from the same origin and then follow the boat position
+// like a scenario without an 'ownship' line.
+//
+
+struct ScenarioTarget {
+    double x; // metres east of the origin
+    double y; // metres north of the origin
+    double course; // degrees true
+    double speed; // metres per second
+    double size; // metres, 0 is a point target
+    bool visible; // painted in the current rotation
+
+    // Position in the current batch of spokes
+    double bearing; // in spokes, true
+    double half_width; // in spokes
+    size_t r_first; // first sample
+    size_t r_last; // last sample, smaller than r_first when out of range
+};
+
+class EmulatorScenario {
+public:
+    EmulatorScenario();
+    ~EmulatorScenario();
+
+    bool Load(const wxString& filename, bool owner);
+    int GetClutter(int clutter) { return m_clutter >= 0 ? m_clutter : clutter; }
+
+    void Advance(int64_t now, bool pos_valid, GeoPosition radar_pos);
+    void Prepare(size_t spokes, size_t len, int range_meters);
+    int RenderSpoke(int bearing, uint8_t* data, size_t len);
+    void NewRotation();
+    void WriteTruth(const wxString& radar, int arpa_targets,
+        int64_t arpa_refresh_micros);
+    void PassOwnShipToOpenCPN();
+
+private:
+    bool Random(uint32_t percent);
+    double Uniform(double low, double high);
+    GeoPosition ToGeo(double x, double y);
+
+    wxCriticalSection m_exclusive; // protects the own ship against the main thread
+    bool m_started; // origin is known
+    bool m_ownship_moves; // own ship is simulated, not the boat position
+    GeoPosition m_origin;
+    double m_ownship_x;
+    double m_ownship_y;
+    double m_ownship_course;
+    double m_ownship_speed; // metres per second
+    int64_t m_time; // RadarTelemetry::Now() of the last Advance
+
+    std::vector<ScenarioTarget> m_targets;
+    size_t m_spokes;
+    int m_dropout;
+    int m_clutter; // -1 when not set
+    uint32_t m_random; // xorshift state
+    uint32_t m_rotation;
+
+    FILE* m_truth;
+};
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _EMULATORSCENARIO_H_ */
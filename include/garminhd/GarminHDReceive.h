@@ -65,11 +65,25 @@ public:
         LOG_RECEIVE(wxT("%s receive thread created"), m_ri->m_name.c_str());
     };
 
-    ~GarminHDReceive() { }
+    ~GarminHDReceive()
+    {
+        // Entry() closes these, but it never runs when used by RadarReplay
+        if (m_send_socket != INVALID_SOCKET) {
+            closesocket(m_send_socket);
+        }
+        if (m_receive_socket != INVALID_SOCKET) {
+            closesocket(m_receive_socket);
+        }
+    }
 
     void* Entry(void);
     void Shutdown(void);
     wxString GetInfoStatus();
+    void ReplayFrame(const uint8_t* data, size_t len, wxLongLong time,
+        const NetworkAddress& source)
+    {
+        ProcessReport(data, len, time, source);
+    }
 
     NetworkAddress m_interface_addr;
     NetworkAddress m_report_addr;
@@ -79,8 +93,8 @@ public:
     volatile bool m_is_shutdown;
 
 private:
-    void ProcessFrame(radar_line* packet);
-    bool ProcessReport(const uint8_t* data, size_t len);
+    void ProcessFrame(const radar_line* packet, wxLongLong time_rec);
+    bool ProcessReport(const uint8_t* data, size_t len, wxLongLong time_rec, const NetworkAddress& source);
 
     bool IsValidGarminAddress(struct ifaddrs* nif);
     SOCKET PickNextEthernetCard();
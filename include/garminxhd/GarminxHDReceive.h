@@ -65,11 +65,25 @@ public:
         LOG_RECEIVE(wxT("%s receive thread created"), m_ri->m_name.c_str());
     };
 
-    ~GarminxHDReceive() { }
+    ~GarminxHDReceive()
+    {
+        // Entry() closes these, but it never runs when used by RadarReplay
+        if (m_send_socket != INVALID_SOCKET) {
+            closesocket(m_send_socket);
+        }
+        if (m_receive_socket != INVALID_SOCKET) {
+            closesocket(m_receive_socket);
+        }
+    }
 
     void* Entry(void);
     void Shutdown(void);
     wxString GetInfoStatus();
+    void ReplayFrame(const uint8_t* data, size_t len, wxLongLong time,
+        const NetworkAddress& source)
+    {
+        ProcessFrame(data, len, time, source);
+    }
 
     NetworkAddress m_interface_addr;
     NetworkAddress m_data_addr;
@@ -80,7 +94,7 @@ public:
     volatile bool m_is_shutdown;
 
 private:
-    void ProcessFrame(const uint8_t* data, size_t len);
+    void ProcessFrame(const uint8_t* data, size_t len, wxLongLong time_rec, const NetworkAddress& source);
     bool ProcessReport(const uint8_t* data, size_t len);
 
     bool IsValidGarminAddress(struct ifaddrs* nif);
@@ -0,0 +1,126 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _NAVICOFRAME_H_
+#define _NAVICOFRAME_H_
+
+#include <stdint.h>
+
+#include "NavicoCommon.h"
+
+// Layout of the spoke frames that Navico radars send to their data address.
+// Only plain types, so that standalone tools such as radar-bench and
+// navico-source use the same definitions as NavicoReceive.
+
+#pragma pack(push, 1)
+
+struct common_header {
+    uint8_t headerLen; // 1 bytes
+    uint8_t status; // 1 bytes
+    uint8_t scan_number; // 1 byte
+    uint8_t u00[1]; // 1 byte, 2nd byte of scan_number on 4G and older
+    uint8_t u01[4]; // 4 bytes
+    uint8_t angle[2]; // 2 bytes
+    uint8_t heading[2]; // 2 bytes heading with RI-10/11. See bitmask
+                        // explanation in NavicoReceive.cpp.
+};
+
+struct br24_header {
+    uint8_t headerLen; // 1 bytes
+    uint8_t status; // 1 bytes
+    uint8_t scan_number[2]; // 2 bytes, 0-4095
+    uint8_t mark[4]; // 4 bytes 0x00, 0x44, 0x0d, 0x0e
+    uint8_t angle[2]; // 2 bytes
+    uint8_t heading[2]; // 2 bytes heading with RI-10/11.
+    uint8_t range[4]; // 4 bytes
+    uint8_t u01[2]; // 2 bytes blank
+    uint8_t u02[2]; // 2 bytes
+    uint8_t u03[4]; // 4 bytes blank
+}; /* total size = 24 */
+
+struct br4g_header {
+    uint8_t headerLen; // 1 bytes
+    uint8_t status; // 1 bytes
+    uint8_t scan_number[2]; // 2 bytes, 0-4095
+    uint8_t u00[2]; // Always 0x4400 (integer)
+    uint8_t largerange[2]; // 2 bytes or -1
+    uint8_t angle[2]; // 2 bytes
+    uint8_t heading[2]; // 2 bytes heading with RI-10/11 or -1.
+    uint8_t smallrange[2]; // 2 bytes or -1
+    uint8_t rotation[2]; // 2 bytes, rotation/angle
+    uint8_t u02[4]; // 4 bytes signed integer, always -1
+    uint8_t u03[4]; // 4 bytes signed integer, mostly -1 (0x80 in last byte) or
+                    // 0xa0 in last byte
+}; /* total size = 24 */
+
+struct radar_line {
+    union {
+        common_header common;
+        br24_header br24;
+        br4g_header br4g;
+    };
+    uint8_t data[NAVICO_SPOKE_LEN / 2];
+};
+
+/* Normally the packets are have 32 spokes, or scan lines, but we assume nothing
+ * so we take up to 120 spokes. This is the nearest round figure without going
+ * over 64kB.
+ */
+
+struct radar_frame_pkt {
+    uint8_t frame_hdr[8];
+    radar_line line[120]; //  scan lines, or spokes
+};
+
+#pragma pack(pop)
+
+// Each byte of radar_line data holds two samples, low nibble first. This maps
+// a nibble to a strength and makes space for BLOB_HISTORY_COLORS.
+static const uint8_t lookupNibbleToByte[16] = {
+    0, // 0
+    0x32, // 1
+    0x40, // 2
+    0x4e, // 3
+    0x5c, // 4
+    0x6a, // 5
+    0x78, // 6
+    0x86, // 7
+    0x94, // 8
+    0xa2, // 9
+    0xb0, // a
+    0xbe, // b
+    0xcc, // c
+    0xda, // d
+    0xe8, // e
+    0xf4, // f
+};
+
+#endif /* _NAVICOFRAME_H_ */
@@ -35,6 +35,7 @@
 #include <map>
 
 #include "NavicoCommon.h"
+#include "SocketReactor.h"
 #include "radar_pi.h"
 #include "socketutil.h"
 
@@ -49,14 +50,17 @@ PLUGIN_BEGIN_NAMESPACE
 // ports. The individual radars will then listen to multicast data on those
 // ports.
 //
+// When a SocketReactor is passed the sockets are served by the reactor
+// thread and no thread of its own is started.
+//
 
-class NavicoLocate : public wxThread {
+class NavicoLocate : public wxThread, public SocketReactorHandler {
 public:
-    NavicoLocate(radar_pi* pi)
+    NavicoLocate(radar_pi* pi, SocketReactor* reactor = 0)
         : wxThread(wxTHREAD_JOINABLE)
     {
-        Create(64 * 1024); // Stack size
         m_pi = pi; // This allows you to access the main plugin stuff
+        m_reactor = reactor;
         m_shutdown = false;
         m_is_shutdown = true;
 
@@ -64,12 +68,14 @@ public:
         m_socket = 0;
         m_interface_count = 0;
         m_report_count = 0;
+        m_rescan_network_cards = 0;
+        m_wake_timeout = 0;
         m_errors.Clear();
-
-        SetPriority(wxPRIORITY_MAX);
-        LOG_INFO(wxT("NavicoLocate thread created, prio= %i"), GetPriority());
     }
 
+    bool Start();
+    void Stop();
+
     void AppendErrors(wxString& status);
 
     /*
@@ -89,10 +95,15 @@ public:
 
     volatile bool m_is_shutdown;
 
+    // SocketReactorHandler
+    void OnReadable(SOCKET socket);
+    void OnTick();
+
 protected:
     void* Entry(void);
 
 private:
+    void ReceiveReport(size_t i);
     bool ProcessReport(const NetworkAddress& radar_address,
         const NetworkAddress& interface_address, const uint8_t* data,
         size_t len);
@@ -108,6 +119,7 @@ private:
     void AddError(wxString& error);
 
     radar_pi* m_pi;
+    SocketReactor* m_reactor;
     volatile bool m_shutdown;
 
     // Three arrays, all created on each call to UpdateEthernetCards.
@@ -117,6 +129,9 @@ private:
     size_t m_interface_count;
     size_t m_report_count;
 
+    int m_rescan_network_cards;
+    int m_wake_timeout;
+
     wxString m_errors;
 
     wxCriticalSection m_exclusive;
@@ -34,6 +34,7 @@
 
 #include "NavicoCommon.h"
 #include "RadarReceive.h"
+#include "SocketReactor.h"
 #include "navico/NavicoLocate.h"
 #include "socketutil.h"
 
@@ -55,11 +56,23 @@ PLUGIN_BEGIN_NAMESPACE
 
 extern SOCKET g_HaloInfoSocket;
 
+// Maximum number of frames drained from the data socket per select() wakeup
+#define NAVICO_RECEIVE_BATCH (16)
+
+// Maximum number of ethernet cards probed at the same time
+#define NAVICO_MAX_PROBES (16)
+
+// Maximum number of frames held back while waiting for an earlier frame
+#define NAVICO_REORDER_FRAMES (4)
+
 //
 // An intermediary class that implements the common parts of any Navico radar.
 //
+// The sockets are either served by its own thread, see Entry(), or by the
+// shared SocketReactor through OnReadable() and OnTick().
+//
 
-class NavicoReceive : public RadarReceive {
+class NavicoReceive : public RadarReceive, public SocketReactorHandler {
 public:
     NavicoReceive(radar_pi* pi, RadarInfo* ri, NetworkAddress reportAddr,
         NetworkAddress dataAddr, NetworkAddress sendAddr)
@@ -80,9 +93,27 @@ public:
         m_halo_sent_mystery = m_halo_received_info;
         m_halo_sent_speed = m_halo_received_info;
         m_hours = 0;
+        m_batch_data = 0;
+        m_reorder_data = 0;
+        m_held = 0;
+        m_gap_start = 0;
+        m_gap_len = 0;
+        m_probes = 0;
+        m_sockets_open_elapsed = 0;
+        m_first_report_elapsed = 0;
+        m_data_socket = INVALID_SOCKET;
+        m_report_socket = INVALID_SOCKET;
+        m_info_socket = INVALID_SOCKET;
+        m_no_data_timeout = 0;
+        m_no_spoke_timeout = 0;
+        m_received = false;
+        m_receiving = false;
+        m_next_idle = 0;
+        m_retry_after = 0;
+        m_frame = 0;
 
-        m_receive_socket = GetLocalhostServerTCPSocket();
-        m_send_socket = GetLocalhostSendTCPSocket(m_receive_socket);
+        m_receive_socket = INVALID_SOCKET; // See StartThread()
+        m_send_socket = INVALID_SOCKET;
         SetInfoStatus(wxString::Format(
             wxT("%s: %s"), m_ri->m_name.c_str(), _("Initializing")));
         SetPriority(70); // Priority of receive thread should be lower than prio
@@ -116,13 +147,31 @@ public:
                      //  write these to radar_pi
     };
 
-    ~NavicoReceive() {};
+    ~NavicoReceive()
+    {
+        // Entry() closes these, unless the thread failed to start
+        if (m_send_socket != INVALID_SOCKET) {
+            closesocket(m_send_socket);
+        }
+        if (m_receive_socket != INVALID_SOCKET) {
+            closesocket(m_receive_socket);
+        }
+    }
 
     void InitializeLookupData();
 
     void* Entry(void);
     void Shutdown(void);
     wxString GetInfoStatus();
+    void ReplayFrame(const uint8_t* data, size_t len, wxLongLong time,
+        const NetworkAddress& source)
+    {
+        ProcessFrame(data, len, time, source);
+    }
+
+    // SocketReactorHandler
+    void OnReadable(SOCKET socket);
+    void OnTick();
 
     NetworkAddress m_interface_addr;
     RadarLocationInfo m_info;
@@ -131,14 +180,36 @@ public:
         m_shutdown_time_requested; // Main thread asks this thread to stop
     volatile bool m_is_shutdown;
 
+protected:
+    bool StartThread();
+    bool StartOnReactor();
+    void StopOnReactor();
+
 private:
+    void StartReceiving();
+    void StopReceiving();
+    void OpenSockets();
+    void WatchSocket(SOCKET socket);
+    void CloseSocket(SOCKET& socket);
+    void ReceiveReport();
+    void ReceiveInfo();
+    void NothingReceived();
+    void Maintain(wxLongLong now);
     SOCKET GetNewDataSocket();
     SOCKET GetNewInfoSocket();
     SOCKET GetNewReportSocket();
-    SOCKET PickNextEthernetCard();
+    size_t OpenProbeSockets();
+    SOCKET AdoptProbeSocket(size_t i, const NetworkAddress& radar_address);
+    void CloseProbeSockets();
+    void Backoff();
+    wxLongLong DiscoveryPhase(const wxString& phase);
+    void OpenCachedReportSocket();
     bool ProcessReport(const uint8_t* data, size_t len);
     void DetectedRadar(NetworkAddress& radar_address);
-    void ProcessFrame(const uint8_t* data, size_t len);
+    void ProcessFrame(const uint8_t* data, size_t len, wxLongLong time_rec, const NetworkAddress& source);
+    int ReceiveDataFrames(SOCKET dataSocket, uint8_t* data, size_t len);
+    void ReorderFrame(const uint8_t* data, size_t len, wxLongLong time_rec, const NetworkAddress& source);
+    void ReleaseHeldFrames(bool give_up);
     void ReleaseInfoSocket();
     void SendHeadingPacket();
     void SendNavigationPacket();
@@ -148,8 +219,43 @@ private:
     SOCKET m_send_socket; // A message to this socket will interrupt select()
                           // and allow immediate shutdown
 
-    struct ifaddrs* m_interface_array;
-    struct ifaddrs* m_interface;
+    SOCKET m_data_socket;
+    SOCKET m_report_socket;
+    SOCKET m_info_socket; // Only set when this radar owns g_HaloInfoSocket
+    NetworkAddress m_radar_addr; // Where the reports come from, once known
+    int m_no_data_timeout; // Counted in MILLIS_PER_SELECT periods
+    int m_no_spoke_timeout;
+    bool m_received; // A socket was readable since the last idle check
+    bool m_receiving; // Between StartReceiving() and StopReceiving()
+    wxLongLong m_next_idle; // When OnTick() next checks for the timeouts
+    wxLongLong m_retry_after; // When OnTick() may try OpenSockets() again
+    uint8_t* m_frame; // One frame buffer, for reports, info and unbatched frames
+
+    // Report sockets on every ethernet card, used while we don't know
+    // which card the radar is connected to
+    SOCKET m_probe_socket[NAVICO_MAX_PROBES];
+    NetworkAddress m_probe_addr[NAVICO_MAX_PROBES];
+    uint32_t m_probe_netmask[NAVICO_MAX_PROBES]; // Network order
+    size_t m_probes;
+
+    // Discovery timing in ms since the plugin started, logged with the first spoke
+    wxLongLong m_sockets_open_elapsed;
+    wxLongLong m_first_report_elapsed;
+    wxString m_discovery_via;
+    wxArrayString m_discovery_logged; // Phases that were logged already
+
+    uint8_t* m_batch_data; // NAVICO_RECEIVE_BATCH frame buffers for recvmmsg()
+
+    // Frames that arrived before an earlier one, see ReorderFrame()
+    uint8_t* m_reorder_data; // NAVICO_REORDER_FRAMES frame buffers
+    size_t m_held_len[NAVICO_REORDER_FRAMES];
+    wxLongLong m_held_time_rec[NAVICO_REORDER_FRAMES];
+    NetworkAddress m_held_source[NAVICO_REORDER_FRAMES];
+    int64_t m_held_since[NAVICO_REORDER_FRAMES]; // RadarTelemetry::Now()
+    uint8_t m_held_scan[NAVICO_REORDER_FRAMES];
+    size_t m_held;
+    uint8_t m_gap_start; // The last spokes that we stopped waiting for
+    uint8_t m_gap_len;
 
     uint8_t m_next_scan;
     char m_radar_status;
@@ -80,6 +80,7 @@ class Arpa;
 class GPSKalmanFilter;
 class RaymarineLocate;
 class NavicoLocate;
+class SocketReactor;
 
 #define MAX_CHART_CANVAS (2)  // How many canvases OpenCPN supports
 #define RADARS \
@@ -257,6 +258,14 @@ struct receive_statistics {
   int spokes;
   int broken_spokes;
   int missing_spokes;
+  int reordered_spokes;  // arrived out of order, but in time to be put back in order
+  int late_spokes;       // arrived out of order after their place was given up
+  int wakeups;         // receive thread wakeups that returned spoke data
+  int wakeup_frames;   // frames received in those wakeups
+  int max_wakeup_frames;
+  int queue_depth;       // decoded spokes waiting for processing
+  int queue_high_water;  // max queue depth since the previous statistics update
+  int queue_overflows;   // spokes dropped because the queue was full
 };
 
 typedef enum GuardZoneType { GZ_ARC, GZ_CIRCLE } GuardZoneType;
@@ -489,6 +498,20 @@ struct PersistentSettings {
                                 // floating and not docked
   wxPoint alarm_pos;            // Saved position of alarm window
   wxString alert_audio_file;    // Filepath of alarm audio file. Must be WAV.
+  wxString capture_directory;   // Readonly from config, record raw frames here
+  bool kernel_timestamps;       // Stamp spokes with the socket receive time
+  int navico_reorder_millis;    // Hold out of order Navico frames this long, 0 is off
+  bool shared_reactor;          // Serve the locator and receive sockets from one epoll thread
+  int emulator_radars;          // Radar slots without a type become emulators
+  int emulator_spokes;          // Spokes per rotation of an emulator
+  int emulator_spoke_len;       // Samples per emulator spoke
+  double emulator_rpm;          // Emulator rotations per minute
+  int emulator_clutter;         // Percentage of emulator samples near the boat that are clutter
+  wxString telemetry_file;      // Readonly from config, append receive telemetry here
+  wxString emulator_scenario;   // Readonly from config, moving targets for the emulator
+  int telemetry_interval;       // Seconds between telemetry lines
+  wxString replay_file[RADARS];  // Readonly from config, play back this capture
+  double replay_speed[RADARS];   // 1 = real time, N = N times faster, 0 = ASAP
   wxColour trail_start_colour;  // Starting colour of a trail
   wxColour trail_end_colour;    // Ending colour of a trail
   wxColour
@@ -593,6 +616,8 @@ public:
   void logBinaryData(const wxString& what, const uint8_t* data, int size);
   void StartRadarLocators(size_t r);
   void StopRadarLocators();
+  void StartSocketReactor();
+  void StopSocketReactor();
 
   void UpdateAllControlStates(bool all);
 
@@ -673,6 +698,7 @@ public:
                                    // plugin is disabled
   NavicoLocate* m_navico_locator;
   RaymarineLocate* m_raymarine_locator;
+  SocketReactor* m_reactor;  // Shared by the locators and receivers when settings.shared_reactor
 
   MessageBox* m_pMessageBox;
   wxWindow* m_parent_window;
@@ -703,6 +729,7 @@ private:
   void OnTimerNotify(wxTimerEvent& event);
   void TimedControlUpdate();
   void TimedUpdate(wxTimerEvent& event);
+  void DumpTelemetry(wxLongLong now);
   void ScheduleWindowRefresh();
   void SetOpenGLMode(OpenGLMode mode);
   int GetArpaTargetCount(void);
@@ -767,6 +794,7 @@ public:
   volatile bool m_notify_radar_window_viz;
   volatile bool m_notify_control_dialog;
   wxLongLong m_notify_time_ms;
+  wxLongLong m_telemetry_time_ms;  // When DumpTelemetry last wrote
 
 #define HEADING_TIMEOUT (5)
 
@@ -0,0 +1,70 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _RAYMARINE_DECODE_H_
+#define _RAYMARINE_DECODE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef PLUGIN_BEGIN_NAMESPACE  // Standalone tools define their own
+#include "pi_common.h"
+#endif
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Decoders for the run length encoded spoke data sent by Raymarine radars.
+//
+// A byte 0x5C starts a run: it is followed by the run length and the value to
+// repeat. Any other byte is a literal. The decoders never write more than
+// returns_per_line bytes, whatever the packet says, and never read beyond
+// src_len. The part of dst that the packet does not cover is set to zero.
+//
+// data_len is the encoded length from the spoke header; src_len is what is
+// really available in the packet, which may be more (E120 radars sometimes
+// send a few unencoded samples after the encoded data).
+//
+// All return the number of samples that were decoded from the packet.
+
+#define RAYMARINE_RLE_MARKER (0x5c)
+
+// E120 HD: one byte per sample.
+extern size_t RaymarineDecodeHD(const uint8_t* src, size_t data_len, size_t src_len, uint8_t* dst, size_t returns_per_line);
+
+// E120 non-HD: one nibble per sample, each expanded to a byte.
+extern size_t RaymarineDecodeNonHD(const uint8_t* src, size_t data_len, size_t src_len, uint8_t* dst, size_t returns_per_line);
+
+// Quantum: one byte per sample, nothing after the encoded data.
+extern size_t RaymarineDecodeQuantum(const uint8_t* src, size_t data_len, uint8_t* dst, size_t returns_per_line);
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _RAYMARINE_DECODE_H_ */
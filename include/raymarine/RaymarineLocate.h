@@ -36,6 +36,7 @@
 
 #include <map>
 
+#include "SocketReactor.h"
 #include "radar_pi.h"
 #include "socketutil.h"
 
@@ -50,15 +51,18 @@ PLUGIN_BEGIN_NAMESPACE
 // ports. The individual radars will then listen to multicast data on those
 // ports.
 //
+// When a SocketReactor is passed the sockets are served by the reactor
+// thread and no thread of its own is started.
+//
 
-class RaymarineLocate : public wxThread {
+class RaymarineLocate : public wxThread, public SocketReactorHandler {
 #define MAX_REPORT 3
 public:
-    RaymarineLocate(radar_pi* pi)
+    RaymarineLocate(radar_pi* pi, SocketReactor* reactor = 0)
         : wxThread(wxTHREAD_JOINABLE)
     {
-        Create(64 * 1024); // Stack size
         m_pi = pi; // This allows you to access the main plugin stuff
+        m_reactor = reactor;
         m_shutdown = false;
         m_is_shutdown = true;
 
@@ -66,11 +70,12 @@ public:
         m_socket = 0;
         m_interface_count = 0;
         m_report_count = 0;
-        SetPriority(wxPRIORITY_MAX);
-        // LOG_INFO(wxT("RaymarineLocate thread created, prio= %i"),
-        // GetPriority());
+        m_rescan_network_cards = 0;
     }
 
+    bool Start();
+    void Stop();
+
     /*
      * Shutdown
      *
@@ -88,10 +93,15 @@ public:
 
     volatile bool m_is_shutdown;
 
+    // SocketReactorHandler
+    void OnReadable(SOCKET socket);
+    void OnTick();
+
 protected:
     void* Entry(void);
 
 private:
+    bool ReceiveReport(size_t i);
     bool ProcessReport(const NetworkAddress& radar_address,
         const NetworkAddress& interface_address, const uint8_t* data,
         size_t len);
@@ -104,6 +114,7 @@ private:
     // void WakeRadar();
 
     radar_pi* m_pi;
+    SocketReactor* m_reactor;
     volatile bool m_shutdown;
 
     // Three arrays, all created on each call to UpdateEthernetCards.
@@ -113,6 +124,8 @@ private:
     size_t m_interface_count;
     size_t m_report_count;
 
+    int m_rescan_network_cards;
+
     wxCriticalSection m_exclusive;
 };
 
@@ -104,11 +104,25 @@ public:
         m_previous_angle = 0;
     };
 
-    ~RaymarineReceive() {};
+    ~RaymarineReceive()
+    {
+        // Entry() closes these, but it never runs when used by RadarReplay
+        if (m_send_socket != INVALID_SOCKET) {
+            closesocket(m_send_socket);
+        }
+        if (m_receive_socket != INVALID_SOCKET) {
+            closesocket(m_receive_socket);
+        }
+    }
 
     void* Entry(void);
     void Shutdown(void);
     wxString GetInfoStatus();
+    void ReplayFrame(const uint8_t* data, size_t len, wxLongLong time,
+        const NetworkAddress& source)
+    {
+        ProcessFrame(data, len, time, source);
+    }
     SOCKET GetCommSocket() { return m_comm_socket; }
 
     NetworkAddress m_interface_addr;
@@ -119,7 +133,7 @@ public:
     volatile bool m_is_shutdown;
 
 private:
-    void ProcessFrame(const uint8_t* data, size_t len);
+    void ProcessFrame(const uint8_t* data, size_t len, wxLongLong time_rec, const NetworkAddress& source);
 
     SOCKET PickNextEthernetCard();
     SOCKET GetNewReportSocket();
@@ -144,8 +158,8 @@ private:
     int m_range_meters, m_updated_range;
     bool m_target_expansion;
     void ProcessFixedReport(const UINT8* data, int len);
-    void ProcessScanData(const UINT8* data, int len);
-    void ProcessQuantumScanData(const UINT8* data, int len);
+    void ProcessScanData(const UINT8* data, int len, wxLongLong time_rec);
+    void ProcessQuantumScanData(const UINT8* data, int len, wxLongLong time_rec);
     void ProcessQuantumReport(const UINT8* data, int len);
 
     void SetFirmware(wxString s);
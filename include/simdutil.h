@@ -0,0 +1,109 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _SIMDUTIL_H_
+#define _SIMDUTIL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#ifdef _MSC_VER
+#include <intrin.h>  // _BitScanForward
+#endif
+
+#ifndef PLUGIN_BEGIN_NAMESPACE  // Standalone tools define their own
+#include "pi_common.h"
+#endif
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Vector implementations of small inner loops used by the receive threads.
+// Which implementation is used is decided once, at run time, based on what the
+// CPU supports. Every routine has a plain C++ fallback with identical results.
+
+// Name of the instruction set that is used, e.g. "SSSE3", "NEON" or "none".
+extern const char* GetSimdName();
+
+// Expand every byte in src to two bytes in dst: first table[low nibble], then
+// table[high nibble]. dst must have room for 2 * len bytes.
+extern void ExpandNibbles(const uint8_t table[16], const uint8_t* src, uint8_t* dst, size_t len);
+
+// Expand every bit in src to a byte in dst, least significant bit first:
+// 255 when the bit is set, 0 when not. dst must have room for 8 * len bytes.
+extern void ExpandBits(const uint8_t* src, uint8_t* dst, size_t len);
+
+// Condition a received spoke in one pass over the data, as the spoke
+// processing thread needs it:
+// - the first main_bang bytes of data are set to 0;
+// - bytes of data below threshold are set to 0 (so 0 does nothing);
+// - strong_bits gets one bit per byte of the result, set for values >= strong,
+//   and doppler_bits one bit set for 255 (an approaching doppler target),
+//   byte i in bit (i % 64) of word (i / 64);
+// - both are cleared from len up to 'words' words, which must hold len bits.
+// Returns the number of bytes that are 255.
+extern size_t ConditionSpoke(uint8_t* data, size_t len, size_t main_bang, uint8_t threshold, uint8_t strong,
+    uint64_t* strong_bits, uint64_t* doppler_bits, size_t words);
+
+// Halve two neighbouring rows of len bytes into one, keeping the maximum:
+// dst[i] = max(a[2i], a[2i + 1], b[2i], b[2i + 1]). A final odd byte is pooled
+// on its own. dst must have room for (len + 1) / 2 bytes. a and b may be the same.
+extern void MaxPool2x2(const uint8_t* a, const uint8_t* b, uint8_t* dst, size_t len);
+
+// Number of bits set in v.
+static inline int PopCount64(uint64_t v)
+{
+#ifdef _MSC_VER
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((v * 0x0101010101010101ULL) >> 56);
+#else
+    return __builtin_popcountll(v);
+#endif
+}
+
+// Index of the lowest bit set in v, which must not be 0.
+static inline int CountTrailingZeros64(uint64_t v)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    if (_BitScanForward(&index, (unsigned long)v)) {
+        return (int)index;
+    }
+    _BitScanForward(&index, (unsigned long)(v >> 32));
+    return (int)index + 32;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _SIMDUTIL_H_ */
@@ -187,6 +187,40 @@ extern SOCKET startUDPMulticastReceiveSocket(const NetworkAddress& addr,
 extern SOCKET GetLocalhostServerTCPSocket();
 extern SOCKET GetLocalhostSendTCPSocket(SOCKET receive_socket);
 
+// Ask the kernel to stamp every datagram received on sockfd with its arrival
+// time, so that socketReceive() can return that instead of the time it was read.
+extern bool socketEnableTimestamps(SOCKET sockfd);
+
+// Ask the kernel to pass the number of datagrams it dropped on sockfd because
+// the receive buffer was full with every datagram (Linux only).
+extern bool socketEnableDropCounter(SOCKET sockfd);
+
+// recvfrom() that also returns when the datagram arrived, in millis since the
+// epoch. Falls back to the current time when the datagram was not stamped.
+// `drops` is set to the drop counter of the socket, or 0 if it has none.
+extern int socketReceive(SOCKET sockfd, uint8_t* data, size_t len,
+    struct sockaddr* from, socklen_t* from_len, wxLongLong* time_rec,
+    uint32_t* drops);
+
+#ifndef __WXMSW__
+#include <sys/socket.h>
+
+// Room for the timestamp and drop counter control messages in a struct msghdr
+#define SOCKET_CONTROL_LEN (64)
+
+// msg_control buffer, aligned for the struct cmsghdr that CMSG_FIRSTHDR()
+// returns a pointer into
+typedef union {
+    char buf[SOCKET_CONTROL_LEN];
+    struct cmsghdr align;
+} SocketControl;
+
+// Time stamp and drop counter of a message received with recvmsg() or
+// recvmmsg(). Returns false when the message has no time stamp.
+extern bool socketMessageInfo(
+    struct msghdr* msg, wxLongLong* time_rec, uint32_t* drops);
+#endif
+
 #ifndef __WXMSW__
 
 // Mac and Linux have ifaddrs.
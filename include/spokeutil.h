@@ -0,0 +1,84 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#ifndef _SPOKEUTIL_H_
+#define _SPOKEUTIL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef PLUGIN_BEGIN_NAMESPACE  // Standalone tools define their own
+#include "pi_common.h"
+#endif
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Inner loops of the spoke processing stages that do not need wxWidgets, so
+// that the radar-bench program runs the same code as the plugin.
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+} PointInt;
+
+// The trails of one spoke in the true motion trail image, which is trail_size
+// by trail_size ages with the boat at (centre_x, centre_y). lookup is the row
+// of the polar to cartesian table for the bearing of the spoke, with at least
+// len_max points.
+// - a sample of data of at least strong starts a new trail, all other points
+//   of the spoke up to len_max age by one revolution until they are max_age;
+// - when trail_colour is set, every sample below weak is replaced with the
+//   colour of the age of its trail.
+extern void UpdateTrueTrailSpoke(const PointInt* lookup, uint8_t* trails, size_t trail_size, int centre_x, int centre_y,
+    uint8_t* data, size_t len, size_t len_max, uint8_t weak, uint8_t strong, uint8_t max_age, const uint8_t* trail_colour);
+
+// The same for the relative trails of one spoke, trail holds len_max ages.
+// The ages from len up to len_max are cleared.
+extern void UpdateRelativeTrailSpoke(uint8_t* trail, uint8_t* data, size_t len, size_t len_max, uint8_t weak, uint8_t strong,
+    uint8_t max_age, const uint8_t* trail_colour);
+
+// Whether degrees is in the arc that runs clockwise from start_degrees up to
+// end_degrees, which may pass north.
+static inline bool InBearingArc(int degrees, int start_degrees, int end_degrees)
+{
+    if (start_degrees < end_degrees) {
+        return degrees >= start_degrees && degrees < end_degrees;
+    }
+    return degrees >= start_degrees || degrees < end_degrees;
+}
+
+// Number of samples r_first up to and including r_last of a spoke of len
+// samples that are at least threshold.
+extern size_t CountReturns(const uint8_t* data, size_t len, size_t r_first, size_t r_last, uint8_t threshold);
+
+PLUGIN_END_NAMESPACE
+
+#endif /* _SPOKEUTIL_H_ */
@@ -45,6 +45,7 @@ Arpa::Arpa(radar_pi* pi, RadarInfo* ri) {
   m_ri = ri;
   m_pi = pi;
   m_number_of_targets = 0;
+  m_refresh_micros = 0;
   CLEAR_STRUCT(m_targets);
   CLEAR_STRUCT(m_doppler_arpa_update_time);
 }
@@ -93,37 +94,16 @@ Polar ArpaTarget::Pos2Polar(ExtendedPosition p, ExtendedPosition own_ship) {
   return pol;
 }
 
-bool Arpa::Pix(int ang, int rad, bool doppler) {
-  if (rad <= 0 || rad >= (int)m_ri->m_spoke_len_max) {
-    return false;
-  }
-  int angle = MOD_SPOKES(ang);
-  bool bit0 = (m_ri->m_history[angle].line[rad] & 128) != 0;
-  bool bit2 = (m_ri->m_history[angle].line[rad] & 32) != 0;
-  if (!doppler) {
-    return (bit0);
-  } else {
-    return (bit0 && bit2);
-  }
-}
-
 bool ArpaTarget::Pix(int ang, int rad) {
   if (rad <= 0 || rad >= (int)m_ri->m_spoke_len_max) {
     return false;
   }
   SpokeBearing angle = MOD_SPOKES(ang);
-  bool bit0 = (m_ri->m_history[angle].line[rad] & 128) > 0;
-  bool bit1 = (m_ri->m_history[angle].line[rad] & 64) > 0;
-  bool bit2 = (m_ri->m_history[angle].line[rad] & 32) > 0;
 
-  if (m_doppler_target > 0 && !bit2) {  // we are looking for doppler targets and this is not doppler
-    return false;
-  }
-  if (m_check_for_duplicate) {
-    return (bit1);
-  } else {
-    return (bit0);
+  if (m_doppler_target > 0 && !m_ri->m_history_bits->Get(HISTORY_DOPPLER, angle, rad)) {
+    return false;  // we are looking for doppler targets and this is not doppler
   }
+  return m_ri->m_history_bits->Get(GetPixPlane(), angle, rad);
 }
 
 bool ArpaTarget::MultiPix(int ang, int rad) {  // checks if the blob has a contour of at least length pixels
@@ -131,103 +111,7 @@ bool ArpaTarget::MultiPix(int ang, int rad) {  // checks if the blob has a conto
   // false if not
   // if false clears out pixels of the blob in hist
   wxCriticalSectionLocker lock(ArpaTarget::m_ri->m_exclusive);
-  int length = m_ri->m_min_contour_length;
-  Polar start;
-  start.angle = ang;
-  start.r = rad;
-  if (!Pix(start.angle, start.r)) {
-    return false;
-  }
-  Polar current = start;  // the 4 possible translations to move from a point on the contour to the next
-  Polar max_angle;
-  Polar min_angle;
-  Polar max_r;
-  Polar min_r;
-  Polar transl[4];  //   = { 0, 1,   1, 0,   0, -1,   -1, 0 };
-  transl[0].angle = 0;
-  transl[0].r = 1;
-  transl[1].angle = 1;
-  transl[1].r = 0;
-  transl[2].angle = 0;
-  transl[2].r = -1;
-  transl[3].angle = -1;
-  transl[3].r = 0;
-  int count = 0;
-  int aa;
-  int rr;
-  bool succes = false;
-  int index = 0;
-  max_r = current;
-  max_angle = current;
-  min_r = current;
-  min_angle = current;  // check if p inside blob
-  if (start.r >= (int)m_ri->m_spoke_len_max) {
-    return false;  //  r too large
-  }
-  if (start.r < 3) {
-    return false;  //  r too small
-  }
-  // first find the orientation of border point p
-  for (int i = 0; i < 4; i++) {
-    index = i;
-    aa = current.angle + transl[index].angle;
-    rr = current.r + transl[index].r;
-    succes = !Pix(aa, rr);
-    if (succes) break;
-  }
-  if (!succes) {
-    // single pixel blob
-    return false;
-  }
-  index += 1;  // determines starting direction
-  if (index > 3) index -= 4;
-  while (current.r != start.r || current.angle != start.angle || count == 0) {  // try all translations to find the next point
-    // start with the "left most" translation relative to the
-    // previous one
-    index += 3;  // we will turn left all the time if possible
-    for (int i = 0; i < 4; i++) {
-      if (index > 3) index -= 4;
-      aa = current.angle + transl[index].angle;
-      rr = current.r + transl[index].r;
-      succes = Pix(aa, rr);
-      if (succes) {  // next point found
-        break;
-      }
-      index += 1;
-    }
-    if (!succes) {
-      return false;  // no next point found (this happens when the blob consists of one single pixel)
-    }  // next point found
-    current.angle = aa;
-    current.r = rr;
-    if (count >= length) {
-      return true;
-    }
-    count++;
-    if (current.angle > max_angle.angle) {
-      max_angle = current;
-    }
-    if (current.angle < min_angle.angle) {
-      min_angle = current;
-    }
-    if (current.r > max_r.r) {
-      max_r = current;
-    }
-    if (current.r < min_r.r) {
-      min_r = current;
-    }
-  }  // contour length is less than m_min_contour_length
-     // before returning false erase this blob so we do not have to check this one again
-  if (min_angle.angle < 0) {
-    min_angle.angle += m_ri->m_spokes;
-    max_angle.angle += m_ri->m_spokes;
-  }
-  for (int a = min_angle.angle; a <= max_angle.angle; a++) {
-    for (int r = min_r.r; r <= max_r.r; r++) {
-      m_ri->m_history[MOD_SPOKES(a)].line[r] &= 63;
-    }
-  }
-  return false;
+  return m_ri->m_history_bits->HasContour(GetPixPlane(), m_doppler_target > 0, ang, rad, m_ri->m_min_contour_length);
 }
 
 bool Arpa::MultiPix(int ang, int rad, bool doppler) {
@@ -235,104 +119,7 @@ bool Arpa::MultiPix(int ang, int rad, bool doppler) {
   // pol must start on the contour of the blob
   // false if not
   // if false clears out pixels of th blob in hist
-  //    wxCriticalSectionLocker lock(ArpaTarget::m_ri->m_exclusive);
-  int length = m_ri->m_min_contour_length;
-  Polar start;
-  start.angle = ang;
-  start.r = rad;
-
-  if (!Pix(start.angle, start.r, doppler)) {
-    return false;
-  }
-  Polar current = start;  // the 4 possible translations to move from a point on the contour to the next
-  Polar max_angle;
-  Polar min_angle;
-  Polar max_r;
-  Polar min_r;
-  Polar transl[4];  //   = { 0, 1,   1, 0,   0, -1,   -1, 0 };
-  transl[0].angle = 0;
-  transl[0].r = 1;
-  transl[1].angle = 1;
-  transl[1].r = 0;
-  transl[2].angle = 0;
-  transl[2].r = -1;
-  transl[3].angle = -1;
-  transl[3].r = 0;
-  int count = 0;
-  int aa;
-  int rr;
-  bool succes = false;
-  int index = 0;
-  max_r = current;
-  max_angle = current;
-  min_r = current;
-  min_angle = current;  // check if p inside blob
-  if (start.r >= (int)m_ri->m_spoke_len_max) {
-    return false;  //  r too large
-  }
-  if (start.r < 3) {
-    return false;  //  r too small
-  }
-  // first find the orientation of border point p
-  for (int i = 0; i < 4; i++) {
-    index = i;
-    aa = current.angle + transl[index].angle;
-    rr = current.r + transl[index].r;
-    succes = !Pix(aa, rr, doppler);
-    if (succes) break;
-  }
-  if (!succes) {
-    return false;
-  }
-  index += 1;  // determines starting direction
-  if (index > 3) index -= 4;
-  while (current.r != start.r || current.angle != start.angle ||
-         count == 0) {  // try all translations to find the next point  // start with the "left most" translation relative to the
-    // previous one
-    index += 3;  // we will turn left all the time if possible
-    for (int i = 0; i < 4; i++) {
-      if (index > 3) index -= 4;
-      aa = current.angle + transl[index].angle;
-      rr = current.r + transl[index].r;
-      succes = Pix(aa, rr, doppler);
-      if (succes) {  // next point found
-        break;
-      }
-      index += 1;
-    }
-    if (!succes) {
-      return false;  // no next point found
-    }  // next point found
-    current.angle = aa;
-    current.r = rr;
-    if (count >= length) {
-      return true;
-    }
-    count++;
-    if (current.angle > max_angle.angle) {
-      max_angle = current;
-    }
-    if (current.angle < min_angle.angle) {
-      min_angle = current;
-    }
-    if (current.r > max_r.r) {
-      max_r = current;
-    }
-    if (current.r < min_r.r) {
-      min_r = current;
-    }
-  }  // contour length is less than m_min_contour_length
-  // before returning false erase this blob so we do not have to check this one again
-  if (min_angle.angle < 0) {
-    min_angle.angle += m_ri->m_spokes;
-    max_angle.angle += m_ri->m_spokes;
-  }
-  for (int a = min_angle.angle; a <= max_angle.angle; a++) {
-    for (int r = min_r.r; r <= max_r.r; r++) {
-      m_ri->m_history[MOD_SPOKES(a)].line[r] &= 63;  // 0x3F
-    }
-  }
-  return false;
+  return m_ri->m_history_bits->HasContour(HISTORY_TARGET, doppler, ang, rad, m_ri->m_min_contour_length);
 }
 
 void Arpa::AcquireNewMARPATarget(ExtendedPosition target_pos) { AcquireOrDeleteMarpaTarget(target_pos, ACQUIRE0); }
@@ -529,7 +316,7 @@ int ArpaTarget::GetContour(Polar* pol) {
     pol->angle -= m_ri->m_spokes;
   }
   pol->r = (m_max_r.r + m_min_r.r) / 2;
-  pol->time = m_ri->m_history[MOD_SPOKES(pol->angle)].time;
+  pol->time = m_ri->GetHistoryTime(MOD_SPOKES(pol->angle));
   m_radar_pos = m_ri->m_history[MOD_SPOKES(pol->angle)].pos;
 
   double poslat = m_radar_pos.lat;
@@ -685,6 +472,8 @@ void Arpa::CleanUpLostTargets() {
 }
 
 void Arpa::RefreshArpaTargets() {
+  int64_t start = RadarTelemetry::Now();
+
   CleanUpLostTargets();
   int target_to_delete = -1;
   // find a target with status FOR_DELETION if it is there
@@ -755,6 +544,7 @@ void Arpa::RefreshArpaTargets() {
   if (m_ri->m_doppler.GetValue() > 0 && m_ri->m_autotrack_doppler.GetValue() > 0) {
     SearchDopplerTargets();
   }
+  m_refresh_micros = RadarTelemetry::Now() - start;
 }
 
 void ArpaTarget::RefreshTarget(int dist) {
@@ -770,10 +560,10 @@ void ArpaTarget::RefreshTarget(int dist) {
     return;
   }
   pol = Pos2Polar(m_position, own_pos);
-  wxLongLong time1 = m_ri->m_history[MOD_SPOKES(pol.angle)].time;
+  wxLongLong time1 = m_ri->GetHistoryTime(MOD_SPOKES(pol.angle));
   int margin = SCAN_MARGIN;
   if (m_pass_nr == PASS2) margin += 100;
-  wxLongLong time2 = m_ri->m_history[MOD_SPOKES(pol.angle + margin)].time;
+  wxLongLong time2 = m_ri->GetHistoryTime(MOD_SPOKES(pol.angle + margin));
   // check if target has been refreshed since last time (at least SCAN_MARGIN2 later)
   // and if the beam has passed the target location with SCAN_MARGIN spokes
   // the beam sould have passed our "angle" AND a point SCANMARGIN further
@@ -1000,6 +790,13 @@ bool ArpaTarget::FindNearestContour(Polar* pol, int dist) {
   int a = pol->angle;
   int r = pol->r;
   if (dist < 2) dist = 2;
+
+  // Nothing to find if there is no return at all in the square
+  int max_dist_a = wxMax((int)(326. / (double)r * dist), 1);
+  if (m_ri->m_history_bits->Count(GetPixPlane(), m_doppler_target > 0, a - max_dist_a, a + max_dist_a, r - dist, r + dist) == 0) {
+    return false;
+  }
+
   for (int j = 1; j <= dist; j++) {
     int dist_r = j;
     int dist_a = (int)(326. / (double)r * j);  // 326/r: conversion factor to make squares
@@ -1242,11 +1039,9 @@ int Arpa::AcquireNewARPATarget(Polar pol, int status, uint8_t doppler) {
 void ArpaTarget::ResetPixels() {
   // resets the pixels of the current blob (plus DISTANCE_BETWEEN_TARGETS) so that blob will not be found again in the same sweep
   // We not only reset the blob but all pixels in a radial "square" covering the blob
-  for (int r = wxMax(m_min_r.r - DISTANCE_BETWEEN_TARGETS, 0);
-       r <= wxMin(m_max_r.r + DISTANCE_BETWEEN_TARGETS, (int)m_ri->m_spoke_len_max - 1); r++) {
-    for (int a = m_min_angle.angle - DISTANCE_BETWEEN_TARGETS; a <= m_max_angle.angle + DISTANCE_BETWEEN_TARGETS; a++) {
-      m_ri->m_history[MOD_SPOKES(a)].line[r] = m_ri->m_history[MOD_SPOKES(a)].line[r] & 127;
-    }
+  for (int a = m_min_angle.angle - DISTANCE_BETWEEN_TARGETS; a <= m_max_angle.angle + DISTANCE_BETWEEN_TARGETS; a++) {
+    m_ri->m_history_bits->ClearRange(HISTORY_TARGET, a, m_min_r.r - DISTANCE_BETWEEN_TARGETS,
+                                     m_max_r.r + DISTANCE_BETWEEN_TARGETS);
   }
 }
 
@@ -1291,9 +1086,9 @@ void Arpa::SearchDopplerTargets() {
   // loop with +2 increments as target must be larger than 2 pixels in width
   for (int angleIter = start_bearing; angleIter < end_bearing; angleIter += 2) {
     SpokeBearing angle = MOD_SPOKES(angleIter);
-    wxLongLong time1 = m_ri->m_history[angle].time;
+    wxLongLong time1 = m_ri->GetHistoryTime(angle);
     // time2 must be timed later than the pass 2 in refresh, otherwise target may be found multiple times
-    wxLongLong time2 = m_ri->m_history[MOD_SPOKES(angle + 3 * SCAN_MARGIN)].time;
+    wxLongLong time2 = m_ri->GetHistoryTime(MOD_SPOKES(angle + 3 * SCAN_MARGIN));
 
     // check if target has been refreshed since last time
     // and if the beam has passed the target location with SCAN_MARGIN spokes
@@ -1301,7 +1096,9 @@ void Arpa::SearchDopplerTargets() {
          time2 >= time1)) {  // the beam sould have passed our "angle" AND a
                              // point SCANMARGIN further set new refresh time
       m_doppler_arpa_update_time[angle] = time1;
-      for (int rrr = (int)range_start; rrr < (int)range_end; rrr++) {
+      // Only look at the doppler returns, skipping the empty bits a word at a time
+      for (int rrr = m_ri->m_history_bits->Find(HISTORY_TARGET, true, angle, (int)range_start, (int)range_end); rrr >= 0;
+           rrr = m_ri->m_history_bits->Find(HISTORY_TARGET, true, angle, rrr + 1, (int)range_end)) {
         if (m_ri->m_arpa->GetTargetCount() >= MAX_NUMBER_OF_TARGETS - 1) {
           LOG_INFO(wxT("No more scanning for ARPA targets in loop, maximum number of targets reached"));
           return;
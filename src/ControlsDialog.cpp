@@ -231,8 +231,11 @@ void RadarControlButton::UpdateLabel(bool force) {
   RadarControlState state;
   int value;
   wxString label;
+  uint32_t version = m_item->GetVersion();
 
-  if (m_item->GetButton(&value, &state) || force) {
+  m_item->GetButton(&value, &state);
+  if (version != m_version || force) {
+    m_version = version;
     // label << MENU_EDIT(firstLine) << wxT("\n");
     if (m_no_edit) {
       label << firstLine;
@@ -2242,15 +2245,46 @@ void ControlsDialog::UpdateControlValues(bool refreshAll) {
     m_bearing_buttons[b]->SetLabel(o);
   }
 
+  // The buttons of the controls of this radar only need a look when one of
+  // those controls has changed.
+  uint32_t epoch = m_ri->m_controls_epoch;
+  if (refreshAll || epoch != m_controls_epoch) {
+    m_controls_epoch = epoch;
+    UpdateControlButtons(refreshAll);
+  }
+
+  // These are shared amongst all radars, so they are not counted in the epoch
+  // of this radar. Each button remembers the version it has shown.
+  if (m_transparency_button) {
+    m_transparency_button->UpdateLabel(refreshAll);
+  }
+  if (m_refresh_rate_button) {
+    m_refresh_rate_button->UpdateLabel(refreshAll);
+  }
+
+  if (updateEditDialog) {
+    // Update the text that is currently shown in the edit box, this is a copy of the button itself
+    EnterEditMode(m_from_control);
+  } else {
+    Resize(resize);
+  }
+}
+
+/*
+ * Update the label of every button whose control has changed since the button
+ * last showed it. The range label also depends on other state, so refreshAll
+ * sets that one regardless.
+ */
+void ControlsDialog::UpdateControlButtons(bool refreshAll) {
   if (m_targets_on_ppi_button) {
-    m_targets_on_ppi_button->UpdateLabel();
+    m_targets_on_ppi_button->UpdateLabel(refreshAll);
   }
-  m_target_trails_button->UpdateLabel();
-  m_trails_motion_button->UpdateLabel();
-  m_orientation_button->UpdateLabel();
-  m_view_center_button->UpdateLabel();
+  m_target_trails_button->UpdateLabel(refreshAll);
+  m_trails_motion_button->UpdateLabel(refreshAll);
+  m_orientation_button->UpdateLabel(refreshAll);
+  m_view_center_button->UpdateLabel(refreshAll);
   for (int i = 0; i < CANVAS_COUNT; i++) {
-    m_overlay_button[i]->UpdateLabel();
+    m_overlay_button[i]->UpdateLabel(refreshAll);
   }
 
   if (m_range_button && (m_ri->m_range.IsModified() || refreshAll)) {
@@ -2260,183 +2294,169 @@ void ControlsDialog::UpdateControlValues(bool refreshAll) {
 
   // gain
   if (m_gain_button) {
-    m_gain_button->UpdateLabel();
+    m_gain_button->UpdateLabel(refreshAll);
   }
 
   // color gain
   if (m_color_gain_button) {
-    m_color_gain_button->UpdateLabel();
+    m_color_gain_button->UpdateLabel(refreshAll);
   }
 
   //  rain
   if (m_rain_button) {
-    m_rain_button->UpdateLabel();
+    m_rain_button->UpdateLabel(refreshAll);
   }
 
   //  FTC
   if (m_ftc_button) {
-    m_ftc_button->UpdateLabel();
+    m_ftc_button->UpdateLabel(refreshAll);
   }
 
   //   sea
   if (m_sea_button) {
-    m_sea_button->UpdateLabel();
+    m_sea_button->UpdateLabel(refreshAll);
   }
 
   //   sea state
   if (m_sea_state_button) {
-    m_sea_state_button->UpdateLabel();
+    m_sea_state_button->UpdateLabel(refreshAll);
   }
 
   //   mode (RM_Quantum)
   if (m_mode_button) {
-    m_mode_button->UpdateLabel();
+    m_mode_button->UpdateLabel(refreshAll);
   }
 
   //   All to auto (RM_Quantum)
   if (m_all_to_auto_button) {
-    m_all_to_auto_button->UpdateLabel();
+    m_all_to_auto_button->UpdateLabel(refreshAll);
   }
 
   //   target_boost
   if (m_target_boost_button) {
-    m_target_boost_button->UpdateLabel();
+    m_target_boost_button->UpdateLabel(refreshAll);
   }
 
   //   target_expansion
   if (m_target_expansion_button) {
-    m_target_expansion_button->UpdateLabel();
+    m_target_expansion_button->UpdateLabel(refreshAll);
   }
 
   //  noise_rejection
   if (m_noise_rejection_button) {
-    m_noise_rejection_button->UpdateLabel();
+    m_noise_rejection_button->UpdateLabel(refreshAll);
   }
 
   //  target_separation
   if (m_target_separation_button) {
-    m_target_separation_button->UpdateLabel();
+    m_target_separation_button->UpdateLabel(refreshAll);
   }
 
   //  interference_rejection
   if (m_interference_rejection_button) {
-    m_interference_rejection_button->UpdateLabel();
+    m_interference_rejection_button->UpdateLabel(refreshAll);
   }
 
   // scanspeed
   if (m_scan_speed_button) {
-    m_scan_speed_button->UpdateLabel();
+    m_scan_speed_button->UpdateLabel(refreshAll);
   }
 
   //   antenna height
   if (m_antenna_height_button) {
-    m_antenna_height_button->UpdateLabel();
+    m_antenna_height_button->UpdateLabel(refreshAll);
   }
 
   //   antenna size
   if (m_antenna_size_button) {
-    m_antenna_size_button->UpdateLabel();
+    m_antenna_size_button->UpdateLabel(refreshAll);
   }
 
   //   parking angle
   if (m_parking_angle_button) {
-    m_parking_angle_button->UpdateLabel();
+    m_parking_angle_button->UpdateLabel(refreshAll);
   }
 
   //  bearing alignment
   if (m_bearing_alignment_button) {
-    m_bearing_alignment_button->UpdateLabel();
+    m_bearing_alignment_button->UpdateLabel(refreshAll);
   }
 
   // scaling
   if (m_range_adjustment_button) {
-    m_range_adjustment_button->UpdateLabel();
+    m_range_adjustment_button->UpdateLabel(refreshAll);
   }
 
   //  no transmit zone
   for (size_t z = 0; z < NO_TRANSMIT_ZONES; z++) {
     if (m_no_transmit_start_button[z]) {
-      m_no_transmit_start_button[z]->UpdateLabel();
+      m_no_transmit_start_button[z]->UpdateLabel(refreshAll);
     }
     if (m_no_transmit_end_button[z]) {
-      m_no_transmit_end_button[z]->UpdateLabel();
+      m_no_transmit_end_button[z]->UpdateLabel(refreshAll);
     }
   }
 
   //  local interference rejection
   if (m_local_interference_rejection_button) {
-    m_local_interference_rejection_button->UpdateLabel();
+    m_local_interference_rejection_button->UpdateLabel(refreshAll);
   }
 
   // side lobe suppression
   if (m_side_lobe_suppression_button) {
-    m_side_lobe_suppression_button->UpdateLabel();
+    m_side_lobe_suppression_button->UpdateLabel(refreshAll);
   }
 
   if (m_main_bang_size_button) {
-    m_main_bang_size_button->UpdateLabel();
+    m_main_bang_size_button->UpdateLabel(refreshAll);
   }
 
   if (m_accent_light_button) {
-    m_accent_light_button->UpdateLabel();
+    m_accent_light_button->UpdateLabel(refreshAll);
   }
 
   if (m_antenna_starboard_button) {
-    m_antenna_starboard_button->UpdateLabel();
+    m_antenna_starboard_button->UpdateLabel(refreshAll);
   }
 
   if (m_antenna_forward_button) {
-    m_antenna_forward_button->UpdateLabel();
+    m_antenna_forward_button->UpdateLabel(refreshAll);
   }
 
   if (m_stc_button) {
-    m_stc_button->UpdateLabel();
+    m_stc_button->UpdateLabel(refreshAll);
   }
 
   if (m_fine_tune_button) {
-    m_fine_tune_button->UpdateLabel(true);
+    m_fine_tune_button->UpdateLabel(refreshAll);
   }
   if (m_coarse_tune_button) {
-    m_coarse_tune_button->UpdateLabel();
+    m_coarse_tune_button->UpdateLabel(refreshAll);
   }
   if (m_stc_curve_button) {
-    m_stc_curve_button->UpdateLabel();
+    m_stc_curve_button->UpdateLabel(refreshAll);
   }
   if (m_display_timing_button) {
-    m_display_timing_button->UpdateLabel();
+    m_display_timing_button->UpdateLabel(refreshAll);
   }
   if (m_main_bang_suppression_button) {
-    m_main_bang_suppression_button->UpdateLabel();
+    m_main_bang_suppression_button->UpdateLabel(refreshAll);
   }
 
-  // For these we can't use the modified state as they are shared amongst all
-  // radars and thus the modified state is reset on the first radar checking it.
-  if (m_transparency_button) {
-    m_transparency_button->UpdateLabel(true);
-  }
   if (m_timed_idle_button) {
-    m_timed_idle_button->UpdateLabel(true);
+    m_timed_idle_button->UpdateLabel(refreshAll);
   }
   if (m_timed_run_button) {
-    m_timed_run_button->UpdateLabel(true);
-  }
-  if (m_refresh_rate_button) {
-    m_refresh_rate_button->UpdateLabel(true);
+    m_timed_run_button->UpdateLabel(refreshAll);
   }
   if (m_doppler_button) {
-    m_doppler_button->UpdateLabel();
+    m_doppler_button->UpdateLabel(refreshAll);
   }
   if (m_doppler_threshold_button) {
-    m_doppler_threshold_button->UpdateLabel();
+    m_doppler_threshold_button->UpdateLabel(refreshAll);
   }
   if (m_autotrack_doppler_button) {
-    m_autotrack_doppler_button->UpdateLabel();
-  }
-  if (updateEditDialog) {
-    // Update the text that is currently shown in the edit box, this is a copy of the button itself
-    EnterEditMode(m_from_control);
-  } else {
-    Resize(resize);
+    m_autotrack_doppler_button->UpdateLabel(refreshAll);
   }
 }
 
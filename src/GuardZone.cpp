@@ -30,7 +30,9 @@
 #include "GuardZone.h"
 
 #include "Arpa.h"
+#include "SpokeHistory.h"
 #include "radar_pi.h"
+#include "spokeutil.h"
 
 PLUGIN_BEGIN_NAMESPACE
 
@@ -52,7 +54,23 @@ GuardZone::GuardZone(radar_pi* pi, RadarInfo* ri, int zone) {
   ResetBogeys();
 }
 
-void GuardZone::ProcessSpoke(SpokeBearing angle, uint8_t* data, uint8_t* hist, size_t len) {
+/*
+ * Add the returns from range_start up to and including range_end of a spoke to
+ * the count of the current swipe.
+ */
+void GuardZone::AddReturns(uint8_t* data, size_t len, size_t range_start, size_t range_end) {
+  m_running_count += (int)CountReturns(data, len, range_start, range_end, m_pi->m_settings.threshold_blue);
+#ifdef TEST_GUARD_ZONE_LOCATION
+  // Zap guard zone computation location to green so this is visible on screen
+  for (size_t r = range_start; r <= range_end && r < len; r++) {
+    if (data[r] < m_pi->m_settings.threshold_blue) {
+      data[r] = m_pi->m_settings.threshold_green;
+    }
+  }
+#endif
+}
+
+void GuardZone::ProcessSpoke(SpokeBearing angle, uint8_t* data, size_t len) {
   size_t range_start = m_inner_range * m_ri->m_pixels_per_meter;  // Convert from meters to [0..spoke_len_max>
   size_t range_end = m_outer_range * m_ri->m_pixels_per_meter;    // Convert from meters to [0..spoke_len_max>
   bool in_guard_zone = false;
@@ -60,45 +78,15 @@ void GuardZone::ProcessSpoke(SpokeBearing angle, uint8_t* data, uint8_t* hist, s
 
   switch (m_type) {
     case GZ_ARC:
-      if ((degAngle >= m_start_bearing && degAngle < m_end_bearing) ||
-          (m_start_bearing >= m_end_bearing && (degAngle >= m_start_bearing || degAngle < m_end_bearing))) {
-        if (range_start < len) {
-          if (range_end > len) {
-            range_end = len;
-          }
-          for (size_t r = range_start; r <= range_end; r++) {
-            if (data[r] >= m_pi->m_settings.threshold_blue) {
-              m_running_count++;
-            }
-#ifdef TEST_GUARD_ZONE_LOCATION
-            // Zap guard zone computation location to green so this is visible on screen
-            else {
-              data[r] = m_pi->m_settings.threshold_green;
-            }
-#endif
-          }
-        }
+      if (InBearingArc(degAngle, m_start_bearing, m_end_bearing)) {
+        AddReturns(data, len, range_start, range_end);
         in_guard_zone = true;
       }
       break;
 
     case GZ_CIRCLE:
       if (range_start < len) {
-        if (range_end > len) {
-          range_end = len;
-        }
-
-        for (size_t r = range_start; r <= range_end; r++) {
-          if (data[r] >= m_pi->m_settings.threshold_blue) {
-            m_running_count++;
-          }
-#ifdef TEST_GUARD_ZONE_LOCATION
-          // Zap guard zone computation location to green so this is visible on screen
-          else {
-            data[r] = m_pi->m_settings.threshold_green;
-          }
-#endif
-        }
+        AddReturns(data, len, range_start, range_end);
         if (angle > m_last_angle) {
           in_guard_zone = true;
         }
@@ -187,9 +175,9 @@ void GuardZone::SearchTargets() {
     // loop with +2 increments as target must be larger than 2 pixels in width
     for (int angleIter = start_bearing; angleIter < end_bearing; angleIter += 2) {
       SpokeBearing angle = MOD_SPOKES(angleIter);
-      wxLongLong time1 = m_ri->m_history[angle].time;
+      wxLongLong time1 = m_ri->GetHistoryTime(angle);
       // time2 must be timed later than the pass 2 in refresh, otherwise target may be found multiple times
-      wxLongLong time2 = m_ri->m_history[MOD_SPOKES(angle + 3 * SCAN_MARGIN)].time;
+      wxLongLong time2 = m_ri->GetHistoryTime(MOD_SPOKES(angle + 3 * SCAN_MARGIN));
 
       // check if target has been refreshed since last time
       // and if the beam has passed the target location with SCAN_MARGIN spokes
@@ -197,7 +185,9 @@ void GuardZone::SearchTargets() {
            time2 >= time1)) {  // the beam sould have passed our "angle" AND a
                                // point SCANMARGIN further set new refresh time
         m_arpa_update_time[angle] = time1;
-        for (int rrr = (int)range_start; rrr < (int)range_end; rrr++) {
+        // Only look at the returns, skipping the empty bits a word at a time
+        for (int rrr = m_ri->m_history_bits->Find(HISTORY_TARGET, false, angle, (int)range_start, (int)range_end); rrr >= 0;
+             rrr = m_ri->m_history_bits->Find(HISTORY_TARGET, false, angle, rrr + 1, (int)range_end)) {
           if (m_ri->m_arpa->GetTargetCount() >= MAX_NUMBER_OF_TARGETS - 1) {
             LOG_INFO(wxT("No more scanning for ARPA targets in loop, maximum number of targets reached"));
             return;
@@ -0,0 +1,648 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+// Headless benchmark of the per-spoke processing pipeline.
+//
+// The spokes are either a synthetic picture or the spokes decoded from a
+// RadarCapture (.rcap) file of a Navico radar, in the order they were received.
+//
+// SpokePipeline, TrailBuffer, GuardZone, RadarDraw and Arpa are not linked in:
+// they all work on a RadarInfo, which needs a radar_pi, which derives from the
+// plugin API classes that only the OpenCPN executable implements. Their inner
+// loops do not need wxWidgets and are built into this program from the plugin
+// sources instead: the spoke conditioning kernel and max-pooling (simdutil), the
+// trail and guard zone loops (spokeutil), the ARPA history with its bit scan and
+// contour walk (SpokeHistory), and the Navico frame layout and nibble table.
+// Only the stage bookkeeping around them, and the colour lookup of the draw
+// stage, is done here.
+//
+// Usage: radar-bench [revolutions] [navico|raymarine-hd|garmin-xhd|capture.rcap]
+//
+// With a capture file, revolutions is the number of times all of its spokes are
+// processed.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <chrono>
+#include <vector>
+
+#include "RadarCaptureFile.h"
+#include "navico/NavicoFrame.h"
+
+// Build the plugin's inner loops into this program
+#define PLUGIN_BEGIN_NAMESPACE namespace RadarPlugin {
+#define PLUGIN_END_NAMESPACE }
+#include "SpokeHistory.cpp"
+#include "simdutil.cpp"
+#include "spokeutil.cpp"
+
+using RadarPlugin::PointInt;
+using RadarPlugin::SpokeHistory;
+
+typedef enum RadarType {
+#define DEFINE_RADAR(t, n, s, l, a, b, c, d) t,
+#include "RadarType.h"
+  RT_MAX
+} RadarType;
+
+#define BLOB_HISTORY_MAX (32)  // BLOB_HISTORY_31
+#define TRAIL_MAX_REVOLUTIONS (241)
+#define MARGIN (100)
+#define MIN_CONTOUR_LENGTH (6)
+#define SHADER_COLOR_CHANNELS (4)
+#define PYRAMID_LEVELS (3)
+#define PI (3.1415926535897932384626433832795)
+
+enum BenchStage { STAGE_CONDITION, STAGE_GUARD_ZONE, STAGE_TRUE_TRAILS, STAGE_RELATIVE_TRAILS, STAGE_DRAW, STAGE_BLOB_SEARCH, STAGES };
+
+static const char *stage_name[STAGES] = {"condition", "guard-zone", "true-trails", "relative-trails", "draw", "blob-search"};
+
+struct Geometry {
+  const char *name;
+  size_t spokes;
+  size_t spoke_len_max;
+};
+
+static const Geometry geometries[] = {
+    {"navico", 2048, 1024},
+    {"raymarine-hd", 2048, 1024},
+    {"garmin-xhd", 1440, 705},
+};
+
+struct Settings {
+  int main_bang_size;
+  int threshold;
+  uint8_t threshold_blue;
+  uint8_t threshold_green;
+  uint8_t threshold_red;
+};
+
+static const Settings settings = {10, 0, 32, 100, 200};
+
+// GuardZone settings, as fractions of the spoke length
+enum GuardZoneType { GZ_ARC, GZ_CIRCLE };
+
+struct GuardZoneSettings {
+  GuardZoneType type;
+  int start_bearing;  // degrees
+  int end_bearing;
+  double inner_range;
+  double outer_range;
+};
+
+static const GuardZoneSettings guard_zones[] = {
+    {GZ_ARC, 315, 45, 0.1, 0.5},
+    {GZ_CIRCLE, 0, 0, 0.6, 0.7},
+};
+
+#define GUARD_ZONES (sizeof(guard_zones) / sizeof(guard_zones[0]))
+
+typedef std::chrono::steady_clock Clock;
+
+static uint64_t Nanos(Clock::time_point a, Clock::time_point b) {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count();
+}
+
+static long PeakRSSKB() {
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+  }
+#endif
+  return 0;
+}
+
+// Simple deterministic pseudo random generator so runs are comparable.
+static uint32_t bench_seed = 12345;
+static uint32_t Random() {
+  bench_seed = bench_seed * 1103515245 + 12345;
+  return (bench_seed >> 16) & 0x7fff;
+}
+
+class PipelineBench {
+ public:
+  PipelineBench(const Geometry &g) {
+    m_spokes = g.spokes;
+    m_spoke_len_max = g.spoke_len_max;
+    m_trail_size = m_spoke_len_max * 2 + MARGIN * 2;
+    m_allocated = 0;
+
+    m_history_bits = new SpokeHistory(m_spokes, m_spoke_len_max);
+    m_words = m_history_bits->GetWords();
+    m_allocated += sizeof(uint64_t) * RadarPlugin::HISTORY_PLANES * m_spokes * m_words + sizeof(uint32_t) * m_spokes;
+    m_lookup = (PointInt *)Alloc(sizeof(PointInt) * m_spokes * (m_spoke_len_max + 1));
+    m_true_trails = (uint8_t *)Alloc(m_trail_size * m_trail_size);
+    m_relative_trails = (uint8_t *)Alloc(m_spokes * m_spoke_len_max);
+    m_texture = (uint8_t *)Alloc(SHADER_COLOR_CHANNELS * m_spokes * m_spoke_len_max);
+    for (int l = 0; l < PYRAMID_LEVELS; l++) {
+      m_level_len[l] = (m_spoke_len_max + (1 << l) - 1) >> l;
+      m_pyramid[l] = (uint8_t *)Alloc(((m_spokes + (1 << l) - 1) >> l) * m_level_len[l]);
+    }
+
+    for (size_t arc = 0; arc < m_spokes; arc++) {
+      float sine = sinf((float)arc * (float)PI * 2 / m_spokes);
+      float cosine = cosf((float)arc * (float)PI * 2 / m_spokes);
+      for (size_t radius = 0; radius <= m_spoke_len_max; radius++) {
+        PointInt *p = &m_lookup[arc * (m_spoke_len_max + 1) + radius];
+        p->x = (int16_t)(radius * cosine);
+        p->y = (int16_t)(radius * sine);
+      }
+    }
+
+    for (int i = 0; i <= UINT8_MAX; i++) {
+      uint8_t colour = 0;
+      if (i == UINT8_MAX) {
+        colour = 4;
+      } else if (i >= settings.threshold_red) {
+        colour = 3;
+      } else if (i >= settings.threshold_green) {
+        colour = 2;
+      } else if (i >= settings.threshold_blue && i > BLOB_HISTORY_MAX) {
+        colour = 1;
+      } else if (i > 0 && i <= BLOB_HISTORY_MAX) {
+        colour = 5;
+      }
+      m_colour_map[i] = colour;
+    }
+    static const uint8_t rgb[6][3] = {{0, 0, 0}, {0, 0, 255}, {0, 255, 0}, {255, 0, 0}, {255, 200, 200}, {255, 255, 255}};
+    memcpy(m_colour_rgb, rgb, sizeof(rgb));
+    uint8_t alpha = 255 * (10 - 5) / 10;
+    for (int i = 0; i <= UINT8_MAX; i++) {
+      uint8_t colour = m_colour_map[i];
+      uint8_t rgba[4] = {m_colour_rgb[colour][0], m_colour_rgb[colour][1], m_colour_rgb[colour][2], (uint8_t)(colour != 0 ? alpha : 0)};
+      memcpy(&m_colour_lut[i], rgba, sizeof(rgba));
+    }
+    for (int i = 0; i <= TRAIL_MAX_REVOLUTIONS; i++) {
+      m_trail_colour[i] = (uint8_t)(i == 0 ? 0 : 1 + (i * (BLOB_HISTORY_MAX - 1)) / TRAIL_MAX_REVOLUTIONS);
+    }
+
+    memset(m_ns, 0, sizeof(m_ns));
+    memset(m_reset_ns, 0, sizeof(m_reset_ns));
+    memset(m_level_ns, 0, sizeof(m_level_ns));
+    m_guard_count = 0;
+    m_doppler_count = 0;
+    m_blobs = 0;
+    m_processed = 0;
+    m_rotations = 0;
+  }
+
+  ~PipelineBench() {
+    delete m_history_bits;
+    free(m_lookup);
+    free(m_true_trails);
+    free(m_relative_trails);
+    free(m_texture);
+    for (int l = 0; l < PYRAMID_LEVELS; l++) {
+      free(m_pyramid[l]);
+    }
+  }
+
+  // Sea clutter with a few strong blobs and the occasional doppler target,
+  // every angle once.
+  void UseSyntheticRevolution() {
+    m_angles.resize(m_spokes);
+    m_source.assign(m_spokes * m_spoke_len_max, 0);
+    m_allocated += m_source.size();
+    for (size_t angle = 0; angle < m_spokes; angle++) {
+      uint8_t *line = &m_source[angle * m_spoke_len_max];
+      m_angles[angle] = (uint16_t)angle;
+      for (size_t r = 0; r < m_spoke_len_max; r++) {
+        uint32_t noise = Random() & 0xff;
+        line[r] = (uint8_t)(r < m_spoke_len_max / 8 ? noise : noise >> 2);
+      }
+    }
+    for (int target = 0; target < 40; target++) {
+      size_t a0 = Random() % m_spokes;
+      size_t r0 = 20 + Random() % (m_spoke_len_max - 40);
+      size_t w = 2 + Random() % 8;
+      uint8_t value = (target % 8 == 0) ? 255 : 240;
+      for (size_t a = a0; a < a0 + w; a++) {
+        for (size_t r = r0; r < r0 + w && r < m_spoke_len_max; r++) {
+          m_source[(a % m_spokes) * m_spoke_len_max + r] = value;
+        }
+      }
+    }
+  }
+
+  // Decoded spokes of m_spoke_len_max bytes each, and the angle of each one.
+  void UseSpokes(std::vector<uint16_t> &angles, std::vector<uint8_t> &spokes) {
+    m_angles.swap(angles);
+    m_source.swap(spokes);
+    m_allocated += m_source.size();
+  }
+
+  void Run(int revolutions) {
+    uint8_t *data = (uint8_t *)malloc(m_spoke_len_max);
+    Clock::time_point t[STAGES + 1];
+
+    for (int rev = 0; rev < revolutions; rev++) {
+      for (size_t i = 0; i < m_angles.size(); i++) {
+        size_t angle = m_angles[i];
+        size_t len = m_spoke_len_max;
+
+        if (i > 0 && angle < m_angles[i - 1]) {
+          BlobSearchRotation();
+        }
+        memcpy(data, &m_source[i * m_spoke_len_max], m_spoke_len_max);
+
+        t[0] = Clock::now();
+        Condition(angle, data, len);
+        t[1] = Clock::now();
+        GuardZone(angle, data, len);
+        t[2] = Clock::now();
+        TrueTrails(angle, data, len);
+        t[3] = Clock::now();
+        RelativeTrails(angle, data, len);
+        t[4] = Clock::now();
+        Draw(angle, data, len);
+        t[5] = Clock::now();
+        for (int s = 0; s < STAGE_BLOB_SEARCH; s++) {
+          m_ns[s] += Nanos(t[s], t[s + 1]);
+        }
+        m_processed++;
+      }
+      BlobSearchRotation();
+    }
+    free(data);
+  }
+
+  // RadarInfo::ResetSpokes, run on every range change and head up rotation.
+  // It used to clear the history and redraw every spoke of both the panel and
+  // the overlay with an empty buffer; now it only bumps the image generation and
+  // the shader blanks the stale rows of its texture on the next draw.
+  void MeasureReset(int repeats) {
+    uint8_t *zap = (uint8_t *)calloc(1, m_spoke_len_max);
+    uint32_t generation = 0;
+    uint32_t *row_generation = (uint32_t *)calloc(sizeof(uint32_t), m_spokes);
+    size_t row_size = m_spoke_len_max * SHADER_COLOR_CHANNELS;
+
+    Clock::time_point t0 = Clock::now();
+    for (int i = 0; i < repeats; i++) {
+      for (int p = 0; p < RadarPlugin::HISTORY_PLANES; p++) {
+        memset(m_history_bits->GetRow((RadarPlugin::HistoryPlane)p, 0), 0, sizeof(uint64_t) * m_spokes * m_words);
+      }
+      for (int draw = 0; draw < 2; draw++) {
+        for (size_t angle = 0; angle < m_spokes; angle++) {
+          Draw(angle, zap, m_spoke_len_max);
+        }
+      }
+    }
+    Clock::time_point t1 = Clock::now();
+    for (int i = 0; i < repeats; i++) {
+      generation++;
+      for (size_t angle = 0; angle < m_spokes; angle++) {
+        if (row_generation[angle] != generation) {
+          memset(m_texture + angle * row_size, 0, row_size);
+          row_generation[angle] = generation;
+        }
+      }
+    }
+    Clock::time_point t2 = Clock::now();
+    m_reset_ns[0] = Nanos(t0, t1) / repeats;
+    m_reset_ns[1] = Nanos(t1, t2) / repeats;
+    free(row_generation);
+    free(zap);
+  }
+
+  // The draw stage when zoomed out so far that a coarser pyramid level is shown
+  void MeasureDrawLevels(int revolutions) {
+    for (int l = 1; l < PYRAMID_LEVELS; l++) {
+      Clock::time_point t0 = Clock::now();
+      for (int rev = 0; rev < revolutions; rev++) {
+        for (size_t i = 0; i < m_angles.size(); i++) {
+          Draw(m_angles[i], &m_source[i * m_spoke_len_max], m_spoke_len_max, l);
+        }
+      }
+      m_level_ns[l] = Nanos(t0, Clock::now()) / ((uint64_t)revolutions * m_angles.size());
+    }
+  }
+
+  void Report(const char *name) {
+    uint64_t spokes = m_processed;
+    uint64_t total = 0;
+
+    for (int s = 0; s < STAGES; s++) {
+      total += m_ns[s];
+    }
+    printf("%s: %zu spokes x %zu, %lu spokes in %lu rotations, vector instructions %s\n", name, m_spokes, m_spoke_len_max,
+           (unsigned long)spokes, (unsigned long)m_rotations, RadarPlugin::GetSimdName());
+    for (int s = 0; s < STAGES; s++) {
+      printf("  %-16s %9.1f ns/spoke\n", stage_name[s], (double)m_ns[s] / spokes);
+    }
+    printf("  %-16s %9.1f ns/spoke = %.0f spokes/s\n", "total", (double)total / spokes, spokes * 1e9 / (double)total);
+    printf("  buffers %.1f MB, peak RSS %.1f MB\n", m_allocated / (1024. * 1024.), PeakRSSKB() / 1024.);
+    printf("  draw zoomed out: 1/2 %.1f ns/spoke, 1/4 %.1f ns/spoke\n", (double)m_level_ns[1], (double)m_level_ns[2]);
+    printf("  range change: zap every spoke %.1f us, image generation %.1f us\n", m_reset_ns[0] / 1000., m_reset_ns[1] / 1000.);
+    printf("  (doppler %lu guard %lu blobs %lu)\n", (unsigned long)m_doppler_count, (unsigned long)m_guard_count,
+           (unsigned long)m_blobs);
+  }
+
+ private:
+  void *Alloc(size_t n) {
+    void *p = calloc(1, n);
+    if (!p) {
+      fprintf(stderr, "Out of memory\n");
+      exit(1);
+    }
+    m_allocated += n;
+    return p;
+  }
+
+  // SpokePipeline condition stage: main bang, threshold and ARPA history bits
+  void Condition(size_t bearing, uint8_t *data, size_t len) {
+    int threshold = settings.threshold;
+    if (threshold > 0) {
+      threshold = threshold * (255 - BLOB_HISTORY_MAX) / 100 + BLOB_HISTORY_MAX;
+    }
+    m_doppler_count += m_history_bits->ConditionRow((int)bearing, data, len, settings.main_bang_size, (uint8_t)threshold,
+                                                    settings.threshold_red);
+  }
+
+  // GuardZone::ProcessSpoke of every zone in guard_zones, with the alarm on
+  void GuardZone(size_t angle, uint8_t *data, size_t len) {
+    int degrees = (int)(angle * 360.0 / m_spokes);
+
+    for (size_t z = 0; z < GUARD_ZONES; z++) {
+      const GuardZoneSettings &zone = guard_zones[z];
+      size_t range_start = (size_t)(zone.inner_range * m_spoke_len_max);
+      size_t range_end = (size_t)(zone.outer_range * m_spoke_len_max);
+
+      if (zone.type == GZ_ARC && !RadarPlugin::InBearingArc(degrees, zone.start_bearing, zone.end_bearing)) {
+        continue;
+      }
+      m_guard_count += RadarPlugin::CountReturns(data, len, range_start, range_end, settings.threshold_blue);
+    }
+  }
+
+  // TrailBuffer::UpdateTrueTrails, with a zero offset and relative motion
+  void TrueTrails(size_t bearing, uint8_t *data, size_t len) {
+    RadarPlugin::UpdateTrueTrailSpoke(m_lookup + bearing * (m_spoke_len_max + 1), m_true_trails, m_trail_size,
+                                      (int)m_trail_size / 2, (int)m_trail_size / 2, data, len, m_spoke_len_max,
+                                      settings.threshold_blue, settings.threshold_red, TRAIL_MAX_REVOLUTIONS, 0);
+  }
+
+  // TrailBuffer::UpdateRelativeTrails, relative motion
+  void RelativeTrails(size_t angle, uint8_t *data, size_t len) {
+    RadarPlugin::UpdateRelativeTrailSpoke(m_relative_trails + angle * m_spoke_len_max, data, len, m_spoke_len_max,
+                                          settings.threshold_blue, settings.threshold_red, TRAIL_MAX_REVOLUTIONS, m_trail_colour);
+  }
+
+  // RadarDrawShader::ProcessRadarSpoke
+  // SpokePyramid::SetSpoke, keep the spoke and max-pool it into the coarser levels
+  void Pool(size_t angle, uint8_t *data, size_t len) {
+    size_t row = angle;
+
+    memcpy(m_pyramid[0] + row * m_spoke_len_max, data, len);
+    memset(m_pyramid[0] + row * m_spoke_len_max + len, 0, m_spoke_len_max - len);
+    for (int l = 1; l < PYRAMID_LEVELS; l++) {
+      size_t fine_len = m_level_len[l - 1];
+      uint8_t *src = m_pyramid[l - 1] + row * fine_len;
+      uint8_t *src2 = m_pyramid[l - 1] + (row ^ 1) * fine_len;
+      row >>= 1;
+      RadarPlugin::MaxPool2x2(src, src2, m_pyramid[l] + row * m_level_len[l], fine_len);
+    }
+  }
+
+  // RadarDrawShader::ProcessRadarSpoke, pool the spoke and convert the line of
+  // the pyramid level that is being drawn to RGBA with RadarDraw::GetColourLUT
+  void Draw(size_t angle, uint8_t *data, size_t len, int level = 0) {
+    size_t row = angle >> level;
+    size_t line_len = m_level_len[level];
+    const uint8_t *s = m_pyramid[level] + row * line_len;
+    uint32_t *d = (uint32_t *)(m_texture + row * line_len * SHADER_COLOR_CHANNELS);
+
+    Pool(angle, data, len);
+    for (size_t r = 0; r < line_len; r++) {
+      d[r] = m_colour_lut[s[r]];
+    }
+  }
+
+  void BlobSearchRotation() {
+    Clock::time_point t0 = Clock::now();
+    BlobSearch();
+    m_ns[STAGE_BLOB_SEARCH] += Nanos(t0, Clock::now());
+    m_rotations++;
+  }
+
+  // The blob search that Arpa::SearchDopplerTargets and GuardZone::SearchTargets
+  // do once per rotation: only the set bits of the history plane are visited
+  // (SpokeHistory::Find) and each one is tested for a contour (Arpa::MultiPix).
+  // This is not Arpa::RefreshArpaTargets, which tracks the targets found with
+  // Kalman filters and needs the own ship position and heading.
+  void BlobSearch() {
+    int r_start = 20;
+    int r_end = (int)m_spoke_len_max - 5;
+    for (int angle = 0; angle < (int)m_spokes; angle += 2) {
+      for (int r = m_history_bits->Find(RadarPlugin::HISTORY_TARGET, false, angle, r_start, r_end); r >= 0;
+           r = m_history_bits->Find(RadarPlugin::HISTORY_TARGET, false, angle, r + 1, r_end)) {
+        if (m_history_bits->HasContour(RadarPlugin::HISTORY_TARGET, false, angle, r, MIN_CONTOUR_LENGTH)) {
+          m_blobs++;
+        }
+      }
+    }
+  }
+
+  size_t m_spokes;
+  size_t m_spoke_len_max;
+  size_t m_trail_size;
+  size_t m_allocated;
+
+  std::vector<uint8_t> m_source;    // spokes to process, m_spoke_len_max bytes each
+  std::vector<uint16_t> m_angles;   // angle of each spoke in m_source
+  size_t m_words;              // 64 bit words per history row
+  SpokeHistory *m_history_bits;
+  PointInt *m_lookup;          // PolarToCartesianLookup
+  uint8_t *m_true_trails;      // m_trail_size * m_trail_size
+  uint8_t *m_relative_trails;  // m_spokes * m_spoke_len_max
+  uint8_t *m_texture;          // RadarDrawShader::m_data
+  uint8_t *m_pyramid[PYRAMID_LEVELS];  // SpokePyramid levels
+  size_t m_level_len[PYRAMID_LEVELS];
+
+  uint8_t m_colour_map[UINT8_MAX + 1];
+  uint8_t m_colour_rgb[6][3];
+  uint32_t m_colour_lut[UINT8_MAX + 1];  // RadarDraw::m_lut
+  uint8_t m_trail_colour[TRAIL_MAX_REVOLUTIONS + 1];
+
+  uint64_t m_ns[STAGES];
+  uint64_t m_level_ns[PYRAMID_LEVELS];  // draw stage per pyramid level
+  uint64_t m_reset_ns[2];  // ResetSpokes by zapping every spoke, by image generation
+  uint64_t m_guard_count;
+  uint64_t m_doppler_count;
+  uint64_t m_blobs;
+  uint64_t m_processed;  // spokes through all stages
+  uint64_t m_rotations;
+};
+
+// Decode all spokes of a Navico capture file, in the order they were received,
+// the same way NavicoReceive::ProcessFrame does without doppler.
+static bool ReadCapture(const char *filename, std::vector<uint16_t> *angles, std::vector<uint8_t> *spokes) {
+  FILE *f = fopen(filename, "rb");
+  if (!f) {
+    perror(filename);
+    return false;
+  }
+  std::vector<uint8_t> file;
+  uint8_t buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    file.insert(file.end(), buf, buf + n);
+  }
+  fclose(f);
+
+  RadarCaptureFileHeader header;
+  if (file.size() < sizeof(header)) {
+    fprintf(stderr, "%s: not a radar capture file\n", filename);
+    return false;
+  }
+  memcpy(&header, &file[0], sizeof(header));
+  if (memcmp(header.magic, RADAR_CAPTURE_MAGIC, sizeof(header.magic)) != 0 || header.version != RADAR_CAPTURE_VERSION) {
+    fprintf(stderr, "%s: not a radar capture file\n", filename);
+    return false;
+  }
+  switch (header.radar_type) {
+    case RT_BR24:
+    case RT_3G:
+    case RT_4GA:
+    case RT_4GB:
+    case RT_HaloA:
+    case RT_HaloB:
+      break;
+    default:
+      fprintf(stderr, "%s: radar type %u is not a Navico radar, cannot decode it\n", filename, (unsigned int)header.radar_type);
+      return false;
+  }
+
+  // Records end where the rotation index starts, if the file has one
+  size_t end = file.size();
+  RadarCaptureTrailer trailer;
+  if (end >= sizeof(header) + sizeof(trailer)) {
+    memcpy(&trailer, &file[end - sizeof(trailer)], sizeof(trailer));
+    if (memcmp(trailer.magic, RADAR_CAPTURE_INDEX_MAGIC, sizeof(trailer.magic)) == 0 && trailer.index_offset <= end) {
+      end = (size_t)trailer.index_offset;
+    }
+  }
+
+  size_t offset = sizeof(header);
+  RadarCaptureRecord record;
+  while (offset + sizeof(record) <= end) {
+    memcpy(&record, &file[offset], sizeof(record));
+    offset += sizeof(record);
+    if (record.len > end - offset) {
+      break;  // Truncated
+    }
+    const uint8_t *frame = &file[offset];
+    offset += record.len;
+
+    size_t frame_hdr = sizeof(((radar_frame_pkt *)0)->frame_hdr);
+    if (record.len < frame_hdr + sizeof(radar_line)) {
+      continue;  // Empty record
+    }
+    size_t lines = (record.len - frame_hdr) / sizeof(radar_line);
+    for (size_t l = 0; l < lines; l++) {
+      const radar_line *line = (const radar_line *)(frame + frame_hdr + l * sizeof(radar_line));
+      int angle_raw = (line->common.angle[1] << 8) | line->common.angle[0];
+
+      angles->push_back((uint16_t)((angle_raw / 2) % NAVICO_SPOKES));
+      spokes->resize(spokes->size() + NAVICO_SPOKE_LEN);
+      RadarPlugin::ExpandNibbles(lookupNibbleToByte, line->data, &(*spokes)[spokes->size() - NAVICO_SPOKE_LEN],
+                                 NAVICO_SPOKE_LEN / 2);
+    }
+  }
+  if (angles->empty()) {
+    fprintf(stderr, "%s: no spokes in capture file\n", filename);
+    return false;
+  }
+  return true;
+}
+
+static bool EndsWith(const char *s, const char *suffix) {
+  size_t len = strlen(s);
+  size_t suffix_len = strlen(suffix);
+
+  return len >= suffix_len && strcmp(s + len - suffix_len, suffix) == 0;
+}
+
+int main(int argc, char **argv) {
+  int revolutions = 20;
+  const char *only = 0;
+
+  if (argc > 1) {
+    revolutions = atoi(argv[1]);
+    if (revolutions <= 0) {
+      fprintf(stderr, "Usage: %s [revolutions] [navico|raymarine-hd|garmin-xhd|capture.rcap]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (argc > 2) {
+    only = argv[2];
+  }
+
+  if (only && EndsWith(only, ".rcap")) {
+    std::vector<uint16_t> angles;
+    std::vector<uint8_t> spokes;
+    if (!ReadCapture(only, &angles, &spokes)) {
+      return 1;
+    }
+    Geometry g = {only, NAVICO_SPOKES, NAVICO_SPOKE_LEN};
+    PipelineBench bench(g);
+    bench.UseSpokes(angles, spokes);
+    bench.Run(revolutions);
+    bench.MeasureReset(revolutions);
+    bench.MeasureDrawLevels(revolutions);
+    bench.Report(only);
+    return 0;
+  }
+
+  for (size_t i = 0; i < sizeof(geometries) / sizeof(geometries[0]); i++) {
+    if (only && strcmp(only, geometries[i].name) != 0) {
+      continue;
+    }
+    PipelineBench bench(geometries[i]);
+    bench.UseSyntheticRevolution();
+    bench.Run(revolutions);
+    bench.MeasureReset(revolutions);
+    bench.MeasureDrawLevels(revolutions);
+    bench.Report(geometries[i].name);
+  }
+  return 0;
+}
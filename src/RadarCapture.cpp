@@ -0,0 +1,309 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "RadarCapture.h"
+
+#include "RadarInfo.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+#define CAPTURE_FLUSH_MILLIS (1000)
+#define CAPTURE_INDEX_GROW (256)
+
+RadarCapture::RadarCapture(RadarInfo *ri) : wxThread(wxTHREAD_JOINABLE) {
+  m_ri = ri;
+  m_file = 0;
+  m_head = 0;
+  m_tail = 0;
+  m_queued_bytes = 0;
+  m_stop = false;
+  m_frames = 0;
+  m_dropped = 0;
+  m_offset = 0;
+  m_last_record_offset = 0;
+  m_last_record_time = 0;
+  m_records = 0;
+  m_index = 0;
+  m_index_count = 0;
+  m_index_allocated = 0;
+}
+
+RadarCapture::~RadarCapture() {
+  CaptureBlock *block = m_head;
+
+  while (block) {
+    CaptureBlock *next = block->next;
+    free(block);
+    block = next;
+  }
+  if (m_file) {
+    fclose(m_file);
+  }
+  if (m_index) {
+    free(m_index);
+  }
+}
+
+/*
+ * Open the capture file and start the writer thread.
+ */
+bool RadarCapture::Open(const wxString &filename) {
+  RadarCaptureFileHeader header;
+
+  m_filename = filename;
+  m_file = fopen(filename.mb_str(), "wb");
+  if (!m_file) {
+    wxLogError(wxT("%s cannot create capture file %s: %s"), m_ri->m_name.c_str(), filename.c_str(), strerror(errno));
+    return false;
+  }
+  setvbuf(m_file, 0, _IOFBF, 256 * 1024);
+
+  CLEAR_STRUCT(header);
+  memcpy(header.magic, RADAR_CAPTURE_MAGIC, sizeof(header.magic));
+  header.version = RADAR_CAPTURE_VERSION;
+  header.radar_type = m_ri->m_radar_type;
+  header.spokes = m_ri->m_spokes;
+  header.spoke_len_max = m_ri->m_spoke_len_max;
+  header.start_time = wxGetUTCTimeMillis().GetValue();
+  if (fwrite(&header, sizeof(header), 1, m_file) != 1) {
+    wxLogError(wxT("%s cannot write capture file %s"), m_ri->m_name.c_str(), filename.c_str());
+    fclose(m_file);
+    m_file = 0;
+    return false;
+  }
+  m_offset = sizeof(header);
+
+  if (Create(64 * 1024) != wxTHREAD_NO_ERROR || Run() != wxTHREAD_NO_ERROR) {
+    wxLogError(wxT("%s cannot start capture thread"), m_ri->m_name.c_str());
+    fclose(m_file);
+    m_file = 0;
+    return false;
+  }
+  LOG_INFO(wxT("%s recording raw frames to %s"), m_ri->m_name.c_str(), filename.c_str());
+  return true;
+}
+
+/*
+ * Stop the writer thread. It writes all frames that are still queued,
+ * followed by the rotation index.
+ */
+void RadarCapture::Close() {
+  {
+    wxCriticalSectionLocker lock(m_exclusive);
+    m_stop = true;
+  }
+  m_wakeup.Post();
+  Wait();
+  LOG_INFO(wxT("%s capture %s closed, %u frames, %u dropped"), m_ri->m_name.c_str(), m_filename.c_str(), m_frames, m_dropped);
+}
+
+/*
+ * Called by the receive thread for every raw frame, before it is decoded.
+ */
+void RadarCapture::AddFrame(const uint8_t *data, size_t len, wxLongLong time, const NetworkAddress &source) {
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  if (m_stop) {
+    return;
+  }
+  if (m_queued_bytes + len > RADAR_CAPTURE_QUEUE_MAX) {
+    m_dropped++;
+    return;
+  }
+
+  CaptureBlock *block = (CaptureBlock *)malloc(sizeof(CaptureBlock) + len);
+  if (!block) {
+    m_dropped++;
+    return;
+  }
+  block->next = 0;
+  block->rotation = false;
+  CLEAR_STRUCT(block->record);
+  block->record.len = len;
+  block->record.radar_type = m_ri->m_radar_type;
+  block->record.time = time.GetValue();
+  block->record.source_addr = source.addr.s_addr;
+  block->record.source_port = source.port;
+  memcpy(block->data, data, len);
+
+  m_queued_bytes += len;
+  m_frames++;
+  if (m_tail) {
+    m_tail->next = block;
+  } else {
+    m_head = block;
+    m_wakeup.Post();  // Writer only needs waking when the queue was empty
+  }
+  m_tail = block;
+}
+
+/*
+ * Called by the receive thread when the antenna passes bearing zero.
+ * The rotation starts in the frame that was added most recently.
+ */
+void RadarCapture::MarkRotation() {
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  if (m_stop || (m_tail && m_tail->rotation)) {
+    return;
+  }
+
+  CaptureBlock *block = (CaptureBlock *)malloc(sizeof(CaptureBlock));
+  if (!block) {
+    return;
+  }
+  block->next = 0;
+  block->rotation = true;
+  CLEAR_STRUCT(block->record);
+  if (m_tail) {
+    m_tail->next = block;
+  } else {
+    m_head = block;
+  }
+  m_tail = block;
+}
+
+wxString RadarCapture::GetStatusText() {
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  return wxString::Format(wxT("capture %u frames, %u dropped, %u KB queued"), m_frames, m_dropped,
+                          (unsigned int)(m_queued_bytes / 1024));
+}
+
+/*
+ * Write and free a list of blocks. Returns the number of frame bytes freed, which
+ * stay counted in m_queued_bytes until then.
+ */
+size_t RadarCapture::WriteBlocks(CaptureBlock *block) {
+  size_t freed = 0;
+
+  while (block) {
+    CaptureBlock *next = block->next;
+
+    if (block->rotation) {
+      if (m_records > 0) {
+        if (m_index_count == m_index_allocated) {
+          size_t allocated = m_index_allocated + CAPTURE_INDEX_GROW;
+          RadarCaptureIndexEntry *index = (RadarCaptureIndexEntry *)realloc(m_index, allocated * sizeof(RadarCaptureIndexEntry));
+          if (index) {
+            m_index = index;
+            m_index_allocated = allocated;
+          }
+        }
+        if (m_index_count < m_index_allocated) {
+          RadarCaptureIndexEntry *entry = &m_index[m_index_count++];
+          entry->offset = m_last_record_offset;
+          entry->time = m_last_record_time;
+          entry->record = m_records - 1;
+          entry->reserved = 0;
+        }
+      }
+    } else if (m_file) {
+      size_t len = block->record.len;
+
+      if (fwrite(&block->record, sizeof(block->record), 1, m_file) != 1 || fwrite(block->data, 1, len, m_file) != len) {
+        wxLogError(wxT("%s error writing capture file %s, recording stopped"), m_ri->m_name.c_str(), m_filename.c_str());
+        fclose(m_file);
+        m_file = 0;
+      } else {
+        m_last_record_offset = m_offset;
+        m_last_record_time = block->record.time;
+        m_offset += sizeof(block->record) + len;
+        m_records++;
+      }
+    }
+    if (!block->rotation) {
+      freed += block->record.len;
+    }
+    free(block);
+    block = next;
+  }
+  return freed;
+}
+
+void RadarCapture::WriteIndex() {
+  RadarCaptureTrailer trailer;
+
+  if (!m_file) {
+    return;
+  }
+
+  CLEAR_STRUCT(trailer);
+  trailer.index_offset = m_offset;
+  trailer.index_count = m_index_count;
+  trailer.record_count = m_records;
+  memcpy(trailer.magic, RADAR_CAPTURE_INDEX_MAGIC, sizeof(trailer.magic));
+
+  if ((m_index_count > 0 && fwrite(m_index, sizeof(RadarCaptureIndexEntry), m_index_count, m_file) != m_index_count) ||
+      fwrite(&trailer, sizeof(trailer), 1, m_file) != 1) {
+    wxLogError(wxT("%s error writing capture index %s"), m_ri->m_name.c_str(), m_filename.c_str());
+  }
+}
+
+void *RadarCapture::Entry(void) {
+  wxLongLong last_flush = wxGetUTCTimeMillis();
+  bool stop = false;
+
+  while (!stop) {
+    m_wakeup.WaitTimeout(CAPTURE_FLUSH_MILLIS);
+
+    CaptureBlock *block;
+    {
+      wxCriticalSectionLocker lock(m_exclusive);
+
+      block = m_head;
+      m_head = 0;
+      m_tail = 0;
+      stop = m_stop;
+    }
+    size_t freed = WriteBlocks(block);
+    if (freed > 0) {
+      wxCriticalSectionLocker lock(m_exclusive);
+
+      m_queued_bytes -= freed;
+    }
+
+    wxLongLong now = wxGetUTCTimeMillis();
+    if (m_file && now > last_flush + CAPTURE_FLUSH_MILLIS) {
+      fflush(m_file);
+      last_flush = now;
+    }
+  }
+
+  WriteIndex();
+  if (m_file) {
+    fclose(m_file);
+    m_file = 0;
+  }
+  return 0;
+}
+
+PLUGIN_END_NAMESPACE
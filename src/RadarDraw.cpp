@@ -33,6 +33,7 @@
 
 #include "RadarDrawShader.h"
 #include "RadarDrawVertex.h"
+#include "RadarInfo.h"
 
 PLUGIN_BEGIN_NAMESPACE
 
@@ -51,6 +52,17 @@ RadarDraw* RadarDraw::make_Draw(RadarInfo* ri, int draw_method) {
 
 RadarDraw::~RadarDraw() {}
 
+const uint32_t* RadarDraw::GetColourLUT(RadarInfo* ri, int transparency) {
+  uint32_t version = ri->m_colour_map_version;
+
+  if (transparency != m_lut_transparency || version != m_lut_version) {
+    ri->BuildColourLUT(transparency, m_lut);
+    m_lut_transparency = transparency;
+    m_lut_version = version;
+  }
+  return m_lut;
+}
+
 void RadarDraw::GetDrawingMethods(wxArrayString& methods) {
   wxString m[] = {_("Vertex Array"), _("Shader")};
 
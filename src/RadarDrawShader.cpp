@@ -101,10 +101,15 @@ bool RadarDrawShader::Init(size_t spokes, size_t spoke_len_max) {
   glGenTextures(1, &m_texture);
   glBindTexture(GL_TEXTURE_2D, m_texture);
 
-  if (m_data) {
-    free(m_data);
-  }
+  m_pyramid = new SpokePyramid(m_spokes, m_spoke_len_max);
+  m_level = 0;
+  m_drawn_generation = m_ri->m_image_generation;
   m_data = (unsigned char *)calloc(SHADER_COLOR_CHANNELS, m_spoke_len_max * m_spokes);
+  if (!m_data) {
+    wxLogError(wxT("Out of memory"));
+    Reset();
+    return false;
+  }
   // Tell the GPU the size of the texture:
   glTexImage2D(/* target          = */ GL_TEXTURE_2D,
                /* level           = */ 0,
@@ -146,6 +151,10 @@ void RadarDrawShader::Reset() {
     free(m_data);
     m_data = 0;
   }
+  if (m_pyramid) {
+    delete m_pyramid;
+    m_pyramid = 0;
+  }
 }
 
 RadarDrawShader::~RadarDrawShader() {
@@ -154,7 +163,61 @@ RadarDrawShader::~RadarDrawShader() {
   Reset();
 }
 
-void RadarDrawShader::DrawRadarOverlayImage(double radar_scale, double panel_rotate) {
+/*
+ * Convert one line of the current pyramid level to texture pixels. Lines that
+ * have not been received since the last ResetSpokes() are blank.
+ */
+void RadarDrawShader::ConvertLine(size_t line, uint32_t generation) {
+  size_t len = m_pyramid->GetSpokeLen(m_level);
+  uint8_t *data = m_pyramid->GetRow(m_level, line);
+  unsigned char *d = m_data + line * len * m_channels;
+
+  if (!m_pyramid->IsCurrent(m_level, line, generation)) {
+    memset(d, 0, len * m_channels);
+    return;
+  }
+  if (m_channels == SHADER_COLOR_CHANNELS) {
+    // One lookup per sample gives all four bytes
+    const uint32_t *lut = GetColourLUT(m_ri, m_transparency);
+    uint32_t *d32 = (uint32_t *)d;
+    for (size_t r = 0; r < len; r++) {
+      d32[r] = lut[data[r]];
+    }
+  } else {
+    GLubyte alpha = 255 * (MAX_OVERLAY_TRANSPARENCY - m_transparency) / MAX_OVERLAY_TRANSPARENCY;
+    for (size_t r = 0; r < len; r++) {
+      GLubyte strength = data[r];
+      BlobColour colour = m_ri->m_colour_map[strength];
+      *d++ = (m_ri->m_colour_map_rgb[colour].Red() * alpha) >> 8;
+    }
+  }
+}
+
+/*
+ * Switch the texture to another pyramid level, converting all of its lines.
+ */
+void RadarDrawShader::SetLevel(int level) {
+  uint32_t generation = m_ri->m_image_generation;
+
+  m_level = level;
+  for (size_t line = 0; line < m_pyramid->GetSpokes(m_level); line++) {
+    ConvertLine(line, generation);
+  }
+  glTexImage2D(/* target          = */ GL_TEXTURE_2D,
+               /* level           = */ 0,
+               /* internal_format = */ m_format,
+               /* width           = */ m_pyramid->GetSpokeLen(m_level),
+               /* heigth          = */ m_pyramid->GetSpokes(m_level),
+               /* border          = */ 0,
+               /* format          = */ m_format,
+               /* type            = */ GL_UNSIGNED_BYTE,
+               /* data            = */ m_data);
+  m_drawn_generation = generation;
+  m_start_line = -1;
+  m_lines = 0;
+}
+
+void RadarDrawShader::DrawRadarImage(double pixels_per_sample) {
   wxCriticalSectionLocker lock(m_exclusive);
 
   if (!m_program || !m_texture || !m_data) {
@@ -167,11 +230,20 @@ void RadarDrawShader::DrawRadarOverlayImage(double radar_scale, double panel_rot
 
   glBindTexture(GL_TEXTURE_2D, m_texture);
 
+  // Zoomed past another pyramid level, or the image was reset since the last
+  // draw: start the texture afresh.
+  int level = m_pyramid->ChooseLevel(pixels_per_sample);
+  if (level != m_level || m_ri->m_image_generation != m_drawn_generation) {
+    SetLevel(level);
+  }
+
+  int lines = (int)m_pyramid->GetSpokes(m_level);
+  size_t width = m_pyramid->GetSpokeLen(m_level);
   if (m_start_line > -1) {
     // Since the last time we have received data from [m_start_line, m_end_line>
     // so we only need to update the texture for those data lines.
-    if (m_start_line + m_lines > (int)m_spokes) {
-      int end_line = (m_start_line + m_lines) % m_spokes;
+    if (m_start_line + m_lines > lines) {
+      int end_line = (m_start_line + m_lines) % lines;
       // if the new data partly wraps past the end of the texture
       // tell it the two parts separately
       // First remap [0, m_end_line>
@@ -179,32 +251,32 @@ void RadarDrawShader::DrawRadarOverlayImage(double radar_scale, double panel_rot
                       /* level =    */ 0,
                       /* x-offset = */ 0,
                       /* y-offset = */ 0,
-                      /* width =    */ m_spoke_len_max,
+                      /* width =    */ width,
                       /* height =   */ end_line,
                       /* format =   */ m_format,
                       /* type =     */ GL_UNSIGNED_BYTE,
                       /* pixels =   */ m_data);
-      // And then remap [m_start_line, m_spokes>
+      // And then remap [m_start_line, lines>
       glTexSubImage2D(/* target =   */ GL_TEXTURE_2D,
                       /* level =    */ 0,
                       /* x-offset = */ 0,
                       /* y-offset = */ m_start_line,
-                      /* width =    */ m_spoke_len_max,
-                      /* height =   */ m_spokes - m_start_line,
+                      /* width =    */ width,
+                      /* height =   */ lines - m_start_line,
                       /* format =   */ m_format,
                       /* type =     */ GL_UNSIGNED_BYTE,
-                      /* pixels =   */ m_data + m_start_line * m_spoke_len_max * m_channels);
+                      /* pixels =   */ m_data + m_start_line * width * m_channels);
     } else {
       // Map [m_start_line, m_end_line>
       glTexSubImage2D(/* target =   */ GL_TEXTURE_2D,
                       /* level =    */ 0,
                       /* x-offset = */ 0,
                       /* y-offset = */ m_start_line,
-                      /* width =    */ m_spoke_len_max,
+                      /* width =    */ width,
                       /* height =   */ m_lines,
                       /* format =   */ m_format,
                       /* type =     */ GL_UNSIGNED_BYTE,
-                      /* pixels =   */ m_data + m_start_line * m_spoke_len_max * m_channels);
+                      /* pixels =   */ m_data + m_start_line * width * m_channels);
     }
     m_start_line = -1;
     m_lines = 0;
@@ -228,47 +300,35 @@ void RadarDrawShader::DrawRadarOverlayImage(double radar_scale, double panel_rot
   glPopAttrib();
 }
 
-void RadarDrawShader::DrawRadarPanelImage(double panel_scale, double panel_rotate) { DrawRadarOverlayImage(1., 0.); }
+void RadarDrawShader::DrawRadarOverlayImage(double radar_scale, double panel_rotate) { DrawRadarImage(radar_scale); }
+
+void RadarDrawShader::DrawRadarPanelImage(double panel_scale, double panel_rotate) {
+  // One unit of panel_scale is m_radar_radius / m_panel_zoom pixels
+  DrawRadarImage(panel_scale * m_ri->m_radar_radius / m_ri->m_panel_zoom);
+}
 
 void RadarDrawShader::ProcessRadarSpoke(int transparency, SpokeBearing angle, uint8_t *data, size_t len, GeoPosition spoke_pos) {
-  GLubyte alpha = 255 * (MAX_OVERLAY_TRANSPARENCY - transparency) / MAX_OVERLAY_TRANSPARENCY;
   wxCriticalSectionLocker lock(m_exclusive);
 
-  if (m_start_line == -1) {
-    m_start_line = angle;  // Note that this only runs once after each draw,
+  if (!m_pyramid || angle < 0 || angle >= (int)m_spokes) {
+    return;
   }
-  if (m_lines < (int)m_spokes) {
-    m_lines++;
+  uint32_t generation = m_ri->m_image_generation;
+  m_pyramid->SetSpoke(angle, data, len, generation);
+  m_transparency = transparency;
+  if (generation != m_drawn_generation) {
+    return;  // The next draw converts the whole texture anyway
   }
 
-  if (m_channels == SHADER_COLOR_CHANNELS) {
-    unsigned char *d = m_data + (angle * m_spoke_len_max) * m_channels;
-    for (size_t r = 0; r < len; r++) {
-      GLubyte strength = data[r];
-      BlobColour colour = m_ri->m_colour_map[strength];
-      d[0] = m_ri->m_colour_map_rgb[colour].Red();
-      d[1] = m_ri->m_colour_map_rgb[colour].Green();
-      d[2] = m_ri->m_colour_map_rgb[colour].Blue();
-      d[3] = colour != BLOB_NONE ? alpha : 0;
-      d += m_channels;
-    }
-    for (size_t r = len; r < m_spoke_len_max; r++) {
-      *d++ = 0;
-      *d++ = 0;
-      *d++ = 0;
-      *d++ = 0;
-    }
+  int line = angle >> m_level;
+  int lines = (int)m_pyramid->GetSpokes(m_level);
+  if (m_start_line == -1) {
+    m_start_line = line;  // Note that this only runs once after each draw,
+    m_lines = 1;
   } else {
-    unsigned char *d = m_data + (angle * m_spoke_len_max);
-    for (size_t r = 0; r < len; r++) {
-      GLubyte strength = data[r];
-      BlobColour colour = m_ri->m_colour_map[strength];
-      *d++ = (m_ri->m_colour_map_rgb[colour].Red() * alpha) >> 8;
-    }
-    for (size_t r = len; r < m_spoke_len_max; r++) {
-      *d++ = 0;
-    }
+    m_lines = wxMax(m_lines, (line - m_start_line + lines) % lines + 1);
   }
+  ConvertLine(line, generation);
 }
 
 PLUGIN_END_NAMESPACE
@@ -39,7 +39,7 @@ PLUGIN_BEGIN_NAMESPACE
 bool RadarDrawVertex::Init(size_t spokes, size_t spoke_len_max) {
   wxCriticalSectionLocker lock(m_exclusive);
 
-  if (m_spokes != spokes) {
+  if (m_spokes != spokes || m_spoke_len_max != spoke_len_max) {
     Reset();
   }
   m_spokes = spokes;                // How many spokes form a circle
@@ -48,7 +48,14 @@ bool RadarDrawVertex::Init(size_t spokes, size_t spoke_len_max) {
   if (!m_vertices) {
     m_vertices = (VertexLine*)calloc(sizeof(VertexLine), m_spokes);
   }
-  if (!m_vertices) {
+  if (!m_spoke_info) {
+    m_spoke_info = (SpokeInfo*)calloc(sizeof(SpokeInfo), m_spokes);
+  }
+  if (!m_pyramid) {
+    m_pyramid = new SpokePyramid(m_spokes, m_spoke_len_max);
+    m_level = 0;
+  }
+  if (!m_vertices || !m_spoke_info) {
     if (!m_oom) {
       wxLogError(wxT("Out of memory"));
       m_oom = true;
@@ -69,20 +76,24 @@ void RadarDrawVertex::Reset() {
     free(m_vertices);
     m_vertices = 0;
   }
+  if (m_spoke_info) {
+    free(m_spoke_info);
+    m_spoke_info = 0;
+  }
+  if (m_pyramid) {
+    delete m_pyramid;
+    m_pyramid = 0;
+  }
 }
 
-#define ADD_VERTEX_POINT(angle, radius, r, g, b, a)                         \
+#define ADD_VERTEX_POINT(angle, radius, rgba)                                \
   {                                                                         \
     line->points[count].xy = m_ri->m_polar_lookup->GetPoint(angle, radius); \
-    line->points[count].red = r;                                            \
-    line->points[count].green = g;                                          \
-    line->points[count].blue = b;                                           \
-    line->points[count].alpha = a;                                          \
+    memcpy(&line->points[count].red, &rgba, sizeof(uint32_t));              \
     count++;                                                                \
   }
 
-void RadarDrawVertex::SetBlob(VertexLine* line, int angle_begin, int angle_end, int r1, int r2, GLubyte red, GLubyte green,
-                              GLubyte blue, GLubyte alpha) {
+void RadarDrawVertex::SetBlob(VertexLine* line, int angle_begin, int angle_end, int r1, int r2, uint32_t rgba) {
   if (r2 == 0) {
     return;
   }
@@ -105,33 +116,56 @@ void RadarDrawVertex::SetBlob(VertexLine* line, int angle_begin, int angle_end,
   }
 
   // First triangle
-  ADD_VERTEX_POINT(arc1, r1, red, green, blue, alpha);
-  ADD_VERTEX_POINT(arc1, r2, red, green, blue, alpha);
-  ADD_VERTEX_POINT(arc2, r1, red, green, blue, alpha);
+  ADD_VERTEX_POINT(arc1, r1, rgba);
+  ADD_VERTEX_POINT(arc1, r2, rgba);
+  ADD_VERTEX_POINT(arc2, r1, rgba);
 
   // Second triangle
 
-  ADD_VERTEX_POINT(arc2, r1, red, green, blue, alpha);
-  ADD_VERTEX_POINT(arc1, r2, red, green, blue, alpha);
-  ADD_VERTEX_POINT(arc2, r2, red, green, blue, alpha);
+  ADD_VERTEX_POINT(arc2, r1, rgba);
+  ADD_VERTEX_POINT(arc1, r2, rgba);
+  ADD_VERTEX_POINT(arc2, r2, rgba);
 
   line->count = count;
 }
 
 void RadarDrawVertex::ProcessRadarSpoke(int transparency, SpokeBearing angle, uint8_t* data, size_t len, GeoPosition spoke_pos) {
-  GLubyte alpha = 255 * (MAX_OVERLAY_TRANSPARENCY - transparency) / MAX_OVERLAY_TRANSPARENCY;
-  BlobColour previous_colour = BLOB_NONE;
-  GLubyte strength = 0;
   time_t now = time(0);
-  uint8_t red, green, blue;
   wxCriticalSectionLocker lock(m_exclusive);
-  int r_begin = 0;
-  int r_end = 0;
 
   if (angle < 0 || angle >= (int)m_spokes || len > m_spoke_len_max || !m_vertices) {
     return;
   }
-  VertexLine* line = &m_vertices[angle];
+  SpokeInfo* info = &m_spoke_info[angle];
+  info->timeout = now + m_ri->m_pi->m_settings.max_age;
+  info->spoke_pos = spoke_pos;
+  info->generation = m_ri->m_image_generation;
+  m_pyramid->SetSpoke(angle, data, len, info->generation);
+  m_transparency = transparency;
+
+  BuildLine(angle >> m_level);
+}
+
+/*
+ * Build the vertices of one line of the current pyramid level, which covers
+ * 2^m_level spokes. It takes its age and position from the newest of those.
+ */
+void RadarDrawVertex::BuildLine(size_t row) {
+  size_t scale = (size_t)1 << m_level;
+  int step = (int)scale;
+  VertexLine* line = &m_vertices[row];
+  SpokeInfo* info = &m_spoke_info[row * scale];
+  BlobColour previous_colour = BLOB_NONE;
+  GLubyte strength = 0;
+  uint32_t rgba = 0;
+  int r_begin = 0;
+  int r_end = 0;
+
+  for (size_t angle = row * scale + 1; angle < (row + 1) * scale && angle < m_spokes; angle++) {
+    if (m_spoke_info[angle].timeout > info->timeout) {
+      info = &m_spoke_info[angle];
+    }
+  }
 
   if (!line->points) {
     static size_t INITIAL_ALLOCATION = 600;  // Empirically found to be enough for a complicated picture
@@ -149,8 +183,17 @@ void RadarDrawVertex::ProcessRadarSpoke(int transparency, SpokeBearing angle, ui
     }
   }
   line->count = 0;
-  line->timeout = now + m_ri->m_pi->m_settings.max_age;
-  line->spoke_pos = spoke_pos;
+  line->timeout = info->timeout;
+  line->spoke_pos = info->spoke_pos;
+  line->generation = info->generation;
+  if (!m_pyramid->IsCurrent(m_level, row, info->generation)) {
+    return;
+  }
+
+  uint8_t* data = m_pyramid->GetRow(m_level, row);
+  size_t len = m_pyramid->GetSpokeLen(m_level);
+  int angle = (int)(row * scale);
+  const uint32_t* lut = GetColourLUT(m_ri, m_transparency);
   for (size_t radius = 0; radius < len; radius++) {
     strength = data[radius];
     BlobColour actual_colour = m_ri->m_colour_map[strength];
@@ -163,12 +206,11 @@ void RadarDrawVertex::ProcessRadarSpoke(int transparency, SpokeBearing angle, ui
       r_begin = radius;
       r_end = r_begin + 1;
       previous_colour = actual_colour;  // new color
+      rgba = lut[strength];
     } else if (previous_colour != BLOB_NONE && (previous_colour != actual_colour)) {
-      red = m_ri->m_colour_map_rgb[previous_colour].Red();
-      green = m_ri->m_colour_map_rgb[previous_colour].Green();
-      blue = m_ri->m_colour_map_rgb[previous_colour].Blue();
-      SetBlob(line, angle, angle + 1, r_begin, r_end, red, green, blue, alpha);
+      SetBlob(line, angle, angle + step, r_begin * step, wxMin(r_end * step, (int)m_spoke_len_max), rgba);
       previous_colour = actual_colour;
+      rgba = lut[strength];
       if (actual_colour != BLOB_NONE) {  // change of color, start new blob
         r_begin = radius;
         r_end = r_begin + 1;
@@ -176,16 +218,31 @@ void RadarDrawVertex::ProcessRadarSpoke(int transparency, SpokeBearing angle, ui
     }
   }
   if (previous_colour != BLOB_NONE) {  // Draw final blob
-    red = m_ri->m_colour_map_rgb[previous_colour].Red();
-    green = m_ri->m_colour_map_rgb[previous_colour].Green();
-    blue = m_ri->m_colour_map_rgb[previous_colour].Blue();
-    SetBlob(line, angle, angle + 1, r_begin, r_end, red, green, blue, alpha);
+    SetBlob(line, angle, angle + step, r_begin * step, wxMin(r_end * step, (int)m_spoke_len_max), rgba);
+  }
+}
+
+/*
+ * Rebuild all lines from another pyramid level when the image has been zoomed
+ * so far in or out that a different level fits the screen.
+ */
+void RadarDrawVertex::SetLevel(double pixels_per_sample) {
+  int level = m_pyramid->ChooseLevel(pixels_per_sample);
+
+  if (level != m_level) {
+    m_level = level;
+    for (size_t row = 0; row < m_pyramid->GetSpokes(m_level); row++) {
+      BuildLine(row);
+    }
   }
 }
 
 void RadarDrawVertex::DrawRadarOverlayImage(double radar_scale, double panel_rotate) {
   wxPoint boat_center;
   GeoPosition posi;
+  if (!m_pyramid) {
+    return;
+  }
   if (!m_ri->GetRadarPosition(&posi)) {
     return;  // no position, no overlay
   }
@@ -195,17 +252,19 @@ void RadarDrawVertex::DrawRadarOverlayImage(double radar_scale, double panel_rot
   glEnableClientState(GL_VERTEX_ARRAY);
   glEnableClientState(GL_COLOR_ARRAY);
   time_t now = time(0);
+  uint32_t generation = m_ri->m_image_generation;
   GeoPosition prev_pos = posi;
   {
     wxCriticalSectionLocker lock(m_exclusive);
 
+    SetLevel(radar_scale);
     glPushMatrix();
     glTranslated(boat_center.x, boat_center.y, 0);
     glRotated(panel_rotate, 0.0, 0.0, 1.0);
     glScaled(radar_scale, radar_scale, 1.);
-    for (size_t i = 0; i < m_spokes; i++) {
+    for (size_t i = 0; i < m_pyramid->GetSpokes(m_level); i++) {
       VertexLine* line = &m_vertices[i];
-      if (!line->count || TIMED_OUT(now, line->timeout)) {
+      if (!line->count || line->generation != generation || TIMED_OUT(now, line->timeout)) {
         continue;
       }
       if ((line->spoke_pos.lat != prev_pos.lat || line->spoke_pos.lon != prev_pos.lon)) {
@@ -234,18 +293,24 @@ void RadarDrawVertex::DrawRadarPanelImage(double panel_scale, double panel_rotat
   double prev_offset_lat = 0.;
   double prev_offset_lon = 0.;
   GeoPosition radar_pos, line_pos;
+  if (!m_pyramid) {
+    return;
+  }
   glEnableClientState(GL_VERTEX_ARRAY);
   glEnableClientState(GL_COLOR_ARRAY);
   {
     wxCriticalSectionLocker lock(m_exclusive);
 
     time_t now = time(0);
+    uint32_t generation = m_ri->m_image_generation;
+    // One unit of panel_scale is m_radar_radius / m_panel_zoom pixels
+    SetLevel(panel_scale * m_ri->m_radar_radius / m_ri->m_panel_zoom);
     glPushMatrix();
     glRotated(panel_rotate, 0.0, 0.0, 1.0);
     glScaled(panel_scale, panel_scale, 1.);
-    for (size_t i = 0; i < m_spokes; i++) {
+    for (size_t i = 0; i < m_pyramid->GetSpokes(m_level); i++) {
       VertexLine* line = &m_vertices[i];
-      if (!line->count || TIMED_OUT(now, line->timeout)) {
+      if (!line->count || line->generation != generation || TIMED_OUT(now, line->timeout)) {
         continue;
       }
       line_pos = line->spoke_pos;
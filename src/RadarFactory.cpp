@@ -31,6 +31,7 @@
 
 #include "RadarFactory.h"
 
+#include "RadarReplay.h"
 #include "RadarType.h"
 #include "pi_common.h"
 
@@ -52,6 +53,16 @@ ControlsDialog* RadarFactory::MakeControlsDialog(size_t radarType, int radar) {
 }
 
 RadarReceive* RadarFactory::MakeRadarReceive(size_t radarType, radar_pi* pi, RadarInfo* ri) {
+  // A radar that has a capture file configured plays that back instead of listening to the network
+  if (!pi->m_settings.replay_file[ri->m_radar].IsEmpty()) {
+    return new RadarReplay(pi, ri, pi->m_settings.replay_file[ri->m_radar], pi->m_settings.replay_speed[ri->m_radar]);
+  }
+  return MakeRadarDecoder(radarType, pi, ri);
+}
+
+// The receive object that understands the radar's data. Normally this is run as the receive
+// thread, but RadarReplay also uses it directly to decode recorded frames.
+RadarReceive* RadarFactory::MakeRadarDecoder(size_t radarType, radar_pi* pi, RadarInfo* ri) {
   switch (radarType) {
 #define DEFINE_RADAR(t, x, s, l, a, b, c, d) \
   case t:                                    \
@@ -36,10 +36,14 @@
 #include "GuardZone.h"
 #include "MessageBox.h"
 #include "RadarCanvas.h"
+#include "RadarCapture.h"
 #include "RadarDraw.h"
 #include "RadarFactory.h"
 #include "RadarPanel.h"
 #include "RadarReceive.h"
+#include "SpokeHistory.h"
+#include "SpokePipeline.h"
+#include "SpokeQueue.h"
 #include "TrailBuffer.h"
 #include "drawutil.h"
 
@@ -56,6 +60,71 @@ bool g_first_render = true;
 RadarInfo::RadarInfo(radar_pi *pi, int radar) {
   m_pi = pi;
   m_radar = radar;
+
+  RadarControlItem *controls[] = {&m_state,
+                                  &m_boot_state,
+                                  &m_orientation,
+                                  &m_view_center,
+                                  &m_range,
+                                  &m_gain,
+                                  &m_interference_rejection,
+                                  &m_target_separation,
+                                  &m_noise_rejection,
+                                  &m_target_boost,
+                                  &m_target_expansion,
+                                  &m_sea,
+                                  &m_sea_state,
+                                  &m_rain,
+                                  &m_ftc,
+                                  &m_mode,
+                                  &m_all_to_auto,
+                                  &m_scan_speed,
+                                  &m_bearing_alignment,
+                                  &m_range_adjustment,
+                                  &m_antenna_height,
+                                  &m_antenna_forward,
+                                  &m_antenna_starboard,
+                                  &m_antenna_size,
+                                  &m_parking_angle,
+                                  &m_main_bang_size,
+                                  &m_accent_light,
+                                  &m_local_interference_rejection,
+                                  &m_side_lobe_suppression,
+                                  &m_target_trails,
+                                  &m_trails_motion,
+                                  &m_target_on_ppi,
+                                  &m_next_state_change,
+                                  &m_timed_idle,
+                                  &m_timed_run,
+                                  &m_doppler,
+                                  &m_doppler_threshold,
+                                  &m_autotrack_doppler,
+                                  &m_threshold,
+                                  &m_tune_fine,
+                                  &m_tune_coarse,
+                                  &m_main_bang_suppression,
+                                  &m_warmup_time,
+                                  &m_signal_strength,
+                                  &m_display_timing,
+                                  &m_stc,
+                                  &m_magnetron_time,
+                                  &m_rotation_period,
+                                  &m_stc_curve,
+                                  &m_coarse_tune,
+                                  &m_magnetron_current,
+                                  &m_color_gain};
+  m_controls_epoch = 0;
+  for (size_t i = 0; i < ARRAY_SIZE(controls); i++) {
+    controls[i]->SetEpoch(&m_controls_epoch);
+  }
+  for (size_t i = 0; i < MAX_CHART_CANVAS; i++) {
+    m_overlay_canvas[i].SetEpoch(&m_controls_epoch);
+  }
+  for (size_t z = 0; z < NO_TRANSMIT_ZONES; z++) {
+    m_no_transmit_start[z].SetEpoch(&m_controls_epoch);
+    m_no_transmit_end[z].SetEpoch(&m_controls_epoch);
+  }
+
   m_arpa = 0;
   m_range.UpdateState(RCS_AUTO_1);
   m_timed_run.Update(1, RCS_MANUAL);
@@ -71,6 +140,9 @@ RadarInfo::RadarInfo(radar_pi *pi, int radar) {
   m_radar_timeout = 0;
   m_data_timeout = 0;
   m_history = 0;
+  m_history_bits = 0;
+  m_image_generation = 0;
+  m_colour_map_version = 0;
   m_polar_lookup = 0;
   m_spokes = 0;
   m_spoke_len_max = 0;
@@ -93,6 +165,7 @@ RadarInfo::RadarInfo(radar_pi *pi, int radar) {
 
   m_mouse_pos.lat = NAN;
   m_mouse_pos.lon = NAN;
+  m_radar_position.Store(m_mouse_pos);
   for (int i = 0; i < ORIENTATION_NUMBER; i++) {
     m_mouse_ebl[i] = NAN;
     m_mouse_vrm = NAN;
@@ -103,6 +176,9 @@ RadarInfo::RadarInfo(radar_pi *pi, int radar) {
   }
   m_control = 0;
   m_receive = 0;
+  m_capture = 0;
+  m_spoke_queue = 0;
+  m_capture_last_angle = 0;
   m_draw_panel.draw = 0;
   m_draw_overlay.draw = 0;
   m_draw_time_ms = 1000;  // Assume really bad draw time until we actually measure it to prevent fast redraw at start
@@ -145,13 +221,13 @@ RadarInfo::RadarInfo(radar_pi *pi, int radar) {
   for (size_t z = 0; z < GUARD_ZONES; z++) {
     m_guard_zone[z] = new GuardZone(m_pi, this, z);
   }
+  m_pipeline = new SpokePipeline(this);
 }
 
 void RadarInfo::Shutdown() {
   if (m_receive) {
     wxLongLong threadStartWait = wxGetUTCTimeMillis();
-    m_receive->Shutdown();
-    m_receive->Wait();
+    m_receive->Stop();
     wxLongLong threadEndWait = wxGetUTCTimeMillis();
 
     wxLog::FlushActive();  // Flush any log messages written by the thread
@@ -161,6 +237,12 @@ void RadarInfo::Shutdown() {
       m_receive = 0;
     }
   }
+  if (m_spoke_queue) {
+    m_spoke_queue->Stop();
+    delete m_spoke_queue;
+    m_spoke_queue = 0;
+  }
+  StopCapture();
   if (m_control_dialog) {
     delete m_control_dialog;
     m_control_dialog = 0;
@@ -209,17 +291,20 @@ RadarInfo::~RadarInfo() {
   }
 
   if (m_history) {
-    for (size_t i = 0; i < m_spokes; i++) {
-      if (m_history[i].line) {
-        free(m_history[i].line);
-      }
-    }
     free(m_history);
   }
+  if (m_history_bits) {
+    delete m_history_bits;
+    m_history_bits = 0;
+  }
   if (m_polar_lookup) {
     delete m_polar_lookup;
     m_polar_lookup = 0;
   }
+  if (m_pipeline) {
+    delete m_pipeline;
+    m_pipeline = 0;
+  }
 }
 
 /**
@@ -234,10 +319,15 @@ bool RadarInfo::Init() {
   m_name = RadarTypeName[m_radar_type];
   m_spokes = RadarSpokes[m_radar_type];
   m_spoke_len_max = RadarSpokeLenMax[m_radar_type];
+  if (m_radar_type == RT_EMULATOR) {  // Configurable, to emulate any radar for load testing
+    m_spokes = M_SETTINGS.emulator_spokes;
+    m_spoke_len_max = M_SETTINGS.emulator_spoke_len;
+  }
   m_history = (line_history *)calloc(sizeof(line_history), m_spokes);
-  for (size_t i = 0; i < m_spokes; i++) {
-    m_history[i].line = (uint8_t *)calloc(sizeof(uint8_t), m_spoke_len_max);
+  if (m_history_bits) {
+    delete m_history_bits;
   }
+  m_history_bits = new SpokeHistory(m_spokes, m_spoke_len_max);
   m_polar_lookup = new PolarToCartesianLookup(m_spokes, m_spoke_len_max);
   ComputeColourMap();
   if (!m_control) {
@@ -272,13 +362,26 @@ bool RadarInfo::Init() {
   m_trails = new TrailBuffer(this, m_spokes, m_spoke_len_max);
   ComputeTargetTrails();
   UpdateControlState(true);
-  if (!m_receive) {
+  if (!m_capture && !M_SETTINGS.capture_directory.IsEmpty()) {
+    wxFileName capture_file(M_SETTINGS.capture_directory, wxEmptyString);
+    capture_file.SetName(wxString::Format(wxT("radar%d-%s"), (int)m_radar, wxDateTime::Now().Format(wxT("%Y%m%d-%H%M%S")).c_str()));
+    capture_file.SetExt(RADAR_CAPTURE_EXTENSION);
+    StartCapture(capture_file.GetFullPath());
+  }
+  if (!m_spoke_queue) {
+    m_spoke_queue = new SpokeQueue(this, m_spoke_len_max);
+    if (!m_spoke_queue->Start()) {
+      delete m_spoke_queue;
+      m_spoke_queue = 0;
+    }
+  }
+  if (!m_receive && m_spoke_queue) {
     LOG_RECEIVE(wxT("%s starting receive thread"), m_name.c_str());
     m_receive = RadarFactory::MakeRadarReceive(m_radar_type, m_pi, this);
     if (!m_receive) {
       LOG_INFO(wxT("%s unable to start receive thread."), m_name.c_str());
     } else {
-      if (m_receive->Run() != wxTHREAD_NO_ERROR) {
+      if (!m_receive->Start(m_pi->m_reactor)) {
         LOG_INFO(wxT("%s unable to start receive thread."), m_name.c_str());
         if (m_receive) {
           delete m_receive;
@@ -421,32 +524,38 @@ void RadarInfo::ComputeColourMap() {
   m_colour_map_rgb[BLOB_STRONG] = DimColor(M_SETTINGS.strong_colour, brightness);
   m_colour_map_rgb[BLOB_INTERMEDIATE] = DimColor(M_SETTINGS.intermediate_colour, brightness);
   m_colour_map_rgb[BLOB_WEAK] = DimColor(M_SETTINGS.weak_colour, brightness);
+  m_colour_map_version++;  // Rebuild the RGBA tables on next use
 }
 
-void RadarInfo::ResetSpokes() {
-  uint8_t zap[SPOKE_LEN_MAX];
-  GeoPosition pos;
-  GetRadarPosition(&pos);
-  LOG_VERBOSE(wxT("reset spokes"));
+/*
+ * Fill a table that maps strength straight to the RGBA bytes the draw methods
+ * need, packed in a uint32_t in memory order. Each draw method keeps its own
+ * table and calls this again when m_colour_map_version or its transparency
+ * changes, so no lock is needed: a table built while ComputeColourMap() runs
+ * is followed by another once the version moves on.
+ */
+void RadarInfo::BuildColourLUT(int transparency, uint32_t *lut) {
+  uint8_t alpha = 255 * (MAX_OVERLAY_TRANSPARENCY - transparency) / MAX_OVERLAY_TRANSPARENCY;
 
-  CLEAR_STRUCT(zap);
-  for (size_t i = 0; i < m_spokes; i++) {
-    memset(m_history[i].line, 0, m_spoke_len_max);
-    m_history[i].time = 0;
-    m_history[i].pos.lat = 0.;
-    m_history[i].pos.lon = 0.;
+  for (int i = 0; i <= UINT8_MAX; i++) {
+    BlobColour colour = m_colour_map[i];
+    uint8_t rgba[4] = {m_colour_map_rgb[colour].Red(), m_colour_map_rgb[colour].Green(), m_colour_map_rgb[colour].Blue(),
+                       (uint8_t)(colour != BLOB_NONE ? alpha : 0)};
+    memcpy(&lut[i], rgba, sizeof(rgba));
   }
+}
 
-  if (m_draw_panel.draw) {
-    for (size_t r = 0; r < m_spokes; r++) {
-      m_draw_panel.draw->ProcessRadarSpoke(0, r, zap, m_spoke_len_max, pos);
-    }
-  }
-  if (m_draw_overlay.draw) {
-    for (size_t r = 0; r < m_spokes; r++) {
-      m_draw_overlay.draw->ProcessRadarSpoke(0, r, zap, m_spoke_len_max, pos);
-    }
-  }
+/*
+ * Forget the image of the previous range or orientation. This does not touch
+ * any spoke: the ARPA history and both draw methods compare the generation a
+ * spoke was written in with the current one, and treat older spokes as empty
+ * until the radar overwrites them; GetHistoryTime() returns 0 for those.
+ */
+void RadarInfo::ResetSpokes() {
+  LOG_VERBOSE(wxT("reset spokes"));
+
+  m_history_bits->Clear();
+  m_image_generation++;
 
   for (size_t z = 0; z < GUARD_ZONES; z++) {
     // Zap them anyway just to be sure
@@ -454,6 +563,13 @@ void RadarInfo::ResetSpokes() {
   }
 }
 
+wxLongLong RadarInfo::GetHistoryTime(SpokeBearing angle) {
+  if (!m_history_bits->IsCurrent(angle)) {
+    return 0;  // Not received since the last ResetSpokes()
+  }
+  return m_history[angle].time;
+}
+
 void RadarInfo::CalculateRotationSpeed(SpokeBearing angle) {
   if (m_radar_type == RM_E120) {
     // Nothing, we learn the rotation speed directly from the radar.
@@ -465,6 +581,7 @@ void RadarInfo::CalculateRotationSpeed(SpokeBearing angle) {
       int deltaInt = (int)delta.GetValue();
 
       m_rotation_period.Update(deltaInt);
+      m_telemetry.AddRotation(deltaInt);
     }
     m_last_rotation_time = now;
   }
@@ -472,120 +589,153 @@ void RadarInfo::CalculateRotationSpeed(SpokeBearing angle) {
 }
 
 /*
- * A spoke of data has been received by the receive thread and it calls this (in
- * the context of the receive thread, so no UI actions can be performed here.)
- *
- * @param angle                 Bearing (relative to Boat)  at which the spoke is seen.
- * @param bearing               Bearing (relative to North) at which the spoke is seen.
- * @param data                  A line of len bytes, each byte represents strength at that distance.
- * @param len                   Number of returns
- * @param range                 Range (in meters) of this data
- * @param time_rec              Time at this moment
+ * Start recording all raw frames received for this radar.
  */
-void RadarInfo::ProcessRadarSpoke(SpokeBearing angle, SpokeBearing bearing, uint8_t *data, size_t len, int range_meters,
-                                  wxLongLong time_rec) {
-  int orientation;
-  int i;
+bool RadarInfo::StartCapture(const wxString &filename) {
+  StopCapture();
 
-  SampleCourse(angle);            // Calculate course as the moving average of m_hdt over one revolution
-  CalculateRotationSpeed(angle);  // Find out how fast the radar is rotating
-
-  // Recompute 'pixels_per_meter' based on the actual spoke length and range in meters.
-  if (range_meters == 0) {
-    LOG_INFO(wxT("Error ProcessRadarSpoke range is zero"));
-    return;
+  RadarCapture *capture = new RadarCapture(this);
+  if (!capture->Open(filename)) {
+    delete capture;
+    return false;
   }
+  wxCriticalSectionLocker lock(m_receive_exclusive);
+  m_capture = capture;
+  return true;
+}
 
-  for (i = 0; i < m_main_bang_size.GetValue(); i++) {
-    data[i] = 0;
+void RadarInfo::StopCapture() {
+  RadarCapture *capture;
+  {
+    wxCriticalSectionLocker lock(m_receive_exclusive);
+    capture = m_capture;
+    m_capture = 0;
   }
-  int threshold = m_threshold.GetValue();
-  if (threshold > 0) {
-    threshold = threshold * (255 - BLOB_HISTORY_MAX) / 100 + BLOB_HISTORY_MAX;
-    for (; i < (int)len; i++) {
-      if (data[i] < threshold) {
-        data[i] = 0;
-      }
-    }
+  if (capture) {
+    capture->Close();
+    delete capture;
   }
+}
 
-  double pixels_per_meter = (len / (double)range_meters) * (1. - (double)m_range_adjustment.GetValue() * 0.001);
+/*
+ * Called by the receive thread with every raw frame, before it is decoded.
+ * 'source' is the address the datagram was sent from.
+ */
+void RadarInfo::CaptureFrame(const uint8_t *data, size_t len, wxLongLong time, const NetworkAddress &source) {
+  wxCriticalSectionLocker lock(m_receive_exclusive);
 
-  if (m_pixels_per_meter != pixels_per_meter) {
-    LOG_RECEIVE(wxT(" %s detected spoke range change from %g to %g pixels/m, %d meters"), m_name.c_str(), m_pixels_per_meter,
-                pixels_per_meter, range_meters);
-    m_pixels_per_meter = pixels_per_meter;
-    ResetSpokes();
-    if (m_arpa) {
-      m_arpa->ClearContours();
-    }
+  if (m_capture) {
+    m_capture->AddFrame(data, len, time, source);
   }
+}
 
-  orientation = GetOrientation();
-  if ((orientation == ORIENTATION_HEAD_UP || m_previous_orientation == ORIENTATION_HEAD_UP) &&
-      (orientation != m_previous_orientation)) {
-    ResetSpokes();
-    m_previous_orientation = orientation;
-  }
+wxString RadarInfo::GetCaptureStatus() {
+  wxCriticalSectionLocker lock(m_receive_exclusive);
 
-  // In NORTH or COURSE UP modes we store the radar data at the bearing received
-  // in the spoke. In other words: at an absolute angle off north.
-  // This way, when the boat rotates the data on the overlay doesn't rotate with it.
-  // This is also called 'stabilized' mode, I guess.
-  //
-  // The history data used for the ARPA data is *always* in bearing mode, it is not usable
-  // with relative data.
-  //
-  int stabilized_mode = orientation != ORIENTATION_HEAD_UP;
-  uint8_t weakest_normal_blob = m_pi->m_settings.threshold_red;
+  if (m_capture) {
+    return m_capture->GetStatusText();
+  }
+  return wxEmptyString;
+}
 
-  uint8_t *hist_data = m_history[bearing].line;
-  m_history[bearing].time = time_rec;
-  memset(hist_data, 0, m_spoke_len_max);
-  GetRadarPosition(&m_history[bearing].pos);
-  for (size_t radius = 0; radius < len; radius++) {
-    if (data[radius] >= weakest_normal_blob) {
-      // and add 1 if above threshold and set the left 2 bits, used for ARPA
-      hist_data[radius] = 192;  // this is C0, 1100 0000
-    }
-    if (data[radius] == 255) {  // approaching doppler target
-      // and add 1 if above threshold and set the left 2 bits, used for ARPA
-      hist_data[radius] = 0xE0;  // this is  1110 0000, bit 3 indicates this is an approaching target
-      m_doppler_count++;
-    }
+/*
+ * Called by the receive thread before it decodes a spoke of len bytes. Returns
+ * the queue slot to decode into, or 0 if the caller should use its own buffer.
+ * Either way the result is passed to QueueRadarSpoke.
+ */
+uint8_t *RadarInfo::ReserveRadarSpoke(size_t len) {
+  if (m_spoke_queue) {
+    return m_spoke_queue->Reserve(len);
   }
+  return 0;
+}
 
-  for (size_t z = 0; z < GUARD_ZONES; z++) {
-    if (m_guard_zone[z]->m_alarm_on) {
-      m_guard_zone[z]->ProcessSpoke(angle, data, m_history[bearing].line, len);
+/*
+ * Called by the receive thread for every decoded spoke. The spoke is handed to the
+ * spoke processing thread, so the receive thread never waits for m_exclusive.
+ *
+ * When the angle wraps the rotation is marked in the capture file here, on the
+ * thread that added the frame this spoke was decoded from.
+ */
+void RadarInfo::QueueRadarSpoke(SpokeBearing angle, SpokeBearing bearing, uint8_t *data, size_t len, int range_meters,
+                                wxLongLong time_rec) {
+  if (angle < m_capture_last_angle) {
+    wxCriticalSectionLocker lock(m_receive_exclusive);
+
+    if (m_capture) {
+      m_capture->MarkRotation();
     }
   }
+  m_capture_last_angle = angle;
 
-  size_t trail_len = len;
-  if (m_pi->m_settings.show_extreme_range) {
-    data[len - 1] = 255;
-    trail_len--;
+  if (m_spoke_queue) {
+    m_spoke_queue->Push(angle, bearing, data, len, range_meters, time_rec);
   }
+}
 
-  bool draw_trails_on_overlay = M_SETTINGS.trails_on_overlay;
-  if (m_draw_overlay.draw && !draw_trails_on_overlay) {
-    m_draw_overlay.draw->ProcessRadarSpoke(M_SETTINGS.overlay_transparency.GetValue(), bearing, data, len, m_history[bearing].pos);
-  }
-  m_trails->UpdateTrailPosition();
+/*
+ * Copy the spoke queue counters into m_statistics.
+ */
+void RadarInfo::UpdateQueueStatistics() {
+  wxCriticalSectionLocker lock(m_receive_exclusive);
 
-  // True trails
-  m_trails->UpdateTrueTrails(bearing, data, trail_len);
+  if (m_spoke_queue) {
+    m_spoke_queue->GetStatistics(&m_statistics.queue_depth, &m_statistics.queue_high_water, &m_statistics.queue_overflows);
+  }
+}
 
-  // Relative trails
-  m_trails->UpdateRelativeTrails(angle, data, trail_len);
+/*
+ * Called by the replay thread, which would rather wait for the spoke
+ * processing thread than drop spokes.
+ */
+void RadarInfo::SetSpokeQueueBlocking(bool blocking) {
+  if (m_spoke_queue) {
+    m_spoke_queue->SetBlocking(blocking);
+  }
+}
 
-  if (m_draw_overlay.draw && draw_trails_on_overlay) {
-    m_draw_overlay.draw->ProcessRadarSpoke(M_SETTINGS.overlay_transparency.GetValue(), bearing, data, len, m_history[bearing].pos);
+/*
+ * Called by the replay thread; returns when every spoke that it queued has been processed.
+ */
+void RadarInfo::DrainSpokeQueue() {
+  if (m_spoke_queue) {
+    m_spoke_queue->Drain();
   }
+}
 
-  if (m_draw_panel.draw) {
-    m_draw_panel.draw->ProcessRadarSpoke(4, stabilized_mode ? bearing : angle, data, len, m_history[bearing].pos);
+uint64_t RadarInfo::GetSpokesProcessed() {
+  if (m_spoke_queue) {
+    return m_spoke_queue->GetProcessed();
   }
+  return 0;
+}
+
+/*
+ * A spoke of data has been received by the receive thread and queued. This is
+ * called by the spoke processing thread with m_exclusive and m_draw_lock
+ * held, so no UI actions can be performed here. The work is done by the
+ * stages of m_pipeline.
+ *
+ * @param angle                 Bearing (relative to Boat)  at which the spoke is seen.
+ * @param bearing               Bearing (relative to North) at which the spoke is seen.
+ * @param data                  A line of len bytes, each byte represents strength at that distance.
+ * @param len                   Number of returns
+ * @param range                 Range (in meters) of this data
+ * @param time_rec              Time at this moment
+ */
+void RadarInfo::ProcessRadarSpoke(SpokeBearing angle, SpokeBearing bearing, uint8_t *data, size_t len, int range_meters,
+                                  wxLongLong time_rec) {
+  SpokeContext spoke;
+
+  spoke.angle = angle;
+  spoke.bearing = bearing;
+  spoke.data = data;
+  spoke.len = len;
+  spoke.trail_len = len;
+  spoke.range_meters = range_meters;
+  spoke.time = time_rec;
+  spoke.stabilized_mode = false;
+  m_pipeline->Process(&spoke);
 }
 
 void RadarInfo::SampleCourse(int angle) {
@@ -620,8 +770,11 @@ void RadarInfo::SampleCourse(int angle) {
   }
 }
 
+/*
+ * Called by the timer on the GUI thread. Needs no lock: the state is a
+ * RadarControlItem and the timeouts are atomic.
+ */
 void RadarInfo::UpdateTransmitState() {
-  wxCriticalSectionLocker lock(m_exclusive);
   time_t now = time(0);
 
   int state = m_state.GetValue();
@@ -883,21 +1036,23 @@ bool RadarInfo::IsPaneShown() {
 }
 
 void RadarInfo::UpdateControlState(bool all) {
-  wxCriticalSectionLocker lock(m_exclusive);
-
 #ifdef OPENCPN_NO_LONGER_MIXES_GL_CONTEXT
   //
   // Once OpenCPN doesn't mess up with OpenGL context anymore we can do this
   //
-  if (m_overlay_canvas0.value == 0 && m_overlay_canvas1.value == 0 && m_draw_overlay.draw) {
-    LOG_DIALOG(wxT("Removing draw method as radar overlay is not shown"));
-    delete m_draw_overlay.draw;
-    m_draw_overlay.draw = 0;
-  }
-  if (!IsShown() && m_draw_panel.draw) {
-    LOG_DIALOG(wxT("Removing draw method as radar window is not shown"));
-    delete m_draw_panel.draw;
-    m_draw_panel.draw = 0;
+  {
+    wxCriticalSectionLocker lock(m_draw_lock);
+
+    if (m_overlay_canvas0.value == 0 && m_overlay_canvas1.value == 0 && m_draw_overlay.draw) {
+      LOG_DIALOG(wxT("Removing draw method as radar overlay is not shown"));
+      delete m_draw_overlay.draw;
+      m_draw_overlay.draw = 0;
+    }
+    if (!IsShown() && m_draw_panel.draw) {
+      LOG_DIALOG(wxT("Removing draw method as radar window is not shown"));
+      delete m_draw_panel.draw;
+      m_draw_panel.draw = 0;
+    }
   }
 #endif
 
@@ -926,8 +1081,14 @@ void RadarInfo::RefreshDisplay() {
   }
 }
 
+/*
+ * Called on the GUI thread, which is the only thread that replaces the draw
+ * methods, so it can use di->draw without a lock. Replacing one takes
+ * m_draw_lock, to wait for a spoke that the spoke processing thread
+ * is adding to the old one. Drawing takes neither that nor m_exclusive; the
+ * draw methods lock their own buffers.
+ */
 void RadarInfo::RenderRadarImage2(DrawInfo *di, double radar_scale, double panel_rotate) {
-  wxCriticalSectionLocker lock(m_exclusive);
   int drawing_method = m_pi->m_settings.drawing_method;
   int state = m_state.GetValue();
 
@@ -949,6 +1110,8 @@ void RadarInfo::RenderRadarImage2(DrawInfo *di, double radar_scale, double panel
       } else {
         LOG_VERBOSE(wxT("%s new drawing method %s for panel"), m_name.c_str(), methods[drawing_method].c_str());
       }
+      wxCriticalSectionLocker lock(m_draw_lock);
+
       if (di->draw) {
         delete di->draw;
       }
@@ -1474,10 +1637,10 @@ void RadarInfo::ComputeTargetTrails() {
   // Disperse the BLOB_HISTORY values over 0..maxrev
   for (revolution = 0; revolution <= TRAIL_MAX_REVOLUTIONS; revolution++) {
     if (revolution >= 1 && revolution < maxRev) {
-      m_trail_colour[revolution] = (BlobColour)(BLOB_HISTORY_0 + (int)colour);
+      m_trail_colour[revolution] = (uint8_t)(BLOB_HISTORY_0 + (int)colour);
       colour += coloursPerRevolution;
     } else {
-      m_trail_colour[revolution] = BLOB_NONE;
+      m_trail_colour[revolution] = (uint8_t)BLOB_NONE;
     }
     // LOG_VERBOSE(wxT("ComputeTargetTrails rev=%u color=%d"), revolution, m_trail_colour[revolution]);
   }
@@ -1672,10 +1835,10 @@ void RadarInfo::CheckTimedTransmit() {
 }
 
 bool RadarInfo::GetRadarPosition(GeoPosition *pos) {
-  wxCriticalSectionLocker lock(m_exclusive);
+  GeoPosition radar_pos = m_radar_position.Load();
 
-  if (m_pi->IsBoatPositionValid() && VALID_GEO(m_radar_position.lat) && VALID_GEO(m_radar_position.lon)) {
-    *pos = m_radar_position;
+  if (m_pi->IsBoatPositionValid() && VALID_GEO(radar_pos.lat) && VALID_GEO(radar_pos.lon)) {
+    *pos = radar_pos;
     return true;
   }
   pos->lat = nan("");
@@ -1684,10 +1847,10 @@ bool RadarInfo::GetRadarPosition(GeoPosition *pos) {
 }
 
 bool RadarInfo::GetRadarPosition(ExtendedPosition *radar_pos) {
-  wxCriticalSectionLocker lock(m_exclusive);
+  GeoPosition pos = m_radar_position.Load();
 
-  if (m_pi->IsBoatPositionValid() && VALID_GEO(m_radar_position.lat) && VALID_GEO(m_radar_position.lon)) {
-    radar_pos->pos = m_radar_position;
+  if (m_pi->IsBoatPositionValid() && VALID_GEO(pos.lat) && VALID_GEO(pos.lon)) {
+    radar_pos->pos = pos;
     return true;
   }
   radar_pos->pos.lat = nan("");
@@ -1696,34 +1859,34 @@ bool RadarInfo::GetRadarPosition(ExtendedPosition *radar_pos) {
 }
 
 bool RadarInfo::HaveRadarSerialNo(size_t r) {
-  wxCriticalSectionLocker lock(m_exclusive);
+  wxCriticalSectionLocker lock(m_address_exclusive);
   return !m_radar_location_info.serialNr.IsNull();
 }
 
 RadarLocationInfo RadarInfo::GetRadarLocationInfo() {
-  wxCriticalSectionLocker lock(m_exclusive);
+  wxCriticalSectionLocker lock(m_address_exclusive);
   return m_radar_location_info;
 }
 
 void RadarInfo::SetRadarLocationInfo(const RadarLocationInfo &info) {
-  wxCriticalSectionLocker lock(m_exclusive);
+  wxCriticalSectionLocker lock(m_address_exclusive);
   m_radar_location_info = info;
   LOG_VERBOSE(wxT("Set radar location info to %s"), info.to_string());
 }
 
 void RadarInfo::SetRadarInterfaceAddress(NetworkAddress &ifaddr, NetworkAddress &addr) {
-  wxCriticalSectionLocker lock(m_exclusive);
+  wxCriticalSectionLocker lock(m_address_exclusive);
   m_radar_interface_address = ifaddr;
   m_radar_address = addr;
 };
 
 NetworkAddress RadarInfo::GetRadarAddress() {
-  wxCriticalSectionLocker lock(m_exclusive);
+  wxCriticalSectionLocker lock(m_address_exclusive);
   return m_radar_address;
 }
 
 NetworkAddress RadarInfo::GetRadarInterfaceAddress() {
-  wxCriticalSectionLocker lock(m_exclusive);
+  wxCriticalSectionLocker lock(m_address_exclusive);
   return m_radar_interface_address;
 }
 
@@ -0,0 +1,264 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "RadarReplay.h"
+
+#include "RadarFactory.h"
+#include "RadarInfo.h"
+
+#ifndef __WXMSW__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+PLUGIN_BEGIN_NAMESPACE
+
+RadarReplay::~RadarReplay() {
+  if (m_decoder) {
+    delete m_decoder;
+    m_decoder = 0;
+  }
+  UnmapFile();
+  if (m_send_socket != INVALID_SOCKET) {
+    closesocket(m_send_socket);
+  }
+  if (m_receive_socket != INVALID_SOCKET) {
+    closesocket(m_receive_socket);
+  }
+}
+
+/*
+ * Read and verify the header of a capture file, so the caller can find out
+ * which radar type it was recorded with.
+ */
+bool RadarReplay::ReadFileHeader(const wxString &filename, RadarCaptureFileHeader *header) {
+  FILE *f = fopen(filename.mb_str(), "rb");
+  if (!f) {
+    return false;
+  }
+  bool ok = fread(header, sizeof(*header), 1, f) == 1 &&
+            memcmp(header->magic, RADAR_CAPTURE_MAGIC, sizeof(header->magic)) == 0 &&
+            header->version == RADAR_CAPTURE_VERSION && header->radar_type < RT_MAX;
+  fclose(f);
+  return ok;
+}
+
+/*
+ * Make the whole capture file available at m_map. Where possible the file
+ * is memory mapped so that frames are passed to the decoder without copying.
+ */
+bool RadarReplay::MapFile() {
+#ifndef __WXMSW__
+  int fd = open(m_filename.mb_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(RadarCaptureFileHeader)) {
+    close(fd);
+    return false;
+  }
+  void *map = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+  m_map = (uint8_t *)map;
+  m_map_len = (size_t)st.st_size;
+#else
+  FILE *f = fopen(m_filename.mb_str(), "rb");
+  if (!f) {
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  long len = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  if (len < (long)sizeof(RadarCaptureFileHeader)) {
+    fclose(f);
+    return false;
+  }
+  m_map = (uint8_t *)malloc(len);
+  if (!m_map || fread(m_map, 1, len, f) != (size_t)len) {
+    fclose(f);
+    UnmapFile();
+    return false;
+  }
+  fclose(f);
+  m_map_len = (size_t)len;
+#endif
+  return true;
+}
+
+void RadarReplay::UnmapFile() {
+  if (m_map) {
+#ifndef __WXMSW__
+    munmap(m_map, m_map_len);
+#else
+    free(m_map);
+#endif
+    m_map = 0;
+    m_map_len = 0;
+  }
+}
+
+/*
+ * Sleep for the given time, or until Shutdown() is called.
+ *
+ * Returns true when we should stop.
+ */
+bool RadarReplay::WaitMillis(int64_t millis) {
+  if (millis > 0 && socketReady(m_receive_socket, (int)millis)) {
+    m_shutdown = true;
+  }
+  return m_shutdown;
+}
+
+/*
+ * Play all frames in the file once, paced according to m_speed.
+ */
+void RadarReplay::ReplayFile() {
+  RadarCaptureFileHeader *header = (RadarCaptureFileHeader *)m_map;
+  size_t end = m_map_len;
+  size_t rotations = 0;
+
+  // If the file was closed properly it has an index, and the frames end where the index starts
+  if (m_map_len >= sizeof(RadarCaptureFileHeader) + sizeof(RadarCaptureTrailer)) {
+    RadarCaptureTrailer *trailer = (RadarCaptureTrailer *)(m_map + m_map_len - sizeof(RadarCaptureTrailer));
+    if (memcmp(trailer->magic, RADAR_CAPTURE_INDEX_MAGIC, sizeof(trailer->magic)) == 0 &&
+        trailer->index_offset + trailer->index_count * sizeof(RadarCaptureIndexEntry) + sizeof(RadarCaptureTrailer) == m_map_len) {
+      end = trailer->index_offset;
+      rotations = trailer->index_count;
+    }
+  }
+
+  size_t offset = sizeof(RadarCaptureFileHeader);
+  size_t frames = 0;
+  int64_t first_time = 0;
+
+  // A file can be read faster than the spokes are processed; wait instead of dropping them
+  m_ri->SetSpokeQueueBlocking(true);
+  uint64_t spokes = m_ri->GetSpokesProcessed();
+  wxLongLong start = wxGetUTCTimeMillis();
+
+  SetInfoStatus(wxString::Format(wxT("%s: %s %s"), m_ri->m_name.c_str(), _("Replaying"), m_filename.c_str()));
+
+  while (offset + sizeof(RadarCaptureRecord) <= end && !m_shutdown) {
+    RadarCaptureRecord *record = (RadarCaptureRecord *)(m_map + offset);
+    offset += sizeof(RadarCaptureRecord);
+    if (record->len > end - offset) {
+      LOG_INFO(wxT("%s replay %s truncated at offset %u"), m_ri->m_name.c_str(), m_filename.c_str(), (unsigned int)offset);
+      break;
+    }
+
+    if (frames == 0) {
+      first_time = record->time;
+    }
+    if (m_speed > 0.) {
+      int64_t due = (int64_t)((record->time - first_time) / m_speed);
+      if (WaitMillis(due - (wxGetUTCTimeMillis() - start).GetValue())) {
+        break;
+      }
+    }
+
+    NetworkAddress source;
+    source.addr.s_addr = record->source_addr;
+    source.port = record->source_port;
+    m_decoder->ReplayFrame(m_map + offset, record->len, record->time, source);
+    offset += record->len;
+    frames++;
+  }
+
+  m_ri->DrainSpokeQueue();
+  spokes = m_ri->GetSpokesProcessed() - spokes;
+  m_ri->SetSpokeQueueBlocking(false);
+
+  wxLongLong elapsed = wxGetUTCTimeMillis() - start;
+  double seconds = elapsed.GetValue() > 0 ? elapsed.GetValue() / 1000. : 0.001;
+  LOG_INFO(wxT("%s replay %s type %s: %u frames, %u rotations, %llu spokes processed in %lld ms = %.0f frames/s, %.0f spokes/s"),
+           m_ri->m_name.c_str(), m_filename.c_str(), RadarTypeName[header->radar_type], (unsigned int)frames,
+           (unsigned int)rotations, (unsigned long long)spokes, elapsed.GetValue(), frames / seconds, spokes / seconds);
+  SetInfoStatus(wxString::Format(wxT("%s: %s %s, %.0f frames/s"), m_ri->m_name.c_str(), _("Replayed"), m_filename.c_str(),
+                                 frames / seconds));
+}
+
+/*
+ * Entry
+ *
+ * Called by wxThread when the new thread is running.
+ * It should remain running until Shutdown is called.
+ */
+void *RadarReplay::Entry(void) {
+  LOG_VERBOSE(wxT("%s replay thread starting"), m_ri->m_name.c_str());
+
+  if (!MapFile()) {
+    wxLogError(wxT("%s cannot open capture file %s"), m_ri->m_name.c_str(), m_filename.c_str());
+    SetInfoStatus(wxString::Format(wxT("%s: %s %s"), m_ri->m_name.c_str(), _("Cannot open"), m_filename.c_str()));
+  } else {
+    RadarCaptureFileHeader *header = (RadarCaptureFileHeader *)m_map;
+
+    if (memcmp(header->magic, RADAR_CAPTURE_MAGIC, sizeof(header->magic)) != 0 || header->version != RADAR_CAPTURE_VERSION) {
+      wxLogError(wxT("%s %s is not a radar capture file"), m_ri->m_name.c_str(), m_filename.c_str());
+    } else if (header->radar_type != (uint32_t)m_ri->m_radar_type) {
+      wxLogError(wxT("%s capture file %s was recorded from a different radar type"), m_ri->m_name.c_str(), m_filename.c_str());
+    } else {
+      m_decoder = RadarFactory::MakeRadarDecoder(m_ri->m_radar_type, m_pi, m_ri);
+      if (m_decoder) {
+        ReplayFile();
+      }
+    }
+  }
+
+  // Stay alive until we are told to stop, like a radar that went quiet
+  while (!WaitMillis(1000)) {
+  }
+
+  LOG_VERBOSE(wxT("%s replay thread stopping"), m_ri->m_name.c_str());
+  return 0;
+}
+
+void RadarReplay::Shutdown(void) {
+  m_shutdown = true;
+  if (m_send_socket != INVALID_SOCKET) {
+    if (send(m_send_socket, "!", 1, MSG_DONTROUTE) > 0) {
+      LOG_VERBOSE(wxT("%s requested replay thread to stop"), m_ri->m_name.c_str());
+    }
+  }
+}
+
+wxString RadarReplay::GetInfoStatus() {
+  wxCriticalSectionLocker lock(m_lock);
+
+  return m_status;
+}
+
+PLUGIN_END_NAMESPACE
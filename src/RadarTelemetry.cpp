@@ -0,0 +1,278 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "RadarTelemetry.h"
+
+#include <math.h>
+
+#include <chrono>
+
+PLUGIN_BEGIN_NAMESPACE
+
+RadarTelemetry::RadarTelemetry() {
+  CLEAR_STRUCT(m_total);
+  CLEAR_STRUCT(m_current);
+  CLEAR_STRUCT(m_last);
+  CLEAR_STRUCT(m_rotation);
+  m_window_start = Now();
+  m_last_window_length = 0;
+  m_last_frame = 0;
+  m_last_socket_drops = 0;
+  m_rotations = 0;
+}
+
+int64_t RadarTelemetry::Now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * Start a new window when the current one is complete. Called with m_exclusive held.
+ */
+void RadarTelemetry::Roll(int64_t now) {
+  if (now - m_window_start >= TELEMETRY_WINDOW_MICROS) {
+    m_last = m_current;
+    m_last_window_length = now - m_window_start;
+    CLEAR_STRUCT(m_current);
+    m_window_start = now;
+  }
+}
+
+/*
+ * Called by the receive thread after decoding a frame of `len` bytes, with the time at which
+ * decoding started. `socket_drops` is the drop counter of the socket that the frame came from,
+ * or 0 when the socket does not report one.
+ */
+void RadarTelemetry::AddFrame(size_t len, int64_t start_time, uint32_t socket_drops) {
+  int64_t now = Now();
+  int64_t decode = now - start_time;
+  int bucket = 0;
+
+  while (bucket < TELEMETRY_DECODE_BUCKETS - 1 && decode >= ((int64_t)1 << bucket)) {
+    bucket++;
+  }
+
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  Roll(now);
+  m_total.packets++;
+  m_current.packets++;
+  m_total.bytes += len;
+  m_current.bytes += len;
+  m_total.decode[bucket]++;
+  m_current.decode[bucket]++;
+  if (decode > m_current.decode_max) {
+    m_current.decode_max = decode;
+  }
+
+  if (m_last_frame != 0) {
+    int64_t gap = start_time - m_last_frame;
+
+    m_current.gaps++;
+    m_current.gap_total += gap;
+    if (gap > m_current.gap_max) {
+      m_current.gap_max = gap;
+    }
+  }
+  m_last_frame = start_time;
+
+  if (socket_drops < m_last_socket_drops) {
+    m_last_socket_drops = 0;  // A new socket, which counts from zero again
+  }
+  m_total.socket_drops += socket_drops - m_last_socket_drops;
+  m_current.socket_drops += socket_drops - m_last_socket_drops;
+  m_last_socket_drops = socket_drops;
+}
+
+/*
+ * Called by the spoke processing thread once it holds RadarInfo::m_exclusive, with the time at
+ * which it started waiting for it.
+ */
+void RadarTelemetry::AddLockWait(int64_t start_time) {
+  int64_t now = Now();
+  int64_t wait = now - start_time;
+
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  Roll(now);
+  m_total.lock_waits++;
+  m_current.lock_waits++;
+  m_total.lock_wait_total += wait;
+  m_current.lock_wait_total += wait;
+  if (wait > m_current.lock_wait_max) {
+    m_current.lock_wait_max = wait;
+  }
+}
+
+/*
+ * Called just before RadarInfo::m_exclusive is released, with the time at which it was taken.
+ */
+void RadarTelemetry::AddLockHold(int64_t start_time) {
+  int64_t now = Now();
+  int64_t hold = now - start_time;
+
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  Roll(now);
+  m_total.lock_holds++;
+  m_current.lock_holds++;
+  m_total.lock_hold_total += hold;
+  m_current.lock_hold_total += hold;
+  if (hold > m_current.lock_hold_max) {
+    m_current.lock_hold_max = hold;
+  }
+}
+
+void RadarTelemetry::AddRotation(int period_millis) {
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  m_rotation[m_rotations % TELEMETRY_ROTATIONS] = period_millis;
+  m_rotations++;
+}
+
+// Upper bound of the decode time bucket that contains the given fraction of the frames
+static int DecodePercentile(const RadarTelemetryWindow &window, double fraction) {
+  int64_t wanted = (int64_t)ceil(window.packets * fraction);
+  int64_t seen = 0;
+
+  for (int i = 0; i < TELEMETRY_DECODE_BUCKETS - 1; i++) {
+    seen += window.decode[i];
+    if (seen >= wanted) {
+      return (int)wxMin((int64_t)1 << i, window.decode_max);
+    }
+  }
+  return (int)window.decode_max;
+}
+
+void RadarTelemetry::GetSnapshot(RadarTelemetrySnapshot *snapshot) {
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  Roll(Now());
+  CLEAR_STRUCT(*snapshot);
+
+  snapshot->packets = m_total.packets;
+  snapshot->bytes = m_total.bytes;
+  for (int i = 0; i < TELEMETRY_DECODE_BUCKETS; i++) {
+    snapshot->decode[i] = m_total.decode[i];
+  }
+  snapshot->lock_waits = m_total.lock_waits;
+  snapshot->lock_wait_total = m_total.lock_wait_total;
+  snapshot->lock_holds = m_total.lock_holds;
+  snapshot->lock_hold_total = m_total.lock_hold_total;
+  snapshot->socket_drops = m_total.socket_drops;
+
+  if (m_last_window_length > 0) {
+    double seconds = m_last_window_length / 1e6;
+
+    snapshot->packets_per_second = m_last.packets / seconds;
+    snapshot->bytes_per_second = m_last.bytes / seconds;
+    snapshot->socket_drops_per_second = (int)(m_last.socket_drops / seconds);
+  }
+  if (m_last.packets > 0) {
+    snapshot->decode_p50 = DecodePercentile(m_last, 0.50);
+    snapshot->decode_p99 = DecodePercentile(m_last, 0.99);
+    snapshot->decode_max = (int)m_last.decode_max;
+  }
+  if (m_last.gaps > 0) {
+    snapshot->gap_mean = (double)m_last.gap_total / m_last.gaps;
+    snapshot->gap_max = (int)m_last.gap_max;
+  }
+  if (m_last.lock_waits > 0) {
+    snapshot->lock_wait_mean = (double)m_last.lock_wait_total / m_last.lock_waits;
+    snapshot->lock_wait_max = (int)m_last.lock_wait_max;
+  }
+  if (m_last.lock_holds > 0) {
+    snapshot->lock_hold_mean = (double)m_last.lock_hold_total / m_last.lock_holds;
+    snapshot->lock_hold_max = (int)m_last.lock_hold_max;
+  }
+
+  int n = wxMin(m_rotations, TELEMETRY_ROTATIONS);
+  if (n > 0) {
+    double sum = 0.;
+    double sum_squares = 0.;
+
+    for (int i = 0; i < n; i++) {
+      sum += m_rotation[i];
+      sum_squares += (double)m_rotation[i] * m_rotation[i];
+    }
+    snapshot->rotations = n;
+    snapshot->rotation_period = sum / n;
+    snapshot->rotation_jitter = sqrt(wxMax(0., sum_squares / n - snapshot->rotation_period * snapshot->rotation_period));
+  }
+}
+
+/*
+ * Escape a string for use inside a JSON string literal.
+ */
+wxString RadarTelemetry::JSONEscape(const wxString &str) {
+  wxString escaped;
+
+  for (wxString::const_iterator it = str.begin(); it != str.end(); ++it) {
+    wxUniChar c = *it;
+    if (c == '"' || c == '\\') {
+      escaped << wxT('\\') << c;
+    } else if (c.GetValue() < 0x20) {
+      escaped << wxString::Format(wxT("\\u%04x"), (unsigned int)c.GetValue());
+    } else {
+      escaped << c;
+    }
+  }
+  return escaped;
+}
+
+/*
+ * One line of JSON, for the periodic telemetry dump.
+ */
+wxString RadarTelemetry::FormatJSON(const wxString &name, wxLongLong time, const RadarTelemetrySnapshot &s) {
+  wxString histogram;
+
+  for (int i = 0; i < TELEMETRY_DECODE_BUCKETS; i++) {
+    histogram << (i ? wxT(",") : wxT("")) << wxString::Format(wxT("%lld"), (long long)s.decode[i]);
+  }
+
+  wxString json;
+  json << wxString::Format(wxT("{\"time\":%lld,\"radar\":\"%s\""), (long long)time.GetValue(), JSONEscape(name).c_str());
+  json << wxString::Format(wxT(",\"packets\":%lld,\"bytes\":%lld,\"packets_per_second\":%.1f,\"bytes_per_second\":%.0f"),
+                           (long long)s.packets, (long long)s.bytes, s.packets_per_second, s.bytes_per_second);
+  json << wxString::Format(wxT(",\"decode_us\":{\"p50\":%d,\"p99\":%d,\"max\":%d,\"histogram\":[%s]}"), s.decode_p50,
+                           s.decode_p99, s.decode_max, histogram.c_str());
+  json << wxString::Format(wxT(",\"frame_gap_us\":{\"mean\":%.0f,\"max\":%d}"), s.gap_mean, s.gap_max);
+  json << wxString::Format(wxT(",\"lock_wait_us\":{\"mean\":%.1f,\"max\":%d,\"count\":%lld,\"total\":%lld}"), s.lock_wait_mean,
+                           s.lock_wait_max, (long long)s.lock_waits, (long long)s.lock_wait_total);
+  json << wxString::Format(wxT(",\"lock_hold_us\":{\"mean\":%.1f,\"max\":%d,\"count\":%lld,\"total\":%lld}"), s.lock_hold_mean,
+                           s.lock_hold_max, (long long)s.lock_holds, (long long)s.lock_hold_total);
+  json << wxString::Format(wxT(",\"rotation_ms\":{\"period\":%.1f,\"jitter\":%.1f,\"count\":%d}"), s.rotation_period,
+                           s.rotation_jitter, s.rotations);
+  json << wxString::Format(wxT(",\"socket_drops\":{\"total\":%lld,\"per_second\":%d}}"), (long long)s.socket_drops,
+                           s.socket_drops_per_second);
+  return json;
+}
+
+PLUGIN_END_NAMESPACE
@@ -0,0 +1,294 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "SocketReactor.h"
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+PLUGIN_BEGIN_NAMESPACE
+
+#define REACTOR_MAX_EVENTS (32)
+
+SocketReactor::SocketReactor() : wxThread(wxTHREAD_JOINABLE) {
+  m_epoll = -1;
+  m_wake = -1;
+  m_shutdown = false;
+}
+
+SocketReactor::~SocketReactor() {
+  if (m_wake >= 0) {
+    close(m_wake);
+  }
+  if (m_epoll >= 0) {
+    close(m_epoll);
+  }
+}
+
+bool SocketReactor::IsSupported() {
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+/*
+ * Create the epoll set with the wake eventfd in it, and start the thread.
+ */
+bool SocketReactor::Start() {
+#ifdef __linux__
+  struct epoll_event ev;
+
+  m_epoll = epoll_create1(EPOLL_CLOEXEC);
+  m_wake = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (m_epoll < 0 || m_wake < 0) {
+    wxLogError(wxT("cannot create socket reactor: %s"), strerror(errno));
+    return false;
+  }
+  CLEAR_STRUCT(ev);
+  ev.events = EPOLLIN;
+  ev.data.fd = m_wake;
+  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wake, &ev) < 0) {
+    wxLogError(wxT("cannot create socket reactor: %s"), strerror(errno));
+    return false;
+  }
+
+  // Same stack size as the receive threads, as their handlers run on it
+  if (Create(1024 * 1024) != wxTHREAD_NO_ERROR || Run() != wxTHREAD_NO_ERROR) {
+    wxLogError(wxT("cannot start socket reactor thread"));
+    return false;
+  }
+  LOG_INFO(wxT("socket reactor started"));
+  return true;
+#else
+  return false;
+#endif
+}
+
+/*
+ * Wake the thread through the eventfd and wait until it has stopped.
+ * All handlers must have been removed before this is called.
+ */
+void SocketReactor::Shutdown(void) {
+#ifdef __linux__
+  m_shutdown = true;
+  Wake();
+  Wait();
+  LOG_INFO(wxT("socket reactor stopped"));
+#endif
+}
+
+void SocketReactor::Wake() {
+#ifdef __linux__
+  uint64_t one = 1;
+
+  if (write(m_wake, &one, sizeof(one)) != sizeof(one)) {
+    wxLogError(wxT("cannot wake socket reactor: %s"), strerror(errno));
+  }
+#endif
+}
+
+void SocketReactor::AddHandler(SocketReactorHandler *handler, int tick_millis) {
+  wxCriticalSectionLocker lock(m_exclusive);
+  Handler h;
+
+  h.handler = handler;
+  h.tick = std::chrono::milliseconds(tick_millis);
+  h.next_tick = std::chrono::steady_clock::now() + h.tick;
+  m_handlers.push_back(h);
+  if (m_wake >= 0 && tick_millis < REACTOR_TICK_MILLIS) {
+    // The thread may be sleeping for longer than this handler's first tick
+    Wake();
+  }
+}
+
+/*
+ * Stop calling the handler, both for its ticks and for any sockets it still has.
+ */
+void SocketReactor::RemoveHandler(SocketReactorHandler *handler) {
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  for (std::vector<Handler>::iterator it = m_handlers.begin(); it != m_handlers.end();) {
+    if (it->handler == handler) {
+      it = m_handlers.erase(it);
+    } else {
+      it++;
+    }
+  }
+  for (std::map<SOCKET, SocketReactorHandler *>::iterator it = m_sockets.begin(); it != m_sockets.end();) {
+    if (it->second == handler) {
+#ifdef __linux__
+      epoll_ctl(m_epoll, EPOLL_CTL_DEL, it->first, 0);
+#endif
+      m_sockets.erase(it++);
+    } else {
+      it++;
+    }
+  }
+}
+
+bool SocketReactor::Add(SOCKET socket, SocketReactorHandler *handler) {
+#ifdef __linux__
+  wxCriticalSectionLocker lock(m_exclusive);
+  struct epoll_event ev;
+
+  CLEAR_STRUCT(ev);
+  ev.events = EPOLLIN;
+  ev.data.fd = socket;
+  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &ev) < 0) {
+    wxLogError(wxT("cannot add socket %d to reactor: %s"), socket, strerror(errno));
+    return false;
+  }
+  m_sockets[socket] = handler;
+  return true;
+#else
+  return false;
+#endif
+}
+
+/*
+ * Stop watching the socket. Must be called before the socket is closed, as
+ * the number may be reused for a new socket straight away.
+ */
+void SocketReactor::Remove(SOCKET socket) {
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  if (m_sockets.erase(socket) > 0) {
+#ifdef __linux__
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket, 0);
+#endif
+  }
+}
+
+/*
+ * Call OnTick for every handler that is due, and return when the next one is.
+ */
+std::chrono::steady_clock::time_point SocketReactor::Tick() {
+  wxCriticalSectionLocker lock(m_exclusive);
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::vector<SocketReactorHandler *> due;
+
+  for (size_t i = 0; i < m_handlers.size(); i++) {
+    Handler &h = m_handlers[i];
+
+    if (now >= h.next_tick) {
+      due.push_back(h.handler);
+      h.next_tick += h.tick;
+      if (h.next_tick <= now) {  // A handler took a long time, don't try to catch up
+        h.next_tick = now + h.tick;
+      }
+    }
+  }
+
+  // A handler may remove itself (or another) during OnTick, so look each one up again
+  for (size_t i = 0; i < due.size(); i++) {
+    for (size_t j = 0; j < m_handlers.size(); j++) {
+      if (m_handlers[j].handler == due[i]) {
+        due[i]->OnTick();
+        break;
+      }
+    }
+  }
+
+  std::chrono::steady_clock::time_point next = now + std::chrono::milliseconds(REACTOR_TICK_MILLIS);
+  for (size_t i = 0; i < m_handlers.size(); i++) {
+    next = std::min(next, m_handlers[i].next_tick);
+  }
+  return next;
+}
+
+/*
+ * Entry
+ *
+ * Called by wxThread when the new thread is running.
+ * It runs until Shutdown posts the wake eventfd.
+ */
+void *SocketReactor::Entry(void) {
+#ifdef __linux__
+  struct epoll_event events[REACTOR_MAX_EVENTS];
+  std::chrono::steady_clock::time_point next_tick = std::chrono::steady_clock::now();
+  bool shutdown = false;
+
+  while (!shutdown) {
+    // Round up, waking just before a tick would only spin until it is due
+    int64_t micros =
+        std::chrono::duration_cast<std::chrono::microseconds>(next_tick - std::chrono::steady_clock::now()).count();
+    int timeout = (int)((micros + 999) / 1000);
+
+    if (timeout < 0) {
+      timeout = 0;
+    }
+    int n = epoll_wait(m_epoll, events, REACTOR_MAX_EVENTS, timeout);
+    if (n < 0 && errno != EINTR) {
+      wxLogError(wxT("socket reactor failed: %s"), strerror(errno));
+      break;
+    }
+
+    for (int i = 0; i < n; i++) {
+      int fd = events[i].data.fd;
+
+      if (fd == m_wake) {
+        uint64_t count;
+
+        if (m_shutdown) {
+          shutdown = true;
+          break;
+        }
+        if (read(m_wake, &count, sizeof(count)) != sizeof(count)) {  // Just a new handler, clear the wake
+          wxLogError(wxT("cannot clear socket reactor wake: %s"), strerror(errno));
+        }
+        continue;
+      }
+
+      wxCriticalSectionLocker lock(m_exclusive);
+      // The socket may have been removed by a handler called earlier in this batch
+      std::map<SOCKET, SocketReactorHandler *>::iterator it = m_sockets.find(fd);
+      if (it != m_sockets.end()) {
+        it->second->OnReadable(fd);
+      }
+    }
+
+    // Also tick after a wake, a new handler may want its first tick before next_tick
+    if (!shutdown) {
+      next_tick = Tick();
+    }
+  }
+#endif
+  return 0;
+}
+
+PLUGIN_END_NAMESPACE
@@ -0,0 +1,193 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+// Microbenchmark and cross check of the spoke conditioning: the separate
+// main bang, threshold and ARPA history loops that RadarInfo::ProcessRadarSpoke
+// used before against ConditionSpoke() from simdutil.cpp, both the scalar
+// fallback and the vector version. The old loops wrote one history byte per
+// sample; here they also pack those into bits, so all results compare.
+//
+// Usage: condition-bench [spokes]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+// Build the kernel into this program, without the rest of the plugin
+#define PLUGIN_BEGIN_NAMESPACE namespace RadarPlugin {
+#define PLUGIN_END_NAMESPACE }
+#include "simdutil.cpp"
+
+using namespace RadarPlugin;
+
+#define BLOB_HISTORY_MAX (32)  // BLOB_HISTORY_31
+#define SPOKE_LEN_MAX (2048)
+#define SOURCE_SPOKES (256)
+#define MAIN_BANG (10)
+#define STRONG (200)  // threshold_red
+
+#define WORDS (SPOKE_LEN_MAX / 64)
+
+static uint8_t hist[SPOKE_LEN_MAX];  // History line as the old loops wrote it
+
+// The loops from RadarInfo::ProcessRadarSpoke, for a single spoke. They kept no
+// bitmaps, the last three arguments are only there to fit ConditionFunction.
+static size_t LegacyCondition(uint8_t *data, size_t len, size_t main_bang, uint8_t threshold, uint8_t strong,
+                              uint64_t * /* strong_bits */, uint64_t * /* doppler_bits */, size_t /* words */) {
+  size_t doppler = 0;
+  size_t i;
+
+  for (i = 0; i < main_bang && i < len; i++) {
+    data[i] = 0;
+  }
+  if (threshold > 0) {
+    for (; i < len; i++) {
+      if (data[i] < threshold) {
+        data[i] = 0;
+      }
+    }
+  }
+  memset(hist, 0, sizeof(hist));
+  for (size_t radius = 0; radius < len; radius++) {
+    if (data[radius] >= strong) {
+      hist[radius] = 192;
+    }
+    if (data[radius] == 255) {
+      hist[radius] = 0xE0;
+      doppler++;
+    }
+  }
+  return doppler;
+}
+
+// Pack the target and doppler flags of the old history line for comparison
+static void PackLegacyHistory(uint64_t *strong_bits, uint64_t *doppler_bits, size_t words) {
+  for (size_t w = 0; w < words; w++) {
+    strong_bits[w] = 0;
+    doppler_bits[w] = 0;
+    for (size_t b = 0; b < 64; b++) {
+      if (hist[w * 64 + b] & 128) {
+        strong_bits[w] |= (uint64_t)1 << b;
+      }
+      if (hist[w * 64 + b] & 32) {
+        doppler_bits[w] |= (uint64_t)1 << b;
+      }
+    }
+  }
+}
+
+typedef size_t (*ConditionFunction)(uint8_t *data, size_t len, size_t main_bang, uint8_t threshold, uint8_t strong,
+                                    uint64_t *strong_bits, uint64_t *doppler_bits, size_t words);
+
+static const ConditionFunction functions[] = {LegacyCondition, ConditionSpokeScalar, ConditionSpoke};
+static const char *function_name[] = {"legacy", "scalar", "vector"};
+#define FUNCTIONS (sizeof(functions) / sizeof(functions[0]))
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char **argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 200000;
+  static const size_t spoke_lengths[] = {1024, 2048, 1000, 13};  // the usual ones, then odd ones to check the tails
+  static const uint8_t thresholds[] = {0, 32 + 50 * (255 - BLOB_HISTORY_MAX) / 100};
+  int ret = 0;
+
+  if (count <= 0) {
+    fprintf(stderr, "Usage: %s [spokes]\n", argv[0]);
+    return 1;
+  }
+  printf("vector instructions: %s\n", GetSimdName());
+
+  uint8_t *source = (uint8_t *)malloc(SOURCE_SPOKES * SPOKE_LEN_MAX);
+  uint8_t data[FUNCTIONS][SPOKE_LEN_MAX];
+  uint64_t strong_bits[FUNCTIONS][WORDS];
+  uint64_t doppler_bits[FUNCTIONS][WORDS];
+
+  // Sea clutter with strong returns and doppler targets
+  srand(42);
+  for (size_t i = 0; i < SOURCE_SPOKES * SPOKE_LEN_MAX; i++) {
+    int r = rand() % 16;
+    source[i] = r == 0 ? 255 : r < 3 ? (uint8_t)(STRONG + rand() % 55) : (uint8_t)(rand() % 160);
+  }
+
+  for (size_t t = 0; t < sizeof(thresholds) / sizeof(thresholds[0]); t++) {
+    uint8_t threshold = thresholds[t];
+
+    for (size_t l = 0; l < sizeof(spoke_lengths) / sizeof(spoke_lengths[0]); l++) {
+      size_t len = spoke_lengths[l];
+      double ns[FUNCTIONS];
+      int mismatches = 0;
+      volatile size_t sink = 0;
+
+      for (int s = 0; s < SOURCE_SPOKES; s++) {
+        size_t doppler[FUNCTIONS];
+        for (size_t f = 0; f < FUNCTIONS; f++) {
+          memcpy(data[f], source + s * SPOKE_LEN_MAX, len);
+          memset(strong_bits[f], 0x55, sizeof(strong_bits[f]));
+          memset(doppler_bits[f], 0x55, sizeof(doppler_bits[f]));
+          doppler[f] = functions[f](data[f], len, MAIN_BANG, threshold, STRONG, strong_bits[f], doppler_bits[f], WORDS);
+          if (f == 0) {
+            PackLegacyHistory(strong_bits[f], doppler_bits[f], WORDS);
+          }
+        }
+        for (size_t f = 1; f < FUNCTIONS; f++) {
+          if (doppler[f] != doppler[0] || memcmp(data[f], data[0], len) != 0 ||
+              memcmp(strong_bits[f], strong_bits[0], sizeof(strong_bits[f])) != 0 ||
+              memcmp(doppler_bits[f], doppler_bits[0], sizeof(doppler_bits[f])) != 0) {
+            mismatches++;
+          }
+        }
+      }
+
+      for (size_t f = 0; f < FUNCTIONS; f++) {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < count; i++) {
+          uint8_t *d = data[f];
+          memcpy(d, source + (i % SOURCE_SPOKES) * SPOKE_LEN_MAX, len);
+          sink += functions[f](d, len, MAIN_BANG, threshold, STRONG, strong_bits[f], doppler_bits[f], WORDS);
+        }
+        ns[f] = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / count;
+      }
+
+      printf("%4zu samples, threshold %3d:", len, threshold);
+      for (size_t f = 0; f < FUNCTIONS; f++) {
+        printf(" %s %7.1f", function_name[f], ns[f]);
+      }
+      printf(" ns/spoke, speedup %.2fx, %d mismatches\n", ns[0] / ns[FUNCTIONS - 1], mismatches);
+      if (mismatches) {
+        ret = 1;
+      }
+    }
+  }
+  free(source);
+  return ret;
+}
@@ -0,0 +1,282 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "SpokeHistory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+PLUGIN_BEGIN_NAMESPACE
+
+#define ALL_BITS (~(uint64_t)0)
+
+// Not wxLogError, as this is also built into the standalone tools
+static void *AllocOrAbort(size_t count, size_t size) {
+  void *p = calloc(count, size);
+  if (!p) {
+    fprintf(stderr, "Out Of Memory, fatal!\n");
+    abort();
+  }
+  return p;
+}
+
+SpokeHistory::SpokeHistory(size_t spokes, size_t spoke_len_max) {
+  m_spokes = spokes;
+  m_spoke_len_max = spoke_len_max;
+  m_words = (spoke_len_max + 63) / 64;
+  m_generation = 0;
+  m_row_generation = (uint32_t *)AllocOrAbort(sizeof(uint32_t), m_spokes);
+  for (size_t p = 0; p < HISTORY_PLANES; p++) {
+    m_plane[p] = (uint64_t *)AllocOrAbort(sizeof(uint64_t), m_spokes * m_words);
+  }
+}
+
+SpokeHistory::~SpokeHistory() {
+  for (size_t p = 0; p < HISTORY_PLANES; p++) {
+    free(m_plane[p]);
+  }
+  free(m_row_generation);
+}
+
+void SpokeHistory::Clear() { m_generation++; }
+
+/*
+ * Condition a received spoke with ConditionSpoke() and store its strong returns
+ * in the target and contour plane, and its doppler returns in the doppler plane.
+ * Returns the number of doppler returns.
+ */
+size_t SpokeHistory::ConditionRow(int angle, uint8_t *data, size_t len, size_t main_bang, uint8_t threshold, uint8_t strong) {
+  uint64_t *target = GetRow(HISTORY_TARGET, angle);
+  size_t doppler = ConditionSpoke(data, len, main_bang, threshold, strong, target,
+                                  GetRow(HISTORY_DOPPLER, angle), m_words);
+
+  // Every strong return starts out in both the target and the contour plane
+  memcpy(GetRow(HISTORY_CONTOUR, angle), target, m_words * sizeof(uint64_t));
+  MarkRow(angle);
+  return doppler;
+}
+
+/*
+ * Clear the bits r_first up to and including r_last of one spoke.
+ */
+void SpokeHistory::ClearRange(HistoryPlane plane, int angle, int r_first, int r_last) {
+  r_first = std::max(r_first, 0);
+  r_last = std::min(r_last, (int)m_spoke_len_max - 1);
+  if (r_first > r_last) {
+    return;
+  }
+
+  int a = ModSpokes(angle);
+  if (!IsCurrent(a)) {
+    return;
+  }
+  uint64_t *row = GetRow(plane, a);
+  size_t first = r_first >> 6;
+  size_t last = r_last >> 6;
+  uint64_t first_mask = ALL_BITS << (r_first & 63);
+  uint64_t last_mask = ALL_BITS >> (63 - (r_last & 63));
+
+  if (first == last) {
+    row[first] &= ~(first_mask & last_mask);
+    return;
+  }
+  row[first] &= ~first_mask;
+  for (size_t w = first + 1; w < last; w++) {
+    row[w] = 0;
+  }
+  row[last] &= ~last_mask;
+}
+
+/*
+ * Return the first r in [r_first, r_end> that is set in 'plane' (and in the
+ * doppler plane as well when 'doppler' is set), or -1 if there is none.
+ */
+int SpokeHistory::Find(HistoryPlane plane, bool doppler, int angle, int r_first, int r_end) {
+  r_first = std::max(r_first, 0);
+  r_end = std::min(r_end, (int)m_spoke_len_max);
+  if (r_first >= r_end) {
+    return -1;
+  }
+
+  int a = ModSpokes(angle);
+  if (!IsCurrent(a)) {
+    return -1;
+  }
+  const uint64_t *row = GetRow(plane, a);
+  const uint64_t *doppler_row = GetRow(HISTORY_DOPPLER, a);
+  size_t w = r_first >> 6;
+  size_t last = (r_end - 1) >> 6;
+  uint64_t bits = row[w] & (ALL_BITS << (r_first & 63));
+
+  for (;;) {
+    if (doppler) {
+      bits &= doppler_row[w];
+    }
+    if (w == last) {
+      bits &= ALL_BITS >> (63 - ((r_end - 1) & 63));
+    }
+    if (bits) {
+      return (int)(w * 64) + CountTrailingZeros64(bits);
+    }
+    if (w == last) {
+      return -1;
+    }
+    w++;
+    bits = row[w];
+  }
+}
+
+/*
+ * Return how many bits are set in 'plane' (and in the doppler plane as well
+ * when 'doppler' is set) in the window of spokes angle_first up to and
+ * including angle_last, and samples r_first up to and including r_last.
+ */
+int SpokeHistory::Count(HistoryPlane plane, bool doppler, int angle_first, int angle_last, int r_first, int r_last) {
+  r_first = std::max(r_first, 0);
+  r_last = std::min(r_last, (int)m_spoke_len_max - 1);
+  if (r_first > r_last || angle_first > angle_last) {
+    return 0;
+  }
+
+  size_t first = r_first >> 6;
+  size_t last = r_last >> 6;
+  uint64_t first_mask = ALL_BITS << (r_first & 63);
+  uint64_t last_mask = ALL_BITS >> (63 - (r_last & 63));
+  int count = 0;
+
+  if (angle_last - angle_first >= (int)m_spokes) {
+    angle_last = angle_first + (int)m_spokes - 1;
+  }
+  for (int angle = angle_first; angle <= angle_last; angle++) {
+    int a = ModSpokes(angle);
+    if (!IsCurrent(a)) {
+      continue;
+    }
+    const uint64_t *row = GetRow(plane, a);
+    const uint64_t *doppler_row = GetRow(HISTORY_DOPPLER, a);
+
+    for (size_t w = first; w <= last; w++) {
+      uint64_t bits = row[w];
+      if (doppler) {
+        bits &= doppler_row[w];
+      }
+      if (w == first) {
+        bits &= first_mask;
+      }
+      if (w == last) {
+        bits &= last_mask;
+      }
+      count += PopCount64(bits);
+    }
+  }
+  return count;
+}
+
+/*
+ * Walk the contour of the blob in 'plane' (and in the doppler plane as well
+ * when 'doppler' is set) that (angle, rad) is on, always turning left when
+ * possible. Returns true when the contour is at least 'length' pixels. When it
+ * is shorter, the blob is cleared from the target and the contour plane so that
+ * it is not checked again.
+ */
+bool SpokeHistory::HasContour(HistoryPlane plane, bool doppler, int angle, int rad, int length) {
+  // the 4 possible translations to move from a point on the contour to the next
+  static const int transl_angle[4] = {0, 1, 0, -1};
+  static const int transl_r[4] = {1, 0, -1, 0};
+
+  if (rad < 3 || !Pix(plane, doppler, angle, rad)) {
+    return false;  // r too small, or not in a blob
+  }
+
+  int current_angle = angle;
+  int current_r = rad;
+  int min_angle = angle;
+  int max_angle = angle;
+  int min_r = rad;
+  int max_r = rad;
+  int count = 0;
+  int aa = angle;
+  int rr = rad;
+  int index = 0;
+  bool succes = false;
+
+  // first find the orientation of border point p
+  for (int i = 0; i < 4; i++) {
+    index = i;
+    succes = !Pix(plane, doppler, angle + transl_angle[index], rad + transl_r[index]);
+    if (succes) break;
+  }
+  if (!succes) {
+    return false;  // inside the blob, not on its contour
+  }
+  index += 1;  // determines starting direction
+  if (index > 3) index -= 4;
+  while (current_r != rad || current_angle != angle || count == 0) {
+    // try all translations to find the next point, start with the "left most"
+    // translation relative to the previous one
+    index += 3;  // we will turn left all the time if possible
+    for (int i = 0; i < 4; i++) {
+      if (index > 3) index -= 4;
+      aa = current_angle + transl_angle[index];
+      rr = current_r + transl_r[index];
+      succes = Pix(plane, doppler, aa, rr);
+      if (succes) {  // next point found
+        break;
+      }
+      index += 1;
+    }
+    if (!succes) {
+      return false;  // no next point found (this happens when the blob consists of one single pixel)
+    }
+    current_angle = aa;
+    current_r = rr;
+    if (count >= length) {
+      return true;
+    }
+    count++;
+    min_angle = std::min(min_angle, current_angle);
+    max_angle = std::max(max_angle, current_angle);
+    min_r = std::min(min_r, current_r);
+    max_r = std::max(max_r, current_r);
+  }
+
+  // contour length is less than length, erase this blob so we do not have to check this one again
+  for (int a = min_angle; a <= max_angle; a++) {
+    ClearRange(HISTORY_TARGET, a, min_r, max_r);
+    ClearRange(HISTORY_CONTOUR, a, min_r, max_r);
+  }
+  return false;
+}
+
+PLUGIN_END_NAMESPACE
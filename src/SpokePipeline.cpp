@@ -0,0 +1,360 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "SpokePipeline.h"
+
+#include <wx/tokenzr.h>
+
+#include <chrono>
+
+#include "Arpa.h"
+#include "GuardZone.h"
+#include "RadarDraw.h"
+#include "RadarInfo.h"
+#include "SpokeHistory.h"
+#include "TrailBuffer.h"
+
+#undef M_SETTINGS
+#define M_SETTINGS m_ri->m_pi->m_settings
+
+PLUGIN_BEGIN_NAMESPACE
+
+static int64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Calculate course as the moving average of m_hdt over one revolution, and
+// find out how fast the radar is rotating.
+class SpokePipeline::CourseStage : public SpokeStage {
+ public:
+  CourseStage(RadarInfo *ri) : SpokeStage(ri, "course", true) {}
+
+  bool Process(SpokeContext *spoke) {
+    m_ri->SampleCourse(spoke->angle);
+    m_ri->CalculateRotationSpeed(spoke->angle);
+    return true;
+  }
+};
+
+// Recompute 'pixels_per_meter' based on the actual spoke length and range in
+// meters, and reset the image when that or the orientation changes.
+class SpokePipeline::GeometryStage : public SpokeStage {
+ public:
+  GeometryStage(RadarInfo *ri) : SpokeStage(ri, "geometry", true) {}
+
+  bool Process(SpokeContext *spoke) {
+    if (spoke->range_meters == 0) {
+      LOG_INFO(wxT("Error ProcessRadarSpoke range is zero"));
+      return false;
+    }
+
+    double pixels_per_meter =
+        (spoke->len / (double)spoke->range_meters) * (1. - (double)m_ri->m_range_adjustment.GetValue() * 0.001);
+
+    if (m_ri->m_pixels_per_meter != pixels_per_meter) {
+      LOG_RECEIVE(wxT(" %s detected spoke range change from %g to %g pixels/m, %d meters"), m_ri->m_name.c_str(),
+                  m_ri->m_pixels_per_meter, pixels_per_meter, spoke->range_meters);
+      m_ri->m_pixels_per_meter = pixels_per_meter;
+      m_ri->ResetSpokes();
+      if (m_ri->m_arpa) {
+        m_ri->m_arpa->ClearContours();
+      }
+    }
+
+    int orientation = m_ri->GetOrientation();
+    if ((orientation == ORIENTATION_HEAD_UP || m_ri->m_previous_orientation == ORIENTATION_HEAD_UP) &&
+        (orientation != m_ri->m_previous_orientation)) {
+      m_ri->ResetSpokes();
+      m_ri->m_previous_orientation = orientation;
+    }
+
+    // In NORTH or COURSE UP modes we store the radar data at the bearing received
+    // in the spoke. In other words: at an absolute angle off north.
+    // This way, when the boat rotates the data on the overlay doesn't rotate with it.
+    // This is also called 'stabilized' mode, I guess.
+    //
+    // The history data used for the ARPA data is *always* in bearing mode, it is not usable
+    // with relative data.
+    //
+    spoke->stabilized_mode = orientation != ORIENTATION_HEAD_UP;
+    return true;
+  }
+};
+
+// Main bang suppression, threshold and the history used by ARPA and the guard
+// zones, in a single pass over the spoke.
+class SpokePipeline::ConditionStage : public SpokeStage {
+ public:
+  ConditionStage(RadarInfo *ri) : SpokeStage(ri, "condition", true) {}
+
+  bool Process(SpokeContext *spoke) {
+    RadarInfo::line_history *history = &m_ri->m_history[spoke->bearing];
+    int main_bang = wxMax(m_ri->m_main_bang_size.GetValue(), 0);
+    int threshold = m_ri->m_threshold.GetValue();
+
+    if (threshold > 0) {
+      threshold = threshold * (255 - BLOB_HISTORY_MAX) / 100 + BLOB_HISTORY_MAX;
+    }
+    history->time = spoke->time;
+    m_ri->GetRadarPosition(&history->pos);
+    m_ri->m_doppler_count += (int)m_ri->m_history_bits->ConditionRow(spoke->bearing, spoke->data, spoke->len, (size_t)main_bang,
+                                                                     (uint8_t)wxMax(threshold, 0), (uint8_t)M_SETTINGS.threshold_red);
+    return true;
+  }
+};
+
+class SpokePipeline::GuardZoneStage : public SpokeStage {
+ public:
+  GuardZoneStage(RadarInfo *ri) : SpokeStage(ri, "guard_zones", false) {}
+
+  bool IsActive() {
+    for (size_t z = 0; z < GUARD_ZONES; z++) {
+      if (m_ri->m_guard_zone[z]->m_alarm_on) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool Process(SpokeContext *spoke) {
+    for (size_t z = 0; z < GUARD_ZONES; z++) {
+      if (m_ri->m_guard_zone[z]->m_alarm_on) {
+        m_ri->m_guard_zone[z]->ProcessSpoke(spoke->angle, spoke->data, spoke->len);
+      }
+    }
+    return true;
+  }
+};
+
+// Paint the outer range ring into the image, but keep it out of the trails.
+class SpokePipeline::ExtremeRangeStage : public SpokeStage {
+ public:
+  ExtremeRangeStage(RadarInfo *ri) : SpokeStage(ri, "extreme_range", false) {}
+
+  bool IsActive() { return M_SETTINGS.show_extreme_range; }
+
+  bool Process(SpokeContext *spoke) {
+    spoke->data[spoke->len - 1] = 255;
+    spoke->trail_len--;
+    return true;
+  }
+};
+
+// The overlay is drawn either before the trails are added to the spoke, or
+// after when the trails should be shown on the chart as well. So there are two
+// of these, one on each side of the trails stage.
+class SpokePipeline::OverlayStage : public SpokeStage {
+ public:
+  OverlayStage(RadarInfo *ri, bool with_trails) : SpokeStage(ri, "overlay", false) { m_with_trails = with_trails; }
+
+  bool IsActive() { return m_ri->m_draw_overlay.draw && M_SETTINGS.trails_on_overlay == m_with_trails; }
+
+  bool Process(SpokeContext *spoke) {
+    m_ri->m_draw_overlay.draw->ProcessRadarSpoke(M_SETTINGS.overlay_transparency.GetValue(), spoke->bearing, spoke->data,
+                                                 spoke->len, m_ri->m_history[spoke->bearing].pos);
+    return true;
+  }
+
+ private:
+  bool m_with_trails;
+};
+
+// Always active: the trail position has to follow the boat even while the
+// trails are off, so that they line up when they are switched on again.
+class SpokePipeline::TrailsStage : public SpokeStage {
+ public:
+  TrailsStage(RadarInfo *ri) : SpokeStage(ri, "trails", false) {}
+
+  bool Process(SpokeContext *spoke) {
+    m_ri->m_trails->UpdateTrailPosition();
+
+    if (m_ri->m_target_trails.GetState() == RCS_OFF) {
+      return true;
+    }
+
+    // True trails
+    m_ri->m_trails->UpdateTrueTrails(spoke->bearing, spoke->data, spoke->trail_len);
+
+    // Relative trails
+    m_ri->m_trails->UpdateRelativeTrails(spoke->angle, spoke->data, spoke->trail_len);
+    return true;
+  }
+};
+
+class SpokePipeline::PanelStage : public SpokeStage {
+ public:
+  PanelStage(RadarInfo *ri) : SpokeStage(ri, "panel", false) {}
+
+  bool IsActive() { return m_ri->m_draw_panel.draw != 0; }
+
+  bool Process(SpokeContext *spoke) {
+    m_ri->m_draw_panel.draw->ProcessRadarSpoke(4, spoke->stabilized_mode ? spoke->bearing : spoke->angle, spoke->data,
+                                               spoke->len, m_ri->m_history[spoke->bearing].pos);
+    return true;
+  }
+};
+
+SpokePipeline::SpokePipeline(RadarInfo *ri) {
+  m_ri = ri;
+  m_count = 0;
+
+  Add(new CourseStage(ri));
+  Add(new GeometryStage(ri));
+  Add(new ConditionStage(ri));
+  Add(new GuardZoneStage(ri));
+  Add(new ExtremeRangeStage(ri));
+  Add(new OverlayStage(ri, false));
+  Add(new TrailsStage(ri));
+  Add(new OverlayStage(ri, true));
+  Add(new PanelStage(ri));
+}
+
+SpokePipeline::~SpokePipeline() {
+  for (size_t i = 0; i < m_count; i++) {
+    delete m_stage[i];
+  }
+}
+
+void SpokePipeline::Add(SpokeStage *stage) {
+  if (m_count == SPOKE_STAGES) {
+    wxLogError(wxT("Too many spoke processing stages, %s ignored"), stage->GetName());
+    delete stage;
+    return;
+  }
+  m_stage[m_count] = stage;
+  m_enabled[m_count] = true;
+  m_spokes[m_count] = 0;
+  m_ns[m_count] = 0;
+  m_count++;
+}
+
+/*
+ * Run the spoke through all enabled and active stages. Called with
+ * m_ri->m_exclusive and m_ri->m_draw_lock held.
+ */
+void SpokePipeline::Process(SpokeContext *spoke) {
+  for (size_t i = 0; i < m_count; i++) {
+    if (!m_enabled[i].load(std::memory_order_relaxed) || !m_stage[i]->IsActive()) {
+      continue;
+    }
+    int64_t start = NowNanos();
+    bool more = m_stage[i]->Process(spoke);
+    int64_t end = NowNanos();
+
+    m_spokes[i].fetch_add(1, std::memory_order_relaxed);
+    m_ns[i].fetch_add(end - start, std::memory_order_relaxed);
+    if (!more) {
+      break;
+    }
+  }
+}
+
+/*
+ * Switch all stages called 'name' on or off. Returns false if there is no such
+ * stage or it cannot be switched off.
+ */
+bool SpokePipeline::SetStageEnabled(const wxString &name, bool enabled) {
+  bool found = false;
+
+  for (size_t i = 0; i < m_count; i++) {
+    if (name == wxString::FromAscii(m_stage[i]->GetName())) {
+      if (!enabled && m_stage[i]->IsRequired()) {
+        return false;
+      }
+      m_enabled[i] = enabled;
+      found = true;
+    }
+  }
+  return found;
+}
+
+void SpokePipeline::SetDisabledStages(const wxString &names) {
+  for (size_t i = 0; i < m_count; i++) {
+    m_enabled[i] = true;
+  }
+
+  wxStringTokenizer tokens(names, wxT(","));
+  while (tokens.HasMoreTokens()) {
+    wxString name = tokens.GetNextToken().Trim().Trim(false);
+    if (!name.IsEmpty() && !SetStageEnabled(name, false)) {
+      wxLogWarning(wxT("radar_pi: %s cannot switch off spoke processing stage '%s'"), m_ri->m_name.c_str(), name.c_str());
+    }
+  }
+}
+
+wxString SpokePipeline::GetDisabledStages() {
+  wxString names;
+
+  for (size_t i = 0; i < m_count; i++) {
+    wxString name = wxString::FromAscii(m_stage[i]->GetName());
+    if (!m_enabled[i] && names.Find(name) == wxNOT_FOUND) {
+      if (!names.IsEmpty()) {
+        names << wxT(",");
+      }
+      names << name;
+    }
+  }
+  return names;
+}
+
+/*
+ * Return the number of spokes and time per spoke of every stage since the
+ * previous call. Stages with the same name are reported together.
+ */
+size_t SpokePipeline::GetTimings(SpokeStageTiming *timings) {
+  int64_t ns[SPOKE_STAGES];
+  size_t n = 0;
+
+  for (size_t i = 0; i < m_count; i++) {
+    size_t t;
+
+    for (t = 0; t < n; t++) {
+      if (strcmp(timings[t].name, m_stage[i]->GetName()) == 0) {
+        break;
+      }
+    }
+    if (t == n) {
+      timings[t].name = m_stage[i]->GetName();
+      timings[t].enabled = m_enabled[i];
+      timings[t].spokes = 0;
+      ns[t] = 0;
+      n++;
+    }
+    timings[t].spokes += (int)m_spokes[i].exchange(0);
+    ns[t] += m_ns[i].exchange(0);
+  }
+  for (size_t t = 0; t < n; t++) {
+    timings[t].ns_per_spoke = timings[t].spokes > 0 ? (int)(ns[t] / timings[t].spokes) : 0;
+  }
+  return n;
+}
+
+PLUGIN_END_NAMESPACE
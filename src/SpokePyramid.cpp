@@ -0,0 +1,111 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "SpokePyramid.h"
+
+#include "simdutil.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+SpokePyramid::SpokePyramid(size_t spokes, size_t spoke_len_max) {
+  m_spokes = spokes;
+  m_spoke_len_max = spoke_len_max;
+  for (int l = 0; l < PYRAMID_LEVELS; l++) {
+    size_t scale = (size_t)1 << l;
+    Level *level = &m_level[l];
+
+    level->spokes = (spokes + scale - 1) / scale;
+    level->spoke_len = (spoke_len_max + scale - 1) / scale;
+    level->data = (uint8_t *)calloc(level->spokes, level->spoke_len);
+    level->generation = (uint32_t *)calloc(sizeof(uint32_t), level->spokes);
+    if (!level->data || !level->generation) {
+      wxLogError(wxT("Out Of Memory, fatal!"));
+      wxAbort();
+    }
+  }
+}
+
+SpokePyramid::~SpokePyramid() {
+  for (int l = 0; l < PYRAMID_LEVELS; l++) {
+    free(m_level[l].data);
+    free(m_level[l].generation);
+  }
+}
+
+/*
+ * Store a spoke in level 0 and pool it into the same row of every coarser
+ * level, together with the spoke next to it.
+ */
+void SpokePyramid::SetSpoke(SpokeBearing angle, uint8_t *data, size_t len, uint32_t generation) {
+  size_t row = angle;
+
+  if (row >= m_spokes) {
+    return;
+  }
+  len = wxMin(len, m_spoke_len_max);
+  memcpy(GetRow(0, row), data, len);
+  memset(GetRow(0, row) + len, 0, m_spoke_len_max - len);
+  m_level[0].generation[row] = generation;
+
+  for (int l = 1; l < PYRAMID_LEVELS; l++) {
+    Level *fine = &m_level[l - 1];
+    size_t other = row ^ 1;  // the neighbour that shares the coarse row
+    uint8_t *src = GetRow(l - 1, row);
+    uint8_t *src2 = src;
+
+    if (other < fine->spokes && fine->generation[other] == generation) {
+      src2 = GetRow(l - 1, other);
+    }
+    row >>= 1;
+    MaxPool2x2(src, src2, GetRow(l, row), fine->spoke_len);
+    m_level[l].generation[row] = generation;
+  }
+}
+
+/*
+ * Return the coarsest level whose samples still cover at most one pixel along
+ * the spoke, and at most two pixels across the spokes at the edge of the image.
+ */
+int SpokePyramid::ChooseLevel(double pixels_per_sample) {
+  double edge = 2. * PI * m_spoke_len_max / m_spokes;  // samples between two spokes at the edge
+  int level = 0;
+
+  while (level + 1 < PYRAMID_LEVELS) {
+    double pixels = (double)((size_t)1 << (level + 1)) * pixels_per_sample;
+    if (pixels > 1. || pixels * edge > 2.) {
+      break;
+    }
+    level++;
+  }
+  return level;
+}
+
+PLUGIN_END_NAMESPACE
@@ -0,0 +1,228 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "SpokeQueue.h"
+
+#include "RadarInfo.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+#define SPOKE_QUEUE_MASK (SPOKE_QUEUE_SIZE - 1)
+#define SPOKE_QUEUE_IDLE_MILLIS (250)
+
+SpokeQueue::SpokeQueue(RadarInfo *ri, size_t spoke_len_max) : wxThread(wxTHREAD_JOINABLE), m_wakeup(0, 1), m_space(0, 1) {
+  m_ri = ri;
+  m_spoke_len_max = spoke_len_max;
+  m_data = (uint8_t *)calloc(SPOKE_QUEUE_SIZE, m_spoke_len_max);
+  if (!m_data) {
+    wxLogError(wxT("Out Of Memory, fatal!"));
+    wxAbort();
+  }
+  for (size_t i = 0; i < SPOKE_QUEUE_SIZE; i++) {
+    m_spokes[i].data = m_data + i * m_spoke_len_max;
+  }
+  m_stop = false;
+  m_blocking = false;
+  m_producer_waiting = false;
+  m_head = 0;
+  m_tail = 0;
+  m_high_water = 0;
+  m_overflows = 0;
+  m_processed = 0;
+}
+
+SpokeQueue::~SpokeQueue() { free(m_data); }
+
+bool SpokeQueue::Start() {
+  if (Create(256 * 1024) != wxTHREAD_NO_ERROR || Run() != wxTHREAD_NO_ERROR) {
+    wxLogError(wxT("%s cannot start spoke processing thread"), m_ri->m_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Stop the processing thread, after it has processed all queued spokes.
+ * The producer must have been stopped before this is called.
+ */
+void SpokeQueue::Stop() {
+  m_stop = true;
+  m_wakeup.Post();
+  Wait();
+}
+
+/*
+ * Wait until at most max_depth spokes are queued. Only the producer calls this.
+ *
+ * Returns false when the processing thread was stopped.
+ */
+bool SpokeQueue::WaitForDepth(int max_depth) {
+  uint32_t head = m_head.load(std::memory_order_relaxed);
+
+  while ((int)(head - m_tail) > max_depth) {
+    if (m_stop) {
+      return false;
+    }
+    // Announce that we wait and look at m_tail again, so that a slot freed in
+    // between is either seen here or makes the consumer post m_space.
+    m_producer_waiting = true;
+    if ((int)(head - m_tail) <= max_depth) {
+      m_producer_waiting = false;
+      break;
+    }
+    m_space.WaitTimeout(SPOKE_QUEUE_IDLE_MILLIS);
+  }
+  return true;
+}
+
+/*
+ * Wait until the processing thread has processed every queued spoke.
+ */
+void SpokeQueue::Drain() { WaitForDepth(0); }
+
+/*
+ * Return the slot that the next Push() will fill, so the receive thread can
+ * decode the spoke straight into it. Only the producer moves m_head, so the
+ * slot stays the same until that Push().
+ *
+ * In blocking mode this waits for a free slot first.
+ *
+ * Returns 0 when the ring is full or the spoke does not fit.
+ */
+uint8_t *SpokeQueue::Reserve(size_t len) {
+  uint32_t head = m_head.load(std::memory_order_relaxed);
+
+  if (len > m_spoke_len_max) {
+    return 0;
+  }
+  if (m_blocking) {
+    WaitForDepth(SPOKE_QUEUE_SIZE - 1);
+  }
+  if ((int)(head - m_tail) >= SPOKE_QUEUE_SIZE) {
+    return 0;
+  }
+  return m_spokes[head & SPOKE_QUEUE_MASK].data;
+}
+
+/*
+ * Called by the receive thread for every decoded spoke. Never blocks, unless
+ * SetBlocking(true) was called; then it waits for a free slot.
+ *
+ * Returns false when the ring is full and the spoke was dropped.
+ */
+bool SpokeQueue::Push(SpokeBearing angle, SpokeBearing bearing, const uint8_t *data, size_t len, int range_meters,
+                      wxLongLong time) {
+  uint32_t head = m_head.load(std::memory_order_relaxed);
+
+  if (m_blocking) {
+    WaitForDepth(SPOKE_QUEUE_SIZE - 1);
+  }
+  if ((int)(head - m_tail) >= SPOKE_QUEUE_SIZE) {
+    m_overflows++;
+    return false;
+  }
+  if (len > m_spoke_len_max) {
+    len = m_spoke_len_max;
+  }
+
+  QueuedSpoke *spoke = &m_spokes[head & SPOKE_QUEUE_MASK];
+  spoke->angle = angle;
+  spoke->bearing = bearing;
+  spoke->len = len;
+  spoke->range_meters = range_meters;
+  spoke->time = time;
+  if (spoke->data != data) {  // Not decoded in place after Reserve()
+    memcpy(spoke->data, data, len);
+  }
+  m_head = head + 1;
+
+  // Reading m_tail after publishing m_head (both sequentially consistent) means that
+  // either the consumer sees this spoke before it goes to sleep, or we see that
+  // it has emptied the ring and wake it.
+  int depth = (int)(head + 1 - m_tail);
+  if (depth > m_high_water.load(std::memory_order_relaxed)) {
+    m_high_water = depth;
+  }
+  if (depth == 1) {
+    m_wakeup.Post();
+  }
+  return true;
+}
+
+/*
+ * Return current depth, and the high water mark and overflow count since the
+ * previous call.
+ */
+void SpokeQueue::GetStatistics(int *depth, int *high_water, int *overflows) {
+  *depth = (int)(m_head - m_tail);
+  *high_water = m_high_water.exchange(0);
+  *overflows = m_overflows.exchange(0);
+}
+
+void *SpokeQueue::Entry(void) {
+  LOG_VERBOSE(wxT("%s spoke processing thread started"), m_ri->m_name.c_str());
+
+  for (;;) {
+    uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    uint32_t head = m_head;
+
+    while (tail != head) {
+      QueuedSpoke *spoke = &m_spokes[tail & SPOKE_QUEUE_MASK];
+      {
+        int64_t wait_start = RadarTelemetry::Now();
+        wxCriticalSectionLocker lock(m_ri->m_exclusive);
+        wxCriticalSectionLocker draw_lock(m_ri->m_draw_lock);
+
+        m_ri->m_telemetry.AddLockWait(wait_start);
+        int64_t hold_start = RadarTelemetry::Now();
+        m_ri->ProcessRadarSpoke(spoke->angle, spoke->bearing, spoke->data, spoke->len, spoke->range_meters, spoke->time);
+        m_ri->m_telemetry.AddLockHold(hold_start);
+      }
+      m_processed++;
+      tail++;
+      m_tail = tail;
+      if (m_producer_waiting && m_producer_waiting.exchange(false)) {
+        m_space.Post();
+      }
+      head = m_head;
+    }
+
+    if (m_stop) {
+      break;
+    }
+    m_wakeup.WaitTimeout(SPOKE_QUEUE_IDLE_MILLIS);
+  }
+
+  LOG_VERBOSE(wxT("%s spoke processing thread stopped"), m_ri->m_name.c_str());
+  return 0;
+}
+
+PLUGIN_END_NAMESPACE
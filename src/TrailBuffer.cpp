@@ -31,6 +31,8 @@
 
 #include "TrailBuffer.h"
 
+#include "spokeutil.h"
+
 #undef M_SETTINGS
 #define M_SETTINGS m_ri->m_pi->m_settings
 
@@ -79,50 +81,11 @@ void TrailBuffer::UpdateTrueTrails(SpokeBearing bearing, uint8_t *data, size_t l
     int motion = m_ri->m_trails_motion.GetValue();
     bool update_targets_true = (motion == TARGET_MOTION_TRUE);
 
-    uint8_t weak_target = M_SETTINGS.threshold_blue;
-    uint8_t strong_target = M_SETTINGS.threshold_red;
-    size_t radius = 0;
-
-    for (; radius < len - 1; radius++) {  //  len - 1 : no trails on range circle
-      PointInt point = m_ri->m_polar_lookup->GetPointInt(bearing, radius);
-
-      point.x += m_trail_size / 2 + m_offset.lat;
-      point.y += m_trail_size / 2 + m_offset.lon;
-
-      if (point.x >= 0 && point.x < (int)m_trail_size && point.y >= 0 && point.y < (int)m_trail_size) {
-        uint8_t *trail = &M_TRUE_TRAILS(point.x, point.y);
-        // when ship moves north, offset.lat > 0. Add to move trails image in opposite direction
-        // when ship moves east, offset.lon > 0. Add to move trails image in opposite direction
-        if (data[radius] >= strong_target) {
-          *trail = 1;
-        } else if (*trail > 0 && *trail < TRAIL_MAX_REVOLUTIONS) {
-          (*trail)++;
-        }
-
-        if (update_targets_true && (data[radius] < weak_target)) {
-          data[radius] = m_ri->m_trail_colour[*trail];
-        }
-      }
-    }
-
-    // Now process the rest of the spoke from len to m_spoke_len_max.
-    // This will only be called when the current spoke length is smaller than the max.
-    // we need to update the trail 'age' for those points.
-    for (; radius < m_ri->m_spoke_len_max; radius++) {
-      PointInt point = m_ri->m_polar_lookup->GetPointInt(bearing, radius);
-
-      point.x += m_trail_size / 2 + m_offset.lat;
-      point.y += m_trail_size / 2 + m_offset.lon;
-
-      if (point.x >= 0 && point.x < (int)m_trail_size && point.y >= 0 && point.y < (int)m_trail_size) {
-        uint8_t *trail = &M_TRUE_TRAILS(point.x, m_trail_size + point.y);
-        // when ship moves north, offset.lat > 0. Add to move trails image in opposite direction
-        // when ship moves east, offset.lon > 0. Add to move trails image in opposite direction
-        if (*trail > 0 && *trail < TRAIL_MAX_REVOLUTIONS) {
-          (*trail)++;
-        }
-      }
-    }
+    // when ship moves north, offset.lat > 0. Add to move trails image in opposite direction
+    // when ship moves east, offset.lon > 0. Add to move trails image in opposite direction
+    UpdateTrueTrailSpoke(m_ri->m_polar_lookup->GetPointIntRow(bearing), m_true_trails, m_trail_size, m_trail_size / 2 + m_offset.lat,
+                         m_trail_size / 2 + m_offset.lon, data, len, m_ri->m_spoke_len_max, M_SETTINGS.threshold_blue,
+                         M_SETTINGS.threshold_red, TRAIL_MAX_REVOLUTIONS, update_targets_true ? m_ri->m_trail_colour : 0);
   }
 }
 
@@ -130,30 +93,10 @@ void TrailBuffer::UpdateRelativeTrails(SpokeBearing angle, uint8_t *data, size_t
   int motion = m_ri->m_trails_motion.GetValue();
   RadarControlState trails = m_ri->m_target_trails.GetState();
   if (trails != RCS_OFF) {
-    uint8_t *trail = &M_RELATIVE_TRAILS(angle, 0);
-    size_t radius = 0;
-
     bool update_relative_motion = motion == TARGET_MOTION_RELATIVE;
 
-    uint8_t weak_target = M_SETTINGS.threshold_blue;
-    uint8_t strong_target = M_SETTINGS.threshold_red;
-
-    for (radius = 0; radius < len - 1; radius++, trail++) {  // len - 1 : no trails on range circle
-      if (data[radius] >= strong_target) {
-        *trail = 1;
-      } else if (*trail > 0 && *trail < TRAIL_MAX_REVOLUTIONS) {
-        (*trail)++;
-      }
-
-      if (update_relative_motion && (data[radius] < weak_target)) {
-        data[radius] = m_ri->m_trail_colour[*trail];
-      }
-    }
-
-    for (; radius < (size_t)m_max_spoke_len; radius++, trail++)  // And clear out empty bit of spoke when spoke_len < max_spoke_len
-    {
-      *trail = 0;
-    }
+    UpdateRelativeTrailSpoke(&M_RELATIVE_TRAILS(angle, 0), data, len, m_max_spoke_len, M_SETTINGS.threshold_blue,
+                             M_SETTINGS.threshold_red, TRAIL_MAX_REVOLUTIONS, update_relative_motion ? m_ri->m_trail_colour : 0);
   }
 }
 
@@ -32,11 +32,9 @@
 
 #include "EmulatorReceive.h"
 
+#include "Arpa.h"
 #include "RadarFactory.h"
 
-#define SCALE_RAW_TO_DEGREES(raw) ((raw) * (double)DEGREES_PER_ROTATION / EMULATOR_SPOKES)
-#define SCALE_DEGREES_TO_RAW(angle) ((int)((angle) * (double)EMULATOR_SPOKES / DEGREES_PER_ROTATION))
-
 PLUGIN_BEGIN_NAMESPACE
 
 /*
@@ -45,168 +43,274 @@ PLUGIN_BEGIN_NAMESPACE
  * The rest of the plugin uses a (slightly) abstract definition of the radar.
  */
 
-#define MILLIS_PER_SELECT 250
-#define SECONDS_SELECT(x) ((x) * MILLISECONDS_PER_SECOND / MILLIS_PER_SELECT)
+#define MILLIS_PER_TICK 5  // Wake up this often to send the spokes that are due
 
 /*
- * Called once a second. Emulate a radar return that is
- * at the current desired auto_range.
- * Speed is 24 images per minute, e.g. 1/2.5 of a full
- * image.
+ * Whether this is the emulator with the lowest radar number, which owns the
+ * own ship and the truth file of a shared scenario.
  */
+bool EmulatorReceive::IsFirstEmulator() {
+  for (size_t r = 0; r < m_ri->m_radar; r++) {
+    if (m_pi->m_radar[r] && m_pi->m_radar[r]->m_radar_type == RT_EMULATOR) {
+      return false;
+    }
+  }
+  return true;
+}
 
-void EmulatorReceive::EmulateFakeBuffer(void) {
+/*
+ * Called every MILLIS_PER_TICK with the number of spokes that are due.
+ * Emulate a radar return that is at the current desired auto_range.
+ *
+ * Returns false when the radar is not transmitting, so the caller does not
+ * build up a backlog.
+ */
+bool EmulatorReceive::EmulateFakeBuffer(size_t spokes) {
   time_t now = time(0);
-  uint8_t data[EMULATOR_MAX_SPOKE_LEN];
+  uint8_t spoke_buffer[SPOKE_LEN_MAX];
+  size_t len = m_ri->m_spoke_len_max;
+  int64_t start = RadarTelemetry::Now();
 
-  wxCriticalSectionLocker lock(m_ri->m_exclusive);
+  if (m_scenario) {
+    GeoPosition pos;
+    bool pos_valid = m_ri->GetRadarPosition(&pos);  // Lock free
 
-  m_ri->m_radar_timeout = now + WATCHDOG_TIMEOUT;
+    m_scenario->Advance(start, pos_valid, pos);
+  }
 
-  int state = m_ri->m_state.GetValue();
+  int range_meters;
+  const int *ranges;
+  size_t count = RadarFactory::GetRadarRanges(RT_EMULATOR, M_SETTINGS.range_units, &ranges);
 
-  if (state != RADAR_TRANSMIT) {
-    if (state == RADAR_OFF) {
-      m_ri->m_state.Update(RADAR_STANDBY);
-    }
-    return;
-  }
+  {
+    // Only the state and the statistics need the lock, not generating the spokes
+    wxCriticalSectionLocker lock(m_ri->m_receive_exclusive);
 
-  m_ri->m_statistics.packets++;
-  m_ri->m_data_timeout = now + WATCHDOG_TIMEOUT;
+    m_ri->m_radar_timeout = now + WATCHDOG_TIMEOUT;
 
-  m_next_rotation = (m_next_rotation + 1) % EMULATOR_SPOKES;
+    int state = m_ri->m_state.GetValue();
 
-  int scanlines_in_packet = EMULATOR_SPOKES * 24 / 60 * MILLIS_PER_SELECT / MILLISECONDS_PER_SECOND;
-  int range_meters = m_ri->m_range.GetValue();
+    if (state != RADAR_TRANSMIT) {
+      if (state == RADAR_OFF) {
+        m_ri->m_state.Update(RADAR_STANDBY);
+      }
+      return false;
+    }
+    if (spokes == 0) {
+      return true;
+    }
 
-  const int *ranges;
-  size_t count = RadarFactory::GetRadarRanges(RT_EMULATOR, M_SETTINGS.range_units, &ranges);
+    m_ri->m_statistics.packets++;
+    m_ri->m_data_timeout = now + WATCHDOG_TIMEOUT;
 
-  if (range_meters < ranges[0]) {
-    range_meters = ranges[0];
-    m_ri->m_range.Update(range_meters);
+    range_meters = m_ri->m_range.GetValue();
+    if (range_meters < ranges[0]) {
+      range_meters = ranges[0];
+      m_ri->m_range.Update(range_meters);
+    }
+    if (range_meters > ranges[count - 1]) {
+      range_meters = ranges[count - 1];
+      m_ri->m_range.Update(range_meters);
+    }
   }
-  if (range_meters > ranges[count - 1]) {
-    range_meters = ranges[count - 1];
-    m_ri->m_range.Update(range_meters);
+
+  if (m_scenario) {
+    m_scenario->Prepare(m_ri->m_spokes, len, range_meters);
   }
 
   int spots = 0;
+  int hdt = SCALE_DEGREES_TO_SPOKES(m_pi->GetHeadingTrue());
+  wxLongLong time_rec = wxGetUTCTimeMillis();
 
-  for (int scanline = 0; scanline < scanlines_in_packet; scanline++) {
+  for (size_t scanline = 0; scanline < spokes; scanline++) {
     int angle = m_next_spoke;
     m_next_spoke = MOD_SPOKES(m_next_spoke + 1);
-    m_ri->m_statistics.spokes++;
-
-    if (range_meters == ranges[count - 1]) {
-      // New pattern suited for arpa / guard zone detection
-      CLEAR_STRUCT(data);
-      if (scanline < 8) {
-        for (size_t range = 384; range < 410; range++) {
-          data[range] = 255;
-          spots++;
-        }
-      }
-    } else {
-      // The blotchy pattern
-      // Invent a pattern. Outermost ring, then a square pattern
-      for (size_t range = 0; range < sizeof(data); range++) {
-        size_t bit = range >> 7;
-        // use bit 'bit' of angle_raw
-        uint8_t colour;
-        if (range > sizeof(data) - 10) {
-          colour = ((angle + m_next_rotation) % EMULATOR_SPOKES) <= 8 ? 255 : 0;
-        } else if (range > sizeof(data) - 20) {
-          colour = (angle * 256 / EMULATOR_SPOKES);
-        } else {
-          colour = (((angle + m_next_rotation) >> 5) & (2 << bit)) > 0 ? (range / 2) : 0;
-        }
-        data[range] = colour;
-        if (colour >= M_SETTINGS.threshold_blue) {
-          spots++;
-        }
+    if (angle % (m_ri->m_spokes / 10) == 0) {
+      m_next_rotation = (m_next_rotation + 1) % m_ri->m_spokes;
+    }
+    if (m_next_spoke == 0) {
+      m_new_rotation = true;
+      if (m_scenario) {
+        m_scenario->NewRotation();
       }
     }
-
-    int hdt = SCALE_DEGREES_TO_SPOKES(m_pi->GetHeadingTrue());
+    uint8_t *data = m_ri->ReserveRadarSpoke(len);  // Generate straight into the spoke queue
+    if (!data) {
+      data = spoke_buffer;
+    }
     int bearing = MOD_SPOKES(angle + hdt);
+    EmulateSpoke(angle, bearing, data, len, range_meters, range_meters == ranges[count - 1], &spots);
 
-    wxLongLong time_rec = wxGetUTCTimeMillis();
-    m_ri->ProcessRadarSpoke(angle, bearing, data, sizeof(data), range_meters, time_rec);
+    m_ri->QueueRadarSpoke(angle, bearing, data, len, range_meters, time_rec);
   }
+  {
+    wxCriticalSectionLocker lock(m_ri->m_receive_exclusive);
+    m_ri->m_statistics.spokes += (int)spokes;
+  }
+  m_ri->m_telemetry.AddFrame(spokes * len, start, 0);
 
-  LOG_VERBOSE(wxT("emulating %d spokes at range %d with %d spots"), scanlines_in_packet, range_meters, spots);
+  LOG_VERBOSE(wxT("emulating %d spokes at range %d with %d spots"), (int)spokes, range_meters, spots);
+  return true;
 }
 
 /*
- * Entry
- *
- * Called by wxThread when the new thread is running.
- * It should remain running until Shutdown is called.
+ * Fill one spoke. With a scenario, its targets at their true bearing.
+ * Otherwise at the maximum range there are ten small targets per
+ * rotation, for ARPA and guard zone testing; at other ranges an outermost
+ * ring and a slowly rotating square pattern. Clutter is added on top, most
+ * of it close to the boat like sea clutter.
  */
-void *EmulatorReceive::Entry(void) {
-  int r = 0;
-  NetworkAddress fake(127, 0, 0, 10, 3333);
-
-  LOG_VERBOSE(wxT("EmulatorReceive thread %s starting"), m_ri->m_name.c_str());
+void EmulatorReceive::EmulateSpoke(int angle, int bearing, uint8_t *data, size_t len, int range_meters, bool max_range,
+                                   int *spots) {
+  int spokes = (int)m_ri->m_spokes;
+
+  if (m_scenario) {
+    memset(data, 0, len);
+    *spots += m_scenario->RenderSpoke(bearing, data, len);
+  } else if (max_range) {
+    // New pattern suited for arpa / guard zone detection
+    memset(data, 0, len);
+    if (angle % (spokes / 10) < 8) {
+      for (size_t range = len / 2; range < len * 410 / 768; range++) {
+        data[range] = 255;
+        (*spots)++;
+      }
+    }
+  } else {
+    // The blotchy pattern
+    // Invent a pattern. Outermost ring, then a square pattern
+    for (size_t range = 0; range < len; range++) {
+      size_t bit = range >> 7;
+      // use bit 'bit' of angle_raw
+      uint8_t colour;
+      if (range > len - 10) {
+        colour = ((angle + m_next_rotation) % spokes) <= 8 ? 255 : 0;
+      } else if (range > len - 20) {
+        colour = (angle * 256 / spokes);
+      } else {
+        colour = (((angle + m_next_rotation) >> 5) & (2 << bit)) > 0 ? (range / 2) : 0;
+      }
+      data[range] = colour;
+      if (colour >= M_SETTINGS.threshold_blue) {
+        (*spots)++;
+      }
+    }
+  }
 
-  m_ri->DetectedRadar(fake, fake);
+  int clutter = M_SETTINGS.emulator_clutter;
+  if (m_scenario) {
+    clutter = m_scenario->GetClutter(clutter);
+  }
+  if (clutter > 0) {
+    // Probability falls off linearly to zero at the end of the spoke
+    uint32_t threshold = (uint32_t)(clutter * (UINT32_MAX / 100));
+    uint32_t step = threshold / (uint32_t)len;
+
+    for (size_t range = 0; range < len; range++, threshold -= step) {
+      m_random ^= m_random << 13;
+      m_random ^= m_random >> 17;
+      m_random ^= m_random << 5;
+      if (m_random < threshold) {
+        data[range] |= (uint8_t)(m_random >> 8) | 0x80;
+      }
+    }
+  }
+}
 
-  while (!m_shutdown) {
-    struct timeval tv;
+/*
+ * Announce the fake radar and start pacing the spokes from now on.
+ */
+void EmulatorReceive::StartEmulating() {
+  NetworkAddress fake(127, 0, 0, 10, 3333);
 
-    tv.tv_sec = 0;
-    tv.tv_usec = (int)(MILLIS_PER_SELECT * 1000);
+  LOG_VERBOSE(wxT("EmulatorReceive %s starting, %d spokes of %d at %g rpm"), m_ri->m_name.c_str(), (int)m_ri->m_spokes,
+              (int)m_ri->m_spoke_len_max, M_SETTINGS.emulator_rpm);
 
-    fd_set fdin;
-    FD_ZERO(&fdin);
+  m_spokes_per_micro = M_SETTINGS.emulator_rpm * m_ri->m_spokes / 60e6;
+  m_last_tick = RadarTelemetry::Now();
+  m_ri->DetectedRadar(fake, fake);
+}
 
-    int maxFd = INVALID_SOCKET;
-    if (m_receive_socket != INVALID_SOCKET) {
-      FD_SET(m_receive_socket, &fdin);
-      maxFd = MAX(m_receive_socket, maxFd);
-    }
+/*
+ * Called every MILLIS_PER_TICK, by the reactor or by Entry().
+ */
+void EmulatorReceive::OnTick() {
+  // Pace on the clock, not on the number of wakeups, so a late wakeup
+  // or a slow batch is made up for in the next batch.
+  int64_t now = RadarTelemetry::Now();
+  m_spokes_due += (now - m_last_tick) * m_spokes_per_micro;
+  m_last_tick = now;
+  if (m_spokes_due > m_ri->m_spokes) {
+    // More than a rotation behind: the pipeline cannot keep up at this rate
+    wxCriticalSectionLocker lock(m_ri->m_receive_exclusive);
+    m_ri->m_statistics.missing_spokes += (int)(m_spokes_due - m_ri->m_spokes);
+    m_spokes_due = m_ri->m_spokes;
+  }
+  size_t spokes = (size_t)m_spokes_due;
+  if (EmulateFakeBuffer(spokes)) {
+    m_spokes_due -= spokes;
+  } else {
+    m_spokes_due = 0.;
+  }
 
-    r = select(maxFd + 1, &fdin, 0, 0, &tv);
-    if (r > 0) {
-      if (m_receive_socket != INVALID_SOCKET && FD_ISSET(m_receive_socket, &fdin)) {
-        uint8_t data[10];
-        sockaddr_in rx_addr;
-
-        socklen_t rx_len = sizeof(rx_addr);
-        r = recvfrom(m_receive_socket, (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
-        if (r > 0) {
-          LOG_VERBOSE(wxT("%s received stop instruction"), m_ri->m_name.c_str());
-          break;
-        }
+  if (m_new_rotation && m_scenario) {
+    int arpa_targets = 0;
+    int64_t arpa_refresh_micros = 0;
+    {
+      wxCriticalSectionLocker lock(m_ri->m_exclusive);
+      if (m_ri->m_arpa) {
+        arpa_targets = m_ri->m_arpa->GetTargetCount();
+        arpa_refresh_micros = m_ri->m_arpa->GetRefreshMicros();
       }
     }
+    m_scenario->WriteTruth(m_ri->m_name, arpa_targets, arpa_refresh_micros);
+  }
+  m_new_rotation = false;
+}
+
+bool EmulatorReceive::StartOnReactor() {
+  StartEmulating();
+  m_reactor->AddHandler(this, MILLIS_PER_TICK);
+  return true;
+}
+
+void EmulatorReceive::StopOnReactor() {
+  m_reactor->RemoveHandler(this);
+  LOG_VERBOSE(wxT("%s receive removed from socket reactor"), m_ri->m_name.c_str());
+}
 
-    EmulateFakeBuffer();
+/*
+ * Entry
+ *
+ * Called by wxThread when the new thread is running.
+ * It should remain running until Shutdown is called.
+ */
+void *EmulatorReceive::Entry(void) {
+  StartEmulating();
 
+  while (!m_shutdown) {
+    wxMilliSleep(MILLIS_PER_TICK);
+    OnTick();
   }  // endless loop until thread destroy
 
   LOG_VERBOSE(wxT("%s receive thread stopping"), m_ri->m_name.c_str());
   return 0;
 }
 
-// Called from the main thread to stop this thread.
-// We send a simple one byte message to the thread so that it awakens from the select() call with
-// this message ready for it to be read on 'm_receive_socket'. See the constructor in EmulatorReceive.h
-// for the setup of these two sockets.
+// Called from the main thread to stop this thread, which notices within
+// MILLIS_PER_TICK. When served by the reactor Stop() calls StopOnReactor() instead.
 
 void EmulatorReceive::Shutdown() {
   m_shutdown = true;
-  if (m_send_socket != INVALID_SOCKET) {
-    if (send(m_send_socket, "!", 1, MSG_DONTROUTE) > 0) {
-      LOG_VERBOSE(wxT("%s requested receive thread to stop"), m_ri->m_name.c_str());
-      return;
-    }
-  }
-  LOG_INFO(wxT("%s receive thread will take long time to stop"), m_ri->m_name.c_str());
+  LOG_VERBOSE(wxT("%s requested receive thread to stop"), m_ri->m_name.c_str());
 }
 
 wxString EmulatorReceive::GetInfoStatus() { return _("OK"); }
 
+void EmulatorReceive::OnTimer() {
+  if (m_scenario) {
+    m_scenario->PassOwnShipToOpenCPN();
+  }
+}
+
 PLUGIN_END_NAMESPACE
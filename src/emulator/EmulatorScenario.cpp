@@ -0,0 +1,342 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "EmulatorScenario.h"
+
+#include "RadarTelemetry.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+#define SCENARIO_BEAM_DEGREES (1.4)   // Horizontal beam width, the width of a point target
+#define SCENARIO_PULSE_SAMPLES (3.0)  // Radial extent of a point target
+#define SCENARIO_STRENGTH (240)       // Below 255, which would mark an approaching doppler target
+#define METRES_PER_DEGREE (1852. * 60.)
+#define KNOTS_TO_MS(x) ((x) * 1852. / 3600.)
+#define MS_TO_KNOTS(x) ((x) * 3600. / 1852.)
+
+EmulatorScenario::EmulatorScenario() {
+  m_started = false;
+  m_ownship_moves = false;
+  m_origin.lat = nan("");
+  m_origin.lon = nan("");
+  m_ownship_x = 0.;
+  m_ownship_y = 0.;
+  m_ownship_course = 0.;
+  m_ownship_speed = 0.;
+  m_time = 0;
+  m_spokes = 0;
+  m_dropout = 0;
+  m_clutter = -1;
+  m_random = 0x9E3779B9;
+  m_rotation = 0;
+  m_truth = 0;
+}
+
+EmulatorScenario::~EmulatorScenario() {
+  if (m_truth) {
+    fclose(m_truth);
+  }
+}
+
+/*
+ * Read the scenario file, see EmulatorScenario.h for the format.
+ * Unknown or malformed lines are logged and skipped. Only the owner
+ * simulates the own ship and writes the truth file.
+ */
+bool EmulatorScenario::Load(const wxString &filename, bool owner) {
+  FILE *f = fopen(filename.mb_str(), "r");
+  if (!f) {
+    wxLogError(wxT("Cannot read emulator scenario %s"), filename.c_str());
+    return false;
+  }
+
+  char line[512];
+  int lineno = 0;
+  while (fgets(line, sizeof(line), f)) {
+    char word[32];
+    char name[400];
+    double a, b, c, d, e = 0.;
+    unsigned int n;
+
+    lineno++;
+    if (sscanf(line, "%31s", word) != 1 || word[0] == '#') {
+      continue;
+    }
+    if (!strcmp(word, "ownship") && sscanf(line, "%*s %lf %lf %lf %lf", &a, &b, &c, &d) == 4) {
+      m_origin.lat = a;
+      m_origin.lon = b;
+      m_ownship_course = c;
+      m_ownship_speed = KNOTS_TO_MS(d);
+      m_ownship_moves = owner;
+      m_started = true;
+    } else if (!strcmp(word, "target") && sscanf(line, "%*s %lf %lf %lf %lf %lf", &a, &b, &c, &d, &e) >= 4) {
+      ScenarioTarget t;
+
+      CLEAR_STRUCT(t);
+      t.x = a * sin(deg2rad(b));
+      t.y = a * cos(deg2rad(b));
+      t.course = c;
+      t.speed = KNOTS_TO_MS(d);
+      t.size = e;
+      t.visible = true;
+      m_targets.push_back(t);
+    } else if (!strcmp(word, "random") && sscanf(line, "%*s %u %lf %lf %lf %lf", &n, &a, &b, &c, &e) >= 4) {
+      for (unsigned int i = 0; i < n; i++) {
+        ScenarioTarget t;
+        double range = Uniform(a, b);
+        double bearing = Uniform(0., 360.);
+
+        CLEAR_STRUCT(t);
+        t.x = range * sin(deg2rad(bearing));
+        t.y = range * cos(deg2rad(bearing));
+        t.course = Uniform(0., 360.);
+        t.speed = KNOTS_TO_MS(Uniform(0., c));
+        t.size = Uniform(0., e);
+        t.visible = true;
+        m_targets.push_back(t);
+      }
+    } else if (!strcmp(word, "dropout") && sscanf(line, "%*s %u", &n) == 1) {
+      m_dropout = wxMin(n, 100u);
+    } else if (!strcmp(word, "clutter") && sscanf(line, "%*s %u", &n) == 1) {
+      m_clutter = wxMin(n, 100u);
+    } else if (!strcmp(word, "seed") && sscanf(line, "%*s %u", &n) == 1) {
+      m_random = n ? n : 1;
+    } else if (!strcmp(word, "truth") && sscanf(line, "%*s %399[^\r\n]", name) == 1) {
+      if (!owner) {
+        continue;
+      }
+      if (m_truth) {
+        fclose(m_truth);
+      }
+      m_truth = fopen(name, "a");
+      if (!m_truth) {
+        wxLogError(wxT("Cannot append emulator ground truth to %s"), wxString(name, wxConvUTF8).c_str());
+      }
+    } else {
+      LOG_INFO(wxT("%s:%d: cannot parse '%s'"), filename.c_str(), lineno, wxString(line, wxConvUTF8).Trim().c_str());
+    }
+  }
+  fclose(f);
+
+  LOG_INFO(wxT("Emulator scenario %s with %d targets"), filename.c_str(), (int)m_targets.size());
+  return true;
+}
+
+// Returns true with a chance of 'percent' in a hundred
+bool EmulatorScenario::Random(uint32_t percent) {
+  m_random ^= m_random << 13;
+  m_random ^= m_random >> 17;
+  m_random ^= m_random << 5;
+  return m_random % 100 < percent;
+}
+
+double EmulatorScenario::Uniform(double low, double high) {
+  Random(0);
+  return low + (high - low) * (m_random / (double)UINT32_MAX);
+}
+
+GeoPosition EmulatorScenario::ToGeo(double x, double y) {
+  GeoPosition pos;
+
+  pos.lat = m_origin.lat + y / METRES_PER_DEGREE;
+  pos.lon = m_origin.lon + x / (METRES_PER_DEGREE * cos(deg2rad(m_origin.lat)));
+  return pos;
+}
+
+/*
+ * Move everything to time 'now'. Without a simulated own ship the scenario
+ * starts at, and then follows, the radar position that the plugin has.
+ */
+void EmulatorScenario::Advance(int64_t now, bool pos_valid, GeoPosition radar_pos) {
+  double dt = m_time ? (now - m_time) / 1e6 : 0.;
+  m_time = now;
+
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  if (m_ownship_moves) {
+    m_ownship_x += dt * m_ownship_speed * sin(deg2rad(m_ownship_course));
+    m_ownship_y += dt * m_ownship_speed * cos(deg2rad(m_ownship_course));
+  } else if (pos_valid) {
+    if (!m_started) {
+      m_origin = radar_pos;
+      m_started = true;
+      LOG_VERBOSE(wxT("Emulator scenario starts at %f, %f"), m_origin.lat, m_origin.lon);
+    }
+    m_ownship_y = (radar_pos.lat - m_origin.lat) * METRES_PER_DEGREE;
+    m_ownship_x = (radar_pos.lon - m_origin.lon) * METRES_PER_DEGREE * cos(deg2rad(m_origin.lat));
+  }
+  if (!m_started) {
+    return;
+  }
+
+  for (size_t i = 0; i < m_targets.size(); i++) {
+    ScenarioTarget &t = m_targets[i];
+
+    t.x += dt * t.speed * sin(deg2rad(t.course));
+    t.y += dt * t.speed * cos(deg2rad(t.course));
+  }
+}
+
+/*
+ * Convert every target to spoke bearing and samples for the next batch of
+ * spokes, so that RenderSpoke is only a compare per target.
+ */
+void EmulatorScenario::Prepare(size_t spokes, size_t len, int range_meters) {
+  double metres_per_sample = (double)range_meters / len;
+  double spokes_per_degree = (double)spokes / DEGREES_PER_ROTATION;
+
+  m_spokes = spokes;
+  for (size_t i = 0; i < m_targets.size(); i++) {
+    ScenarioTarget &t = m_targets[i];
+    double dx = t.x - m_ownship_x;
+    double dy = t.y - m_ownship_y;
+    double distance = sqrt(dx * dx + dy * dy);
+    double r = distance / metres_per_sample;
+    double radial = wxMax(t.size / 2. / metres_per_sample, SCENARIO_PULSE_SAMPLES / 2.);
+
+    t.bearing = MOD_DEGREES_FLOAT(rad2deg(atan2(dx, dy))) * spokes_per_degree;
+    t.half_width = wxMax(SCENARIO_BEAM_DEGREES / 2., rad2deg(atan2(t.size / 2., distance))) * spokes_per_degree;
+    if (!m_started || r - radial >= len) {
+      t.r_first = 1;
+      t.r_last = 0;
+    } else {
+      t.r_first = (size_t)wxMax(r - radial, 0.);
+      t.r_last = (size_t)wxMin(r + radial, (double)(len - 1));
+    }
+  }
+}
+
+/*
+ * Paint the targets that are visible on the spoke at true 'bearing'.
+ * Returns the number of samples painted.
+ */
+int EmulatorScenario::RenderSpoke(int bearing, uint8_t *data, size_t len) {
+  int spots = 0;
+  double half_rotation = m_spokes / 2.;
+
+  for (size_t i = 0; i < m_targets.size(); i++) {
+    const ScenarioTarget &t = m_targets[i];
+
+    if (!t.visible || t.r_first > t.r_last) {
+      continue;
+    }
+    double d = fabs(bearing - t.bearing);
+    if (d > half_rotation) {
+      d = m_spokes - d;
+    }
+    if (d <= t.half_width) {
+      memset(data + t.r_first, SCENARIO_STRENGTH, t.r_last - t.r_first + 1);
+      spots += (int)(t.r_last - t.r_first + 1);
+    }
+  }
+  return spots;
+}
+
+// Decide which targets are missed in the next rotation
+void EmulatorScenario::NewRotation() {
+  m_rotation++;
+  for (size_t i = 0; i < m_targets.size(); i++) {
+    m_targets[i].visible = !Random(m_dropout);
+  }
+}
+
+/*
+ * Append the true state of the scenario to the truth file, as one JSON line.
+ */
+void EmulatorScenario::WriteTruth(const wxString &radar, int arpa_targets, int64_t arpa_refresh_micros) {
+  if (!m_truth || !m_started) {
+    return;
+  }
+
+  GeoPosition own = ToGeo(m_ownship_x, m_ownship_y);
+  wxString line;
+
+  line << wxString::Format(wxT("{\"radar\":\"%s\",\"time\":%lld,\"rotation\":%u"), RadarTelemetry::JSONEscape(radar).c_str(),
+                           (long long)wxGetUTCTimeMillis().GetValue(), m_rotation);
+  line << wxString::Format(wxT(",\"ownship\":{\"lat\":%.7f,\"lon\":%.7f,\"course\":%.1f,\"speed\":%.2f}"), own.lat, own.lon,
+                           m_ownship_course, MS_TO_KNOTS(m_ownship_speed));
+  line << wxString::Format(wxT(",\"arpa\":{\"targets\":%d,\"refresh_us\":%lld}"), arpa_targets, (long long)arpa_refresh_micros);
+  line << wxT(",\"targets\":[");
+  for (size_t i = 0; i < m_targets.size(); i++) {
+    const ScenarioTarget &t = m_targets[i];
+    GeoPosition pos = ToGeo(t.x, t.y);
+    double dx = t.x - m_ownship_x;
+    double dy = t.y - m_ownship_y;
+
+    line << wxString::Format(wxT("%s{\"id\":%d,\"lat\":%.7f,\"lon\":%.7f,\"course\":%.1f,\"speed\":%.2f,\"size\":%.0f"),
+                             i ? wxT(",") : wxT(""), (int)i + 1, pos.lat, pos.lon, t.course, MS_TO_KNOTS(t.speed), t.size);
+    line << wxString::Format(wxT(",\"range\":%.1f,\"bearing\":%.2f,\"visible\":%s}"), sqrt(dx * dx + dy * dy),
+                             MOD_DEGREES_FLOAT(rad2deg(atan2(dx, dy))), t.visible ? wxT("true") : wxT("false"));
+  }
+  line << wxT("]}");
+
+  fprintf(m_truth, "%s\n", (const char *)line.mb_str());
+  fflush(m_truth);
+}
+
+static void PushSentence(const char *sentence) {
+  wxString nmea;
+  char checksum = 0;
+
+  for (const char *p = sentence; *p; p++) {
+    checksum ^= *p;
+  }
+  nmea.Printf(wxT("$%s*%02X\r\n"), sentence, (unsigned)checksum);
+  PushNMEABuffer(nmea);
+}
+
+/*
+ * Called on the main thread: pass the simulated own ship to OpenCPN, which
+ * hands it back to the plugin as a position fix like any GPS.
+ */
+void EmulatorScenario::PassOwnShipToOpenCPN() {
+  wxCriticalSectionLocker lock(m_exclusive);
+
+  if (!m_ownship_moves) {
+    return;
+  }
+
+  GeoPosition pos = ToGeo(m_ownship_x, m_ownship_y);
+  double lat = fabs(pos.lat);
+  double lon = fabs(pos.lon);
+  time_t now = time(0);
+  struct tm utc = *gmtime(&now);
+  char sentence[120];
+
+  snprintf(sentence, sizeof(sentence), "GPRMC,%02d%02d%02d,A,%02d%07.4f,%c,%03d%07.4f,%c,%.1f,%.1f,%02d%02d%02d,,,A", utc.tm_hour,
+           utc.tm_min, utc.tm_sec, (int)lat, (lat - (int)lat) * 60., pos.lat < 0 ? 'S' : 'N', (int)lon, (lon - (int)lon) * 60.,
+           pos.lon < 0 ? 'W' : 'E', MS_TO_KNOTS(m_ownship_speed), m_ownship_course, utc.tm_mday, utc.tm_mon + 1, utc.tm_year % 100);
+  PushSentence(sentence);
+  snprintf(sentence, sizeof(sentence), "GPHDT,%.1f,T", m_ownship_course);
+  PushSentence(sentence);
+}
+
+PLUGIN_END_NAMESPACE
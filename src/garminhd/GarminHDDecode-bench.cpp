@@ -0,0 +1,135 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+// Microbenchmark and cross check of the Garmin HD 1-bit spoke expansion: the
+// eight mask tests per byte that GarminHDReceive::ProcessFrame used before
+// against ExpandBits() from simdutil.cpp.
+//
+// Usage: garminhd-decode-bench [packets]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+// Build the expansion into this program, without the rest of the plugin
+#define PLUGIN_BEGIN_NAMESPACE namespace RadarPlugin {
+#define PLUGIN_END_NAMESPACE }
+#include "../simdutil.cpp"
+
+using namespace RadarPlugin;
+
+#define SPOKES_PER_PACKET (4)
+#define SPOKE_BYTES (252)  // GARMIN_HD_MAX_SPOKE_LEN / 8
+#define PACKETS (256)
+
+// The loop from GarminHDReceive::ProcessFrame, for a single spoke
+static size_t LegacyExpand(const uint8_t *s, uint8_t *line, size_t spoke_bytes) {
+  uint8_t *p = line;
+  for (size_t i = 0; i < spoke_bytes; i++, s++) {
+    *p++ = (*s & 0x01) > 0 ? 255 : 0;
+    *p++ = (*s & 0x02) > 0 ? 255 : 0;
+    *p++ = (*s & 0x04) > 0 ? 255 : 0;
+    *p++ = (*s & 0x08) > 0 ? 255 : 0;
+    *p++ = (*s & 0x10) > 0 ? 255 : 0;
+    *p++ = (*s & 0x20) > 0 ? 255 : 0;
+    *p++ = (*s & 0x40) > 0 ? 255 : 0;
+    *p++ = (*s & 0x80) > 0 ? 255 : 0;
+  }
+  return p - line;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char **argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 50000;
+  static const size_t spoke_lengths[] = {SPOKE_BYTES, 125, 7};  // full range, a partial one, and a tail-only one
+  int ret = 0;
+
+  if (count <= 0) {
+    fprintf(stderr, "Usage: %s [packets]\n", argv[0]);
+    return 1;
+  }
+  printf("vector instructions: %s\n", GetSimdName());
+
+  uint8_t *packets = (uint8_t *)malloc(PACKETS * SPOKES_PER_PACKET * SPOKE_BYTES);
+  uint8_t legacy[SPOKE_BYTES * 8];
+  uint8_t line[SPOKE_BYTES * 8];
+
+  srand(42);
+  for (size_t i = 0; i < PACKETS * SPOKES_PER_PACKET * SPOKE_BYTES; i++) {
+    packets[i] = rand() % 3 ? 0 : (uint8_t)rand();  // mostly empty, like real returns
+  }
+
+  for (size_t l = 0; l < sizeof(spoke_lengths) / sizeof(spoke_lengths[0]); l++) {
+    size_t spoke_bytes = spoke_lengths[l];
+    size_t len = spoke_bytes * 8;
+    double ns[2] = {0, 0};
+    int mismatches = 0;
+    volatile uint8_t sink = 0;
+
+    for (int i = 0; i < PACKETS * SPOKES_PER_PACKET; i++) {
+      const uint8_t *s = packets + i * SPOKE_BYTES;
+      LegacyExpand(s, legacy, spoke_bytes);
+      ExpandBits(s, line, spoke_bytes);
+      if (memcmp(legacy, line, len) != 0) {
+        mismatches++;
+      }
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+      Clock::time_point start = Clock::now();
+      for (int i = 0; i < count; i++) {
+        const uint8_t *packet = packets + (i % PACKETS) * SPOKES_PER_PACKET * SPOKE_BYTES;
+        for (int j = 0; j < SPOKES_PER_PACKET; j++) {
+          if (pass == 0) {
+            LegacyExpand(packet + spoke_bytes * j, legacy, spoke_bytes);
+            sink ^= legacy[(i + j) % len];
+          } else {
+            ExpandBits(packet + spoke_bytes * j, line, spoke_bytes);
+            sink ^= line[(i + j) % len];
+          }
+        }
+      }
+      ns[pass] = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() /
+                 ((double)count * SPOKES_PER_PACKET);
+    }
+
+    printf("%4zu samples: legacy %7.1f ns/spoke, new %7.1f ns/spoke, speedup %.2fx, %d mismatches\n", len, ns[0], ns[1],
+           ns[0] / ns[1], mismatches);
+    if (mismatches) {
+      ret = 1;
+    }
+  }
+  free(packets);
+  return ret;
+}
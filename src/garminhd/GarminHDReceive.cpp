@@ -32,6 +32,8 @@
 
 #include "GarminHDReceive.h"
 
+#include "simdutil.h"
+
 PLUGIN_BEGIN_NAMESPACE
 
 /*
@@ -80,17 +82,15 @@ struct radar_line {
 //
 // Note that Garmin HD only has 1 bit per point, not 8 bits like most other radars.
 //
-void GarminHDReceive::ProcessFrame(radar_line *packet) {
-  // log_line.time_rec = wxGetUTCTimeMillis();
-  wxLongLong time_rec = wxGetUTCTimeMillis();
+void GarminHDReceive::ProcessFrame(const radar_line *packet, wxLongLong time_rec) {
   time_t now = (time_t)(time_rec.GetValue() / MILLISECONDS_PER_SECOND);
-  uint8_t line[GARMIN_HD_MAX_SPOKE_LEN];
-  int i;
-  uint8_t *p, *s;
+  uint8_t spoke_buffer[GARMIN_HD_MAX_SPOKE_LEN];
+  size_t scan_length = packet->scan_length;  // The packet may be a read-only replay buffer
 
-  if (packet->scan_length * 2 > GARMIN_HD_MAX_SPOKE_LEN) {
-    LOG_INFO(wxT("%s truncating data, %d longer than expected max length %d"), packet->scan_length * 8, GARMIN_HD_MAX_SPOKE_LEN);
-    packet->scan_length = GARMIN_HD_MAX_SPOKE_LEN / 2;
+  if (scan_length * 2 > GARMIN_HD_MAX_SPOKE_LEN) {
+    LOG_INFO(wxT("%s truncating data, %d longer than expected max length %d"), m_ri->m_name.c_str(), (int)scan_length * 8,
+             GARMIN_HD_MAX_SPOKE_LEN);
+    scan_length = GARMIN_HD_MAX_SPOKE_LEN / 2;
   }
 
   int angle_raw = packet->angle * 2;
@@ -122,20 +122,18 @@ void GarminHDReceive::ProcessFrame(radar_line *packet) {
     wxLongLong startup_elapsed = wxGetUTCTimeMillis() - m_pi->GetBootMillis();
     LOG_INFO(wxT("%s first radar spoke received after %llu ms\n"), m_ri->m_name.c_str(), startup_elapsed);
   }
-  wxCriticalSectionLocker lock(m_ri->m_exclusive);
+  wxCriticalSectionLocker lock(m_ri->m_receive_exclusive);
+
+  // Each packet holds four spokes of scan_length / 4 bytes, one bit per pixel
+  size_t spoke_bytes = scan_length / 4;
+  size_t len = spoke_bytes * 8;
 
   for (int j = 0; j < 4; j++) {
-    s = &packet->line_data[packet->scan_length / 4 * j];
-    for (p = line, i = 0; i < packet->scan_length / 4; i++, s++) {
-      *p++ = (*s & 0x01) > 0 ? 255 : 0;
-      *p++ = (*s & 0x02) > 0 ? 255 : 0;
-      *p++ = (*s & 0x04) > 0 ? 255 : 0;
-      *p++ = (*s & 0x08) > 0 ? 255 : 0;
-      *p++ = (*s & 0x10) > 0 ? 255 : 0;
-      *p++ = (*s & 0x20) > 0 ? 255 : 0;
-      *p++ = (*s & 0x40) > 0 ? 255 : 0;
-      *p++ = (*s & 0x80) > 0 ? 255 : 0;
+    uint8_t *line = m_ri->ReserveRadarSpoke(len);  // Decode straight into the spoke queue
+    if (!line) {
+      line = spoke_buffer;
     }
+    ExpandBits(&packet->line_data[spoke_bytes * j], line, spoke_bytes);
 
     m_next_spoke = (spoke + 1) % GARMIN_HD_SPOKES;
 
@@ -148,7 +146,7 @@ void GarminHDReceive::ProcessFrame(radar_line *packet) {
     SpokeBearing a = MOD_SPOKES(angle_raw);
     SpokeBearing b = MOD_SPOKES(bearing_raw);
 
-    m_ri->ProcessRadarSpoke(a, b, line, p - line, packet->display_meters, time_rec);
+    m_ri->QueueRadarSpoke(a, b, line, len, packet->display_meters, time_rec);
 
     angle_raw++;
     spoke++;
@@ -230,6 +228,10 @@ SOCKET GarminHDReceive::GetNewReportSocket() {
   error = wxT("");
   socket = startUDPMulticastReceiveSocket(m_interface_addr, m_report_addr, error);
   if (socket != INVALID_SOCKET) {
+    if (m_pi->m_settings.kernel_timestamps && !socketEnableTimestamps(socket)) {
+      LOG_INFO(wxT("%s cannot enable receive timestamps on report socket"), m_ri->m_name.c_str());
+    }
+    socketEnableDropCounter(socket);
     wxString addr = m_interface_addr.FormatNetworkAddress();
     wxString rep_addr = m_report_addr.FormatNetworkAddressPort();
 
@@ -312,14 +314,19 @@ void *GarminHDReceive::Entry(void) {
       }
 
       if (reportSocket != INVALID_SOCKET && FD_ISSET(reportSocket, &fdin)) {
+        wxLongLong time_rec;
+        uint32_t drops;
         rx_len = sizeof(rx_addr);
-        r = recvfrom(reportSocket, (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
+        r = socketReceive(reportSocket, data, sizeof(data), (struct sockaddr *)&rx_addr, &rx_len, &time_rec, &drops);
         if (r > 0) {
           NetworkAddress radar_address;
           radar_address.addr = rx_addr.ipv4.sin_addr;
           radar_address.port = rx_addr.ipv4.sin_port;
 
-          if (ProcessReport(data, (size_t)r)) {
+          int64_t start = RadarTelemetry::Now();
+          bool valid = ProcessReport(data, (size_t)r, time_rec, radar_address);
+          m_ri->m_telemetry.AddFrame((size_t)r, start, drops);
+          if (valid) {
             if (!radar_addr) {
               wxCriticalSectionLocker lock(m_lock);
               m_ri->DetectedRadar(m_interface_addr, radar_address);  // enables transmit data
@@ -378,6 +385,7 @@ void *GarminHDReceive::Entry(void) {
   }
   if (m_receive_socket != INVALID_SOCKET) {
     closesocket(m_receive_socket);
+    m_receive_socket = INVALID_SOCKET;
   }
 
   if (m_interface_array) {
@@ -489,7 +497,7 @@ bool GarminHDReceive::UpdateScannerStatus(int status) {
   return ret;
 }
 
-bool GarminHDReceive::ProcessReport(const uint8_t *report, size_t len) {
+bool GarminHDReceive::ProcessReport(const uint8_t *report, size_t len, wxLongLong time_rec, const NetworkAddress &source) {
   LOG_BINARY_REPORTS(wxString::Format(wxT("%s report"), m_ri->m_name.c_str()), report, len);
 
   time_t now = time(0);
@@ -502,9 +510,10 @@ bool GarminHDReceive::ProcessReport(const uint8_t *report, size_t len) {
 
     switch (packet_type) {
       case 0x2a3: {
-        radar_line *line = (radar_line *)report;
+        const radar_line *line = (const radar_line *)report;
 
-        ProcessFrame(line);
+        m_ri->CaptureFrame(report, len, time_rec, source);
+        ProcessFrame(line, time_rec);
         m_no_spoke_timeout = -5;
         return true;
       }
@@ -74,14 +74,14 @@ struct radar_line {
 // Process one radar line, which contains exactly one line or spoke of data extending outwards
 // from the radar up to the range indicated in the packet.
 //
-void GarminxHDReceive::ProcessFrame(const uint8_t *data, size_t len) {
-  // log_line.time_rec = wxGetUTCTimeMillis();
-  wxLongLong time_rec = wxGetUTCTimeMillis();
+void GarminxHDReceive::ProcessFrame(const uint8_t *data, size_t len, wxLongLong time_rec, const NetworkAddress &source) {
   time_t now = (time_t)(time_rec.GetValue() / MILLISECONDS_PER_SECOND);
 
+  m_ri->CaptureFrame(data, len, time_rec, source);
+
   radar_line *packet = (radar_line *)data;
 
-  wxCriticalSectionLocker lock(m_ri->m_exclusive);
+  wxCriticalSectionLocker lock(m_ri->m_receive_exclusive);
 
   m_ri->m_radar_timeout = now + WATCHDOG_TIMEOUT;
   m_ri->m_data_timeout = now + DATA_TIMEOUT;
@@ -125,7 +125,7 @@ void GarminxHDReceive::ProcessFrame(const uint8_t *data, size_t len) {
   SpokeBearing b = MOD_SPOKES(bearing_raw);
 
   m_ri->m_range.Update(packet->range_meters);
-  m_ri->ProcessRadarSpoke(a, b, packet->line_data, len, packet->display_meters, time_rec);
+  m_ri->QueueRadarSpoke(a, b, packet->line_data, len, packet->display_meters, time_rec);
 }
 
 // Check that this interface is valid for
@@ -229,6 +229,10 @@ SOCKET GarminxHDReceive::GetNewDataSocket() {
   error.Printf(wxT("%s data: "), m_ri->m_name.c_str());
   socket = startUDPMulticastReceiveSocket(m_interface_addr, m_data_addr, error);
   if (socket != INVALID_SOCKET) {
+    if (m_pi->m_settings.kernel_timestamps && !socketEnableTimestamps(socket)) {
+      LOG_INFO(wxT("%s cannot enable receive timestamps on data socket"), m_ri->m_name.c_str());
+    }
+    socketEnableDropCounter(socket);
     wxString addr = m_interface_addr.FormatNetworkAddress();
     wxString rep_addr = m_data_addr.FormatNetworkAddressPort();
 
@@ -327,10 +331,18 @@ void *GarminxHDReceive::Entry(void) {
       }
 
       if (dataSocket != INVALID_SOCKET && FD_ISSET(dataSocket, &fdin)) {
+        wxLongLong time_rec;
+        uint32_t drops;
         rx_len = sizeof(rx_addr);
-        r = recvfrom(dataSocket, (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
+        r = socketReceive(dataSocket, data, sizeof(data), (struct sockaddr *)&rx_addr, &rx_len, &time_rec, &drops);
         if (r > 0) {
-          ProcessFrame(data, (size_t)r);
+          NetworkAddress source;
+          source.addr = rx_addr.ipv4.sin_addr;
+          source.port = rx_addr.ipv4.sin_port;
+
+          int64_t start = RadarTelemetry::Now();
+          ProcessFrame(data, (size_t)r, time_rec, source);
+          m_ri->m_telemetry.AddFrame((size_t)r, start, drops);
           no_data_timeout = -15;
           no_spoke_timeout = -5;
         } else {
@@ -418,6 +430,7 @@ void *GarminxHDReceive::Entry(void) {
   }
   if (m_receive_socket != INVALID_SOCKET) {
     closesocket(m_receive_socket);
+    m_receive_socket = INVALID_SOCKET;
   }
 
   if (m_interface_array) {
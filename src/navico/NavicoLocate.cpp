@@ -53,6 +53,9 @@ void NavicoLocate::CleanupCards() {
   if (m_socket) {
     for (size_t i = 0; i < m_interface_count; i++) {
       if (m_socket[i] != INVALID_SOCKET) {
+        if (m_reactor) {
+          m_reactor->Remove(m_socket[i]);
+        }
         closesocket(m_socket[i]);
       }
     }
@@ -102,6 +105,13 @@ void NavicoLocate::UpdateEthernetCards() {
           i++;
         }
       }
+
+      // Only now that the arrays are complete can OnReadable be called
+      for (i = 0; m_reactor && i < m_interface_count; i++) {
+        if (m_socket[i] != INVALID_SOCKET) {
+          m_reactor->Add(m_socket[i], this);
+        }
+      }
     }
 
     freeifaddrs(addr_list);
@@ -112,6 +122,41 @@ void NavicoLocate::UpdateEthernetCards() {
   WakeRadar();
 }
 
+/*
+ * Start
+ *
+ * Start listening, either by adding the sockets to the reactor or by
+ * starting our own thread.
+ */
+bool NavicoLocate::Start() {
+  if (m_reactor) {
+    m_is_shutdown = false;
+    UpdateEthernetCards();
+    m_reactor->AddHandler(this);
+    LOG_VERBOSE(wxT("NavicoLocate added to socket reactor"));
+    return true;
+  }
+
+  if (Create(64 * 1024) != wxTHREAD_NO_ERROR) {
+    return false;
+  }
+  SetPriority(wxPRIORITY_MAX);
+  LOG_INFO(wxT("NavicoLocate thread created, prio= %i"), GetPriority());
+  return Run() == wxTHREAD_NO_ERROR;
+}
+
+void NavicoLocate::Stop() {
+  if (m_reactor) {
+    m_reactor->RemoveHandler(this);
+    CleanupCards();
+    m_is_shutdown = true;
+    return;
+  }
+
+  Shutdown();
+  Wait();
+}
+
 /*
  * Entry
  *
@@ -120,15 +165,6 @@ void NavicoLocate::UpdateEthernetCards() {
  */
 void *NavicoLocate::Entry(void) {
   int r = 0;
-  int rescan_network_cards = 0;
-  int wake_timeout = 0;
-  union {
-    sockaddr_storage addr;
-    sockaddr_in ipv4;
-  } rx_addr;
-  socklen_t rx_len;
-
-  uint8_t data[1500];
 
   LOG_VERBOSE(wxT("NavicoLocate thread starting"));
 
@@ -153,37 +189,16 @@ void *NavicoLocate::Entry(void) {
     r = select(maxFd + 1, &fdin, 0, 0, &tv);
     if (r <= 0 && errno != 0) {
       UpdateEthernetCards();
-      rescan_network_cards = 0;
+      m_rescan_network_cards = 0;
     }
     if (r > 0) {
       for (size_t i = 0; i < m_interface_count; i++) {
         if (m_socket[i] != INVALID_SOCKET && FD_ISSET(m_socket[i], &fdin)) {
-          rx_len = sizeof(rx_addr);
-          r = recvfrom(m_socket[i], (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
-          LOG_RECEIVE(wxT("read %d bytes from socket %d"), r, m_socket[i]);
-          if (r > 2) {  // we are not interested in 2 byte messages
-            NetworkAddress radar_address;
-            radar_address.addr = rx_addr.ipv4.sin_addr;
-            radar_address.port = rx_addr.ipv4.sin_port;
-
-            if (ProcessReport(radar_address, m_interface_addr[i], data, (size_t)r)) {
-              rescan_network_cards = -PERIOD_UNTIL_CARD_REFRESH;  // Give double time until we rescan
-              wake_timeout = -PERIOD_UNTIL_WAKE_RADAR;
-            }
-          }
+          ReceiveReport(i);
         }
       }
     } else {  // no data received -> select timeout
-      if (++rescan_network_cards >= PERIOD_UNTIL_CARD_REFRESH) {
-        UpdateEthernetCards();
-        rescan_network_cards = 0;
-        wake_timeout = PERIOD_UNTIL_WAKE_RADAR - 2;  // Wake radar soon, but not immediately
-      }
-
-      if (++wake_timeout >= PERIOD_UNTIL_WAKE_RADAR) {
-        WakeRadar();
-        wake_timeout = 0;
-      }
+      OnTick();
     }
 
   }  // endless loop until thread destroy
@@ -195,6 +210,53 @@ void *NavicoLocate::Entry(void) {
   return 0;
 }
 
+void NavicoLocate::OnReadable(SOCKET socket) {
+  for (size_t i = 0; i < m_interface_count; i++) {
+    if (m_socket[i] == socket) {
+      ReceiveReport(i);
+      return;
+    }
+  }
+}
+
+/*
+ * Called once a second without reports by Entry, or every second by the reactor.
+ */
+void NavicoLocate::OnTick() {
+  if (++m_rescan_network_cards >= PERIOD_UNTIL_CARD_REFRESH) {
+    UpdateEthernetCards();
+    m_rescan_network_cards = 0;
+    m_wake_timeout = PERIOD_UNTIL_WAKE_RADAR - 2;  // Wake radar soon, but not immediately
+  }
+
+  if (++m_wake_timeout >= PERIOD_UNTIL_WAKE_RADAR) {
+    WakeRadar();
+    m_wake_timeout = 0;
+  }
+}
+
+void NavicoLocate::ReceiveReport(size_t i) {
+  union {
+    sockaddr_storage addr;
+    sockaddr_in ipv4;
+  } rx_addr;
+  socklen_t rx_len = sizeof(rx_addr);
+  uint8_t data[1500];
+
+  int r = recvfrom(m_socket[i], (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
+  LOG_RECEIVE(wxT("read %d bytes from socket %d"), r, m_socket[i]);
+  if (r > 2) {  // we are not interested in 2 byte messages
+    NetworkAddress radar_address;
+    radar_address.addr = rx_addr.ipv4.sin_addr;
+    radar_address.port = rx_addr.ipv4.sin_port;
+
+    if (ProcessReport(radar_address, m_interface_addr[i], data, (size_t)r)) {
+      m_rescan_network_cards = -PERIOD_UNTIL_CARD_REFRESH;  // Give double time until we rescan
+      m_wake_timeout = -PERIOD_UNTIL_WAKE_RADAR;
+    }
+  }
+}
+
 /*
  RADAR REPORTS
 
@@ -34,6 +34,12 @@
 
 #include "MessageBox.h"
 #include "NavicoControl.h"
+#include "NavicoFrame.h"
+#include "simdutil.h"
+
+#ifdef __linux__
+#include <sys/socket.h>  // recvmmsg()
+#endif
 
 PLUGIN_BEGIN_NAMESPACE
 
@@ -142,65 +148,11 @@ struct halo_speed_packet {
   uint8_t  u03;        // 00
  };
 
-#define SCAN_MAX (256)
-
-struct common_header {
-  uint8_t headerLen;    // 1 bytes
-  uint8_t status;       // 1 bytes
-  uint8_t scan_number;  // 1 byte
-  uint8_t u00[1];       // 1 byte, 2nd byte of scan_number on 4G and older
-  uint8_t u01[4];       // 4 bytes
-  uint8_t angle[2];     // 2 bytes
-  uint8_t heading[2];   // 2 bytes heading with RI-10/11. See bitmask explanation above.
-};
-
-struct br24_header {
-  uint8_t headerLen;       // 1 bytes
-  uint8_t status;          // 1 bytes
-  uint8_t scan_number[2];  // 2 bytes, 0-4095
-  uint8_t mark[4];         // 4 bytes 0x00, 0x44, 0x0d, 0x0e
-  uint8_t angle[2];        // 2 bytes
-  uint8_t heading[2];      // 2 bytes heading with RI-10/11. See bitmask explanation above.
-  uint8_t range[4];        // 4 bytes
-  uint8_t u01[2];          // 2 bytes blank
-  uint8_t u02[2];          // 2 bytes
-  uint8_t u03[4];          // 4 bytes blank
-}; /* total size = 24 */
-
-struct br4g_header {
-  uint8_t headerLen;       // 1 bytes
-  uint8_t status;          // 1 bytes
-  uint8_t scan_number[2];  // 2 bytes, 0-4095
-  uint8_t u00[2];          // Always 0x4400 (integer)
-  uint8_t largerange[2];   // 2 bytes or -1
-  uint8_t angle[2];        // 2 bytes
-  uint8_t heading[2];      // 2 bytes heading with RI-10/11 or -1. See bitmask explanation above.
-  uint8_t smallrange[2];   // 2 bytes or -1
-  uint8_t rotation[2];     // 2 bytes, rotation/angle
-  uint8_t u02[4];          // 4 bytes signed integer, always -1
-  uint8_t u03[4];          // 4 bytes signed integer, mostly -1 (0x80 in last byte) or 0xa0 in last byte
-}; /* total size = 24 */
-
-struct radar_line {
-  union {
-    common_header common;
-    br24_header br24;
-    br4g_header br4g;
-  };
-  uint8_t data[NAVICO_SPOKE_LEN / 2];
-};
-
-/* Normally the packets are have 32 spokes, or scan lines, but we assume nothing
- * so we take up to 120 spokes. This is the nearest round figure without going over
- * 64kB.
- */
-
-struct radar_frame_pkt {
-  uint8_t frame_hdr[8];
-  radar_line line[120];  //  scan lines, or spokes
-};
 #pragma pack(pop)
 
+#define SCAN_MAX (256)  // common_header.scan_number wraps at this
+#define SCAN_LATE_MAX (SCAN_MAX / 4)  // A frame up to this far behind is late or a duplicate
+
 enum LookupSpokeEnum {
   LOOKUP_SPOKE_LOW_NORMAL,
   LOOKUP_SPOKE_LOW_BOTH,
@@ -212,25 +164,10 @@ enum LookupSpokeEnum {
 
 static uint8_t lookupData[6][256];
 
-// Make space for BLOB_HISTORY_COLORS
-static const uint8_t lookupNibbleToByte[16] = {
-    0,     // 0
-    0x32,  // 1
-    0x40,  // 2
-    0x4e,  // 3
-    0x5c,  // 4
-    0x6a,  // 5
-    0x78,  // 6
-    0x86,  // 7
-    0x94,  // 8
-    0xa2,  // 9
-    0xb0,  // a
-    0xbe,  // b
-    0xcc,  // c
-    0xda,  // d
-    0xe8,  // e
-    0xf4,  // f
-};
+// The same mapping per nibble, for ExpandNibbles(). Indexed by doppler mode,
+// like LOOKUP_SPOKE_LOW_NORMAL + doppler.
+static uint8_t lookupNibble[3][16];
+static bool lookupNibbleVerified = false;
 
 void NavicoReceive::InitializeLookupData() {
   if (lookupData[5][255] == 0) {
@@ -273,6 +210,33 @@ void NavicoReceive::InitializeLookupData() {
           lookupData[LOOKUP_SPOKE_HIGH_APPROACHING][j] = (uint8_t)high;
       }
     }
+
+    // Every low nibble value occurs in j = 0..15, so the nibble tables are just
+    // the first 16 entries of the byte tables.
+    for (int doppler = 0; doppler < 3; doppler++) {
+      memcpy(lookupNibble[doppler], lookupData[LOOKUP_SPOKE_LOW_NORMAL + doppler], sizeof(lookupNibble[doppler]));
+    }
+
+    // Only use the vector expansion if it gives exactly the same result as the tables.
+    uint8_t all_bytes[UINT8_MAX + 1];
+    uint8_t expanded[2 * (UINT8_MAX + 1)];
+    for (int j = 0; j <= UINT8_MAX; j++) {
+      all_bytes[j] = (uint8_t)j;
+    }
+    bool verified = true;
+    for (int doppler = 0; doppler < 3; doppler++) {
+      ExpandNibbles(lookupNibble[doppler], all_bytes, expanded, sizeof(all_bytes));
+      for (int j = 0; j <= UINT8_MAX; j++) {
+        if (expanded[2 * j] != lookupData[LOOKUP_SPOKE_LOW_NORMAL + doppler][j] ||
+            expanded[2 * j + 1] != lookupData[LOOKUP_SPOKE_HIGH_NORMAL + doppler][j]) {
+          verified = false;
+        }
+      }
+    }
+    if (!verified) {
+      wxLogError(wxT("Navico %s nibble expansion does not match lookup tables, not used"), GetSimdName());
+    }
+    lookupNibbleVerified = verified;
   }
 }
 
@@ -281,15 +245,14 @@ void NavicoReceive::InitializeLookupData() {
 // Process one radar frame packet, which can contain up to 32 'spokes' or lines extending outwards
 // from the radar up to the range indicated in the packet.
 //
-void NavicoReceive::ProcessFrame(const uint8_t *data, size_t len) {
+void NavicoReceive::ProcessFrame(const uint8_t *data, size_t len, wxLongLong time_rec, const NetworkAddress &source) {
   time_t now = time(0);
 
-  // log_line.time_rec = wxGetUTCTimeMillis();
-  wxLongLong time_rec = wxGetUTCTimeMillis();
+  m_ri->CaptureFrame(data, len, time_rec, source);
 
   radar_frame_pkt *packet = (radar_frame_pkt *)data;
 
-  wxCriticalSectionLocker lock(m_ri->m_exclusive);
+  wxCriticalSectionLocker lock(m_ri->m_receive_exclusive);
 
   m_ri->m_radar_timeout = now + WATCHDOG_TIMEOUT;
   m_ri->m_data_timeout = now + DATA_TIMEOUT;
@@ -309,7 +272,8 @@ void NavicoReceive::ProcessFrame(const uint8_t *data, size_t len) {
   if (m_first_receive) {
     m_first_receive = false;
     wxLongLong startup_elapsed = wxGetUTCTimeMillis() - m_pi->GetBootMillis();
-    LOG_INFO(wxT("%s first radar spoke received after %llu ms\n"), m_ri->m_name.c_str(), startup_elapsed);
+    LOG_INFO(wxT("%s first radar spoke received after %llu ms (report sockets %llu ms via %s, first report %llu ms)\n"),
+             m_ri->m_name.c_str(), startup_elapsed, m_sockets_open_elapsed, m_discovery_via.c_str(), m_first_report_elapsed);
   }
 
   for (size_t scanline = 0; scanline < scanlines_in_packet; scanline++) {
@@ -426,56 +390,170 @@ void NavicoReceive::ProcessFrame(const uint8_t *data, size_t len) {
     SpokeBearing a = MOD_SPOKES(angle_raw / 2);    // divide by 2 to map on 2048 scanlines
     SpokeBearing b = MOD_SPOKES(bearing_raw / 2);  // divide by 2 to map on 2048 scanlines
     size_t len = NAVICO_SPOKE_LEN;
-    uint8_t data_highres[NAVICO_SPOKE_LEN];
+    uint8_t spoke_buffer[NAVICO_SPOKE_LEN];
+    uint8_t *data_highres = m_ri->ReserveRadarSpoke(len);  // Decode straight into the spoke queue
+    if (!data_highres) {
+      data_highres = spoke_buffer;
+    }
 
     int doppler = m_ri->m_doppler.GetValue();
     if (doppler < 0 || doppler > 2) {
       doppler = 0;
     }
-    uint8_t *lookup_low = lookupData[LOOKUP_SPOKE_LOW_NORMAL + doppler];
-    uint8_t *lookup_high = lookupData[LOOKUP_SPOKE_HIGH_NORMAL + doppler];
-    for (int i = 0; i < NAVICO_SPOKE_LEN / 2; i++) {
-      data_highres[2 * i] = lookup_low[line->data[i]];
-      data_highres[2 * i + 1] = lookup_high[line->data[i]];
+    if (lookupNibbleVerified) {
+      ExpandNibbles(lookupNibble[doppler], line->data, data_highres, NAVICO_SPOKE_LEN / 2);
+    } else {
+      uint8_t *lookup_low = lookupData[LOOKUP_SPOKE_LOW_NORMAL + doppler];
+      uint8_t *lookup_high = lookupData[LOOKUP_SPOKE_HIGH_NORMAL + doppler];
+      for (int i = 0; i < NAVICO_SPOKE_LEN / 2; i++) {
+        data_highres[2 * i] = lookup_low[line->data[i]];
+        data_highres[2 * i + 1] = lookup_high[line->data[i]];
+      }
     }
-    m_ri->ProcessRadarSpoke(a, b, data_highres, len, range_meters, time_rec);
+    m_ri->QueueRadarSpoke(a, b, data_highres, len, range_meters, time_rec);
   }
 }
 
-SOCKET NavicoReceive::PickNextEthernetCard() {
-  SOCKET socket = INVALID_SOCKET;
+/*
+ * Listen for reports on every ethernet card at once, instead of trying them
+ * one after the other. The first card that sees a report wins, see
+ * AdoptProbeSocket. Returns the number of cards that are probed.
+ */
+size_t NavicoReceive::OpenProbeSockets() {
+  struct ifaddrs *addr_list;
+  struct ifaddrs *addr;
+  RadarLocationInfo current_info = m_ri->GetRadarLocationInfo();
+
+  m_info = current_info;
   m_interface_addr = NetworkAddress();
 
-  // Pick the next ethernet card
-  // If set, we used this one last time. Go to the next card.
-  if (m_interface) {
-    m_interface = m_interface->ifa_next;
-  }
-  // Loop until card with a valid IPv4 address
-  while (m_interface && !VALID_IPV4_ADDRESS(m_interface)) {
-    m_interface = m_interface->ifa_next;
+  if (m_info.report_addr.IsNull()) {
+    LOG_RECEIVE(wxT("%s no report address to listen on"), m_ri->m_name.c_str());
+    Backoff();
+    return 0;
   }
-  if (!m_interface) {
-    if (m_interface_array) {
-      freeifaddrs(m_interface_array);
-      m_interface_array = 0;
-    }
-    if (!getifaddrs(&m_interface_array)) {
-      m_interface = m_interface_array;
-    }
-    // Loop until card with a valid IPv4 address
-    while (m_interface && !VALID_IPV4_ADDRESS(m_interface)) {
-      m_interface = m_interface->ifa_next;
+
+  if (!getifaddrs(&addr_list)) {
+    for (addr = addr_list; addr && m_probes < NAVICO_MAX_PROBES; addr = addr->ifa_next) {
+      if (VALID_IPV4_ADDRESS(addr)) {
+        NetworkAddress interface_addr;
+        wxString error;
+
+        interface_addr.addr = ((struct sockaddr_in *)addr->ifa_addr)->sin_addr;
+        interface_addr.port = 0;
+        SOCKET socket = startUDPMulticastReceiveSocket(interface_addr, m_info.report_addr, error);
+        if (socket != INVALID_SOCKET) {
+          WatchSocket(socket);
+          m_probe_socket[m_probes] = socket;
+          m_probe_addr[m_probes] = interface_addr;
+          m_probe_netmask[m_probes] = addr->ifa_netmask ? ((struct sockaddr_in *)addr->ifa_netmask)->sin_addr.s_addr : 0;
+          m_probes++;
+        } else {
+          LOG_RECEIVE(wxT("%s cannot probe interface %s: %s"), m_ri->m_name.c_str(), interface_addr.FormatNetworkAddress(),
+                      error.c_str());
+        }
+      }
     }
+    freeifaddrs(addr_list);
+  }
+
+  if (m_probes == 0) {
+    SetInfoStatus(wxString::Format(wxT("%s: %s"), m_ri->m_name.c_str(), _("No usable ethernet cards")));
+    Backoff();
+    return 0;
   }
-  if (m_interface && VALID_IPV4_ADDRESS(m_interface)) {
-    m_interface_addr.addr = ((struct sockaddr_in *)m_interface->ifa_addr)->sin_addr;
-    m_interface_addr.port = 0;
+
+  LOG_RECEIVE(wxT("%s probing %d interfaces for reports from %s"), m_ri->m_name.c_str(), (int)m_probes,
+              m_info.report_addr.FormatNetworkAddressPort());
+  SetInfoStatus(wxString::Format(wxT("%s %d %s"), _("Scanning"), (int)m_probes, _("interfaces")));
+  m_discovery_via = wxString::Format(wxT("scan of %d interfaces"), (int)m_probes);
+  m_sockets_open_elapsed = DiscoveryPhase(wxT("report sockets open via ") + m_discovery_via);
+  return m_probes;
+}
+
+/*
+ * A report arrived on probe socket i from radar_address. Keep the socket on the
+ * card that is in the same subnet as the radar and close the others.
+ *
+ * Most stacks deliver multicast on all sockets that joined the group,
+ * whichever card it arrived on, so the socket that became readable is only
+ * used when no card matches.
+ */
+SOCKET NavicoReceive::AdoptProbeSocket(size_t i, const NetworkAddress &radar_address) {
+  size_t chosen = i;
+  SOCKET socket;
+
+  for (size_t j = 0; j < m_probes; j++) {
+    uint32_t mask = m_probe_netmask[j];
+    if (mask != 0 && (radar_address.addr.s_addr & mask) == (m_probe_addr[j].addr.s_addr & mask)) {
+      chosen = j;
+      break;
+    }
   }
-  socket = GetNewReportSocket();
+
+  socket = m_probe_socket[chosen];
+  m_interface_addr = m_probe_addr[chosen];
+  m_probe_socket[chosen] = INVALID_SOCKET;
+  CloseProbeSockets();
+
+  LOG_INFO(wxT("%s radar %s reports on interface %s"), m_ri->m_name.c_str(), radar_address.FormatNetworkAddress(),
+           m_interface_addr.FormatNetworkAddress());
+  SetInfoStatus(wxString::Format(wxT("%s %s"), _("Scanning interface"), m_interface_addr.FormatNetworkAddress()));
   return socket;
 }
 
+/*
+ * Wait a little before trying to open sockets again, so the log doesn't grow
+ * too large. The reactor thread must not sleep, so there the next attempts
+ * are skipped instead.
+ */
+void NavicoReceive::Backoff() {
+  if (m_reactor) {
+    m_retry_after = wxGetUTCTimeMillis() + 200;
+  } else {
+    wxMilliSleep(200);
+  }
+}
+
+void NavicoReceive::CloseProbeSockets() {
+  for (size_t i = 0; i < m_probes; i++) {
+    CloseSocket(m_probe_socket[i]);
+  }
+  m_probes = 0;
+}
+
+/*
+ * Return how long it took since the plugin started to get to this discovery
+ * phase. Each phase is logged once until the first spoke arrives, after that
+ * it's just noise. While no radar answers the sockets are reopened every few
+ * seconds, and those repeats are only logged at the receive log level.
+ */
+wxLongLong NavicoReceive::DiscoveryPhase(const wxString &phase) {
+  wxLongLong elapsed = wxGetUTCTimeMillis() - m_pi->GetBootMillis();
+
+  if (m_first_receive && m_discovery_logged.Index(phase) == wxNOT_FOUND) {
+    m_discovery_logged.Add(phase);
+    LOG_INFO(wxT("%s %s after %llu ms"), m_ri->m_name.c_str(), phase.c_str(), elapsed);
+  } else {
+    LOG_RECEIVE(wxT("%s %s after %llu ms"), m_ri->m_name.c_str(), phase.c_str(), elapsed);
+  }
+  return elapsed;
+}
+
+/*
+ * Listen for reports on the interface where the radar was found last time,
+ * if there is one.
+ */
+void NavicoReceive::OpenCachedReportSocket() {
+  m_interface_addr = m_ri->GetRadarInterfaceAddress();
+  m_report_socket = GetNewReportSocket();
+  if (m_report_socket != INVALID_SOCKET) {
+    WatchSocket(m_report_socket);
+    m_discovery_via = wxT("cached interface ") + m_interface_addr.FormatNetworkAddress();
+    m_sockets_open_elapsed = DiscoveryPhase(wxT("report socket open via ") + m_discovery_via);
+  }
+}
+
 SOCKET NavicoReceive::GetNewReportSocket() {
   SOCKET socket;
   wxString error = wxT(" ");
@@ -491,12 +569,12 @@ SOCKET NavicoReceive::GetNewReportSocket() {
 
   if (m_interface_addr.IsNull()) {
     LOG_RECEIVE(wxT("%s no interface address to listen on"), m_ri->m_name.c_str());
-    wxMilliSleep(200);  // don't make the log too large
+    Backoff();
     return INVALID_SOCKET;
   }
   if (m_info.report_addr.IsNull()) {
     LOG_RECEIVE(wxT("%s no report address to listen on"), m_ri->m_name.c_str());
-    wxMilliSleep(200);
+    Backoff();
     return INVALID_SOCKET;
   }
 
@@ -535,6 +613,10 @@ SOCKET NavicoReceive::GetNewDataSocket() {
   error.Printf(wxT("%s data: "), m_ri->m_name.c_str());
   socket = startUDPMulticastReceiveSocket(m_interface_addr, m_info.spoke_data_addr, error);
   if (socket != INVALID_SOCKET) {
+    if (m_pi->m_settings.kernel_timestamps && !socketEnableTimestamps(socket)) {
+      LOG_INFO(wxT("%s cannot enable receive timestamps on data socket"), m_ri->m_name.c_str());
+    }
+    socketEnableDropCounter(socket);
     wxString addr = m_interface_addr.FormatNetworkAddress();
     wxString rep_addr = m_info.spoke_data_addr.FormatNetworkAddressPort();
 
@@ -586,8 +668,8 @@ SOCKET NavicoReceive::GetNewInfoSocket() {
 
 void NavicoReceive::ReleaseInfoSocket(void) {
   wxCriticalSectionLocker lock(g_HaloInfoSocketLock);
-  if (g_HaloInfoSocket != INVALID_SOCKET) {
-    closesocket(g_HaloInfoSocket);
+  if (m_info_socket != INVALID_SOCKET) {
+    CloseSocket(m_info_socket);
     g_HaloInfoSocket = INVALID_SOCKET;
   }
 }
@@ -683,64 +765,595 @@ void NavicoReceive::SendSpeedPacket() {
 }
 
 /*
- * Entry
+ * Receive all frames that are waiting on the data socket and pass them to ProcessFrame().
  *
- * Called by wxThread when the new thread is running.
- * It should remain running until Shutdown is called.
+ * On Linux up to NAVICO_RECEIVE_BATCH frames are fetched with a single recvmmsg() call, which
+ * saves a select() plus recvfrom() per frame on radars that send a continuous stream of frames.
+ * Elsewhere we receive a single frame per wakeup into `data`, as before.
+ * Either way each frame is stamped with its kernel receive time when the socket has that enabled.
+ *
+ * Returns the number of frames processed, 0 when nothing was waiting after all, or -1 on a
+ * socket error.
  */
-void *NavicoReceive::Entry(void) {
-  int r = 0;
-  int no_data_timeout = 0;
-  int no_spoke_timeout = 0;
+int NavicoReceive::ReceiveDataFrames(SOCKET dataSocket, uint8_t *data, size_t len) {
+  int frames = 0;
+
+#ifdef __linux__
+  struct mmsghdr msgs[NAVICO_RECEIVE_BATCH];
+  struct iovec iovecs[NAVICO_RECEIVE_BATCH];
+  struct sockaddr_in from[NAVICO_RECEIVE_BATCH];
+  SocketControl control[NAVICO_RECEIVE_BATCH];
+
+  if (!m_batch_data) {
+    m_batch_data = (uint8_t *)malloc(NAVICO_RECEIVE_BATCH * sizeof(radar_frame_pkt));
+  }
+  if (m_batch_data) {
+    CLEAR_STRUCT(msgs);
+    for (int i = 0; i < NAVICO_RECEIVE_BATCH; i++) {
+      iovecs[i].iov_base = m_batch_data + i * sizeof(radar_frame_pkt);
+      iovecs[i].iov_len = sizeof(radar_frame_pkt);
+      msgs[i].msg_hdr.msg_name = &from[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+      msgs[i].msg_hdr.msg_iov = &iovecs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_control = control[i].buf;
+      msgs[i].msg_hdr.msg_controllen = sizeof(control[i].buf);
+    }
+
+    int r = recvmmsg(dataSocket, msgs, NAVICO_RECEIVE_BATCH, MSG_DONTWAIT, 0);
+    if (r < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+        return 0;
+      }
+      return -1;
+    }
+    wxLongLong now = 0;
+    for (int i = 0; i < r; i++) {
+      if (msgs[i].msg_len > 0) {
+        wxLongLong time_rec;
+        uint32_t drops;
+        if (!socketMessageInfo(&msgs[i].msg_hdr, &time_rec, &drops)) {
+          if (now == 0) {
+            now = wxGetUTCTimeMillis();
+          }
+          time_rec = now;
+        }
+        NetworkAddress source;
+        source.addr = from[i].sin_addr;
+        source.port = from[i].sin_port;
+
+        int64_t start = RadarTelemetry::Now();
+        ReorderFrame((uint8_t *)iovecs[i].iov_base, (size_t)msgs[i].msg_len, time_rec, source);
+        m_ri->m_telemetry.AddFrame((size_t)msgs[i].msg_len, start, drops);
+        frames++;
+      }
+    }
+  } else
+#endif
+  {
+    wxLongLong time_rec;
+    uint32_t drops;
+    struct sockaddr_in from;
+    socklen_t from_len = sizeof(from);
+    int r = socketReceive(dataSocket, data, len, (struct sockaddr *)&from, &from_len, &time_rec, &drops);
+    if (r <= 0) {
+      return -1;
+    }
+    NetworkAddress source;
+    source.addr = from.sin_addr;
+    source.port = from.sin_port;
+
+    int64_t start = RadarTelemetry::Now();
+    ReorderFrame(data, (size_t)r, time_rec, source);
+    m_ri->m_telemetry.AddFrame((size_t)r, start, drops);
+    frames = 1;
+  }
+
+  if (frames > 0) {
+    wxCriticalSectionLocker lock(m_ri->m_receive_exclusive);
+
+    m_ri->m_statistics.wakeups++;
+    m_ri->m_statistics.wakeup_frames += frames;
+    if (frames > m_ri->m_statistics.max_wakeup_frames) {
+      m_ri->m_statistics.max_wakeup_frames = frames;
+    }
+  }
+  return frames;
+}
+
+/*
+ * Pass a frame on to ProcessFrame() in scan number order.
+ *
+ * A frame that starts beyond the expected scan number is held back for up to
+ * NavicoReorderMillis, in case the frames in between were only overtaken on
+ * the network. A frame that arrives after its place was given up, or a little
+ * behind the expected scan number, is late or a duplicate and is dropped, as
+ * drawing it would put stale lines over newer ones. Frames that arrive in
+ * order go straight through.
+ */
+void NavicoReceive::ReorderFrame(const uint8_t *data, size_t len, wxLongLong time_rec, const NetworkAddress &source) {
+  radar_frame_pkt *packet = (radar_frame_pkt *)data;
+
+  if (m_pi->m_settings.navico_reorder_millis <= 0 || m_first_receive || len < sizeof(packet->frame_hdr) + sizeof(radar_line) ||
+      len > sizeof(radar_frame_pkt)) {
+    ProcessFrame(data, len, time_rec, source);
+    return;
+  }
+
+  uint8_t scan = packet->line[0].common.scan_number;
+  uint8_t ahead = scan - m_next_scan;  // We use automatic rollover of uint8_t here
+  int spokes = (int)((len - sizeof(packet->frame_hdr)) / sizeof(radar_line));
+
+  if ((uint8_t)(scan - m_gap_start) >= SCAN_MAX / 2) {
+    m_gap_len = 0;  // Long past, before scan numbers come round again
+  }
+
+  bool late = (uint8_t)(scan - m_gap_start) < m_gap_len || (uint8_t)(m_next_scan - scan) <= SCAN_LATE_MAX;
+  bool overtaken = false;  // Fills the gap in front of a frame that we hold
+  for (size_t i = 0; i < NAVICO_REORDER_FRAMES && m_held > 0; i++) {
+    if (m_held_len[i] > 0) {
+      uint8_t held_ahead = m_held_scan[i] - m_next_scan;
+      late = late || held_ahead == ahead;  // Duplicate of a held frame
+      overtaken = overtaken || held_ahead > ahead;
+    }
+  }
+
+  if (ahead != 0 && late) {
+    wxCriticalSectionLocker lock(m_ri->m_receive_exclusive);
+    m_ri->m_statistics.late_spokes += spokes;
+    return;
+  }
+  if (overtaken) {
+    wxCriticalSectionLocker lock(m_ri->m_receive_exclusive);
+    m_ri->m_statistics.reordered_spokes += spokes;
+  }
+
+  if (ahead == 0) {
+    ProcessFrame(data, len, time_rec, source);
+    if (m_held > 0) {
+      ReleaseHeldFrames(false);
+    }
+    return;
+  }
+
+  if (ahead >= SCAN_MAX / 2) {
+    // Too far off to be reordering: lost a lot, or the radar restarted its scan numbers
+    while (m_held > 0) {
+      ReleaseHeldFrames(true);
+    }
+    m_gap_len = 0;
+    ProcessFrame(data, len, time_rec, source);
+    return;
+  }
+
+  if (!m_reorder_data) {
+    m_reorder_data = (uint8_t *)malloc(NAVICO_REORDER_FRAMES * sizeof(radar_frame_pkt));
+    for (size_t i = 0; i < NAVICO_REORDER_FRAMES; i++) {
+      m_held_len[i] = 0;
+    }
+  }
+  if (!m_reorder_data) {
+    ProcessFrame(data, len, time_rec, source);
+    return;
+  }
+  if (m_held == NAVICO_REORDER_FRAMES) {
+    ReleaseHeldFrames(true);  // No room to wait any longer for the earliest gap
+  }
+  for (size_t i = 0; i < NAVICO_REORDER_FRAMES; i++) {
+    if (m_held_len[i] == 0) {
+      memcpy(m_reorder_data + i * sizeof(radar_frame_pkt), data, len);
+      m_held_len[i] = len;
+      m_held_time_rec[i] = time_rec;
+      m_held_source[i] = source;
+      m_held_since[i] = RadarTelemetry::Now();
+      m_held_scan[i] = scan;
+      m_held++;
+      break;
+    }
+  }
+  ReleaseHeldFrames(false);  // Frames from before this one may be next now
+}
+
+/*
+ * Process the held frames that are next in line. When 'give_up' is set, or a
+ * held frame has waited longer than NavicoReorderMillis, the spokes before
+ * the earliest held frame are taken as lost; ProcessFrame() counts them as
+ * missing.
+ */
+void NavicoReceive::ReleaseHeldFrames(bool give_up) {
+  int64_t window = (int64_t)m_pi->m_settings.navico_reorder_millis * 1000;
+  int64_t now = RadarTelemetry::Now();
+  bool released = false;
+
+  while (m_held > 0) {
+    size_t first = NAVICO_REORDER_FRAMES;
+    bool expired = give_up;
+
+    for (size_t i = 0; i < NAVICO_REORDER_FRAMES; i++) {
+      if (m_held_len[i] == 0) {
+        continue;
+      }
+      if (first == NAVICO_REORDER_FRAMES || (uint8_t)(m_held_scan[i] - m_next_scan) < (uint8_t)(m_held_scan[first] - m_next_scan)) {
+        first = i;
+      }
+      if (now - m_held_since[i] >= window) {
+        expired = true;
+      }
+    }
+    if (m_held_scan[first] != m_next_scan) {
+      if (!expired) {
+        break;
+      }
+      m_gap_start = m_next_scan;  // So we recognize the frames that come too late
+      m_gap_len = m_held_scan[first] - m_next_scan;
+    } else if (!released) {
+      m_gap_len = 0;  // Any earlier gap is behind us now
+    }
+    released = true;
+    ProcessFrame(m_reorder_data + first * sizeof(radar_frame_pkt), m_held_len[first], m_held_time_rec[first], m_held_source[first]);
+    m_held_len[first] = 0;
+    m_held--;
+    give_up = false;
+  }
+}
+
+/*
+ * Allocate the buffers and open the report socket on the interface that
+ * worked last time, if any. The other sockets are opened by OpenSockets().
+ */
+void NavicoReceive::StartReceiving() {
+  if (!m_frame) {
+    m_frame = new uint8_t[sizeof(radar_frame_pkt)];
+  }
+  OpenCachedReportSocket();  // Start using the same interface_addr as previous time
+  m_receiving = true;
+}
+
+void NavicoReceive::StopReceiving() {
+  CloseSocket(m_data_socket);
+  ReleaseInfoSocket();
+  CloseSocket(m_report_socket);
+  CloseProbeSockets();
+
+  if (m_frame) {
+    delete[] m_frame;
+    m_frame = 0;
+  }
+  if (m_batch_data) {
+    free(m_batch_data);
+    m_batch_data = 0;
+  }
+  if (m_reorder_data) {
+    free(m_reorder_data);
+    m_reorder_data = 0;
+  }
+  m_held = 0;
+  m_receiving = false;
+}
+
+/*
+ * Open the sockets that we need now: the probes while we don't have a report
+ * socket, and the data and info sockets once a radar was detected.
+ */
+void NavicoReceive::OpenSockets() {
+  if (m_report_socket == INVALID_SOCKET && m_probes == 0) {
+    // The cached interface did not work (or there was none), try all of them
+    if (OpenProbeSockets() > 0) {
+      m_no_data_timeout = 0;
+      m_no_spoke_timeout = 0;
+    }
+  }
+  if (!m_radar_addr.IsNull()) {
+    // If we have detected a radar antenna at this address, start opening more sockets.
+    // We do this later for 2 reasons:
+    // - Resource consumption
+    // - Timing. If we start processing radar data before the rest of the system
+    //           is initialized then we get ordering/race condition issues.
+    if (m_data_socket == INVALID_SOCKET) {
+      m_data_socket = GetNewDataSocket();
+      WatchSocket(m_data_socket);
+    }
+    if (m_info_socket == INVALID_SOCKET) {
+      // One of the two Halo radars will obtain an InfoSocket.
+      m_info_socket = GetNewInfoSocket();
+      WatchSocket(m_info_socket);
+    }
+  } else {
+    CloseSocket(m_data_socket);
+    ReleaseInfoSocket();
+  }
+}
+
+void NavicoReceive::WatchSocket(SOCKET socket) {
+  if (m_reactor && socket != INVALID_SOCKET) {
+    m_reactor->Add(socket, this);
+  }
+}
+
+/*
+ * Close the socket, after removing it from the reactor as its number may be
+ * reused straight away.
+ */
+void NavicoReceive::CloseSocket(SOCKET &socket) {
+  if (socket != INVALID_SOCKET) {
+    if (m_reactor) {
+      m_reactor->Remove(socket);
+    }
+    closesocket(socket);
+    socket = INVALID_SOCKET;
+  }
+}
+
+/*
+ * Called by Entry() or the reactor when one of our sockets has data.
+ */
+void NavicoReceive::OnReadable(SOCKET socket) {
   union {
     sockaddr_storage addr;
     sockaddr_in ipv4;
   } rx_addr;
   socklen_t rx_len;
+  int r;
 
-  uint8_t data[sizeof(radar_frame_pkt)];
-  m_interface_array = 0;
-  m_interface = 0;
-  NetworkAddress radar_address = NetworkAddress();
-
-  SOCKET dataSocket = INVALID_SOCKET;
-  SOCKET reportSocket = INVALID_SOCKET;
-  SOCKET infoSocket = INVALID_SOCKET;
+  m_received = true;
 
-  LOG_VERBOSE(wxT("%s thread starting"), m_ri->m_name.c_str());
-  reportSocket = GetNewReportSocket();  // Start using the same interface_addr as previous time
+  if (socket == m_data_socket) {
+    r = ReceiveDataFrames(m_data_socket, m_frame, sizeof(radar_frame_pkt));
+    if (r > 0) {
+      m_no_data_timeout = -15;
+      m_no_spoke_timeout = -5;
+    } else if (r < 0) {
+      CloseSocket(m_data_socket);
+      wxLogError(wxT("%s illegal frame"), m_ri->m_name.c_str());
+    }
+    return;
+  }
 
-  while (m_receive_socket != INVALID_SOCKET) {
-    if (reportSocket == INVALID_SOCKET) {
-      reportSocket = PickNextEthernetCard();
-      if (reportSocket != INVALID_SOCKET) {
-        no_data_timeout = 0;
-        no_spoke_timeout = 0;
+  for (size_t i = 0; i < m_probes; i++) {
+    if (socket == m_probe_socket[i]) {
+      // Only peek to see who sent it, the report is read below once this is the report socket
+      rx_len = sizeof(rx_addr);
+      r = recvfrom(socket, (char *)m_frame, sizeof(radar_frame_pkt), MSG_PEEK, (struct sockaddr *)&rx_addr, &rx_len);
+      if (r > 0) {
+        NetworkAddress sender;
+        sender.addr = rx_addr.ipv4.sin_addr;
+        sender.port = rx_addr.ipv4.sin_port;
+        m_report_socket = AdoptProbeSocket(i, sender);
       }
+      break;
     }
-    if (!radar_address.IsNull()) {
-      // If we have detected a radar antenna at this address, start opening more sockets.
-      // We do this later for 2 reasons:
-      // - Resource consumption
-      // - Timing. If we start processing radar data before the rest of the system
-      //           is initialized then we get ordering/race condition issues.
-      if (dataSocket == INVALID_SOCKET) {
-        dataSocket = GetNewDataSocket();
+  }
+
+  if (socket == m_report_socket) {
+    ReceiveReport();
+  } else if (socket == m_info_socket) {
+    ReceiveInfo();
+  }
+}
+
+void NavicoReceive::ReceiveReport() {
+  union {
+    sockaddr_storage addr;
+    sockaddr_in ipv4;
+  } rx_addr;
+  socklen_t rx_len = sizeof(rx_addr);
+
+  int r = recvfrom(m_report_socket, (char *)m_frame, sizeof(radar_frame_pkt), 0, (struct sockaddr *)&rx_addr, &rx_len);
+  if (r > 0) {
+    if (ProcessReport(m_frame, (size_t)r)) {
+      if (m_radar_addr.IsNull()) {
+        m_radar_addr.addr = rx_addr.ipv4.sin_addr;
+        m_radar_addr.port = rx_addr.ipv4.sin_port;
+        m_first_report_elapsed = DiscoveryPhase(wxT("first report from ") + m_radar_addr.FormatNetworkAddress());
+        wxCriticalSectionLocker lock(m_lock);
+        m_ri->DetectedRadar(m_interface_addr, m_radar_addr);  // enables transmit data
+        DetectedRadar(m_radar_addr);
+
+        // the data socket is opened by the next OpenSockets()
+
+        if (m_ri->m_state.GetValue() == RADAR_OFF) {
+          LOG_INFO(wxT("%s detected at %s"), m_ri->m_name.c_str(), m_radar_addr.FormatNetworkAddress());
+          m_ri->m_state.Update(RADAR_STANDBY);
+        }
       }
-      if (infoSocket == INVALID_SOCKET) {
-        // One of the two Halo radars will obtain an InfoSocket.
-        infoSocket = GetNewInfoSocket();
+      m_no_data_timeout = SECONDS_SELECT(-15);
+    }
+  } else {
+    wxLogError(wxT("%s illegal report"), m_ri->m_name.c_str());
+    CloseSocket(m_report_socket);
+  }
+}
+
+void NavicoReceive::ReceiveInfo() {
+  union {
+    sockaddr_storage addr;
+    sockaddr_in ipv4;
+  } rx_addr;
+  socklen_t rx_len = sizeof(rx_addr);
+
+  int r = recvfrom(m_info_socket, (char *)m_frame, sizeof(radar_frame_pkt), 0, (struct sockaddr *)&rx_addr, &rx_len);
+  if (r > 0) {
+    NetworkAddress mfd_address;
+    mfd_address.addr = rx_addr.ipv4.sin_addr;
+    mfd_address.port = 0;
+    if (m_interface_addr == mfd_address) {
+      LOG_RECEIVE(wxT("%s active mfd detected at %s but that is us"), m_ri->m_name.c_str(), mfd_address.FormatNetworkAddress());
+    } else {
+      LOG_RECEIVE(wxT("%s active mfd detected at %s"), m_ri->m_name.c_str(), mfd_address.FormatNetworkAddress());
+      m_halo_received_info = wxGetUTCTimeMillis();
+    }
+    IF_LOG_AT(LOGLEVEL_RECEIVE, m_pi->logBinaryData(m_ri->m_name, m_frame, r));
+
+    halo_heading_packet *msg = (halo_heading_packet *)m_frame;
+
+    if (msg->u02[0] == 0x12 && msg->u02[1] == 0xf1) {
+      double heading = (double)msg->heading * 360.0 / ((double)0xf800);  // assume that this is a true heading ?
+      if (m_pi->m_heading_source <= HEADING_FIX_COG || m_pi->m_heading_source >= HEADING_RADAR_HDM) {
+        LOG_RECEIVE(wxT("Received and set radar_heading from network %f"), heading);
+        m_pi->SetRadarHeading(heading, true);  // only set HEADING_RADAR_HDT if nothing better is available
       }
+      LOG_RECEIVE(wxT("msg.counter = %u"), msg->counter);
+      LOG_RECEIVE(wxT("msg.epoch   = %lld"), msg->epoch);
+      LOG_RECEIVE(wxT("msg.heading = %u -> %f"), msg->heading, heading);
+      LOG_RECEIVE(wxT("msg.u05a    = %x"), msg->u05a);
+      LOG_RECEIVE(wxT("msg.u05b    = %x"), msg->u05b);
     } else {
-      if (dataSocket != INVALID_SOCKET) {
-        closesocket(dataSocket);
-        dataSocket = INVALID_SOCKET;
+      halo_navigation_packet *msg2 = (halo_navigation_packet *)m_frame;
+      LOG_RECEIVE(wxT("msg.counter = %u"), msg2->counter);
+      LOG_RECEIVE(wxT("msg.epoch   = %lld"), msg2->epoch);
+      LOG_RECEIVE(wxT("msg.navigation = %u"), msg2->cog);
+      LOG_RECEIVE(wxT("msg.navigation = %u"), msg2->sog);
+    }
+  }
+}
+
+/*
+ * Called once per MILLIS_PER_SELECT in which none of the sockets had data.
+ */
+void NavicoReceive::NothingReceived() {
+  if (m_no_data_timeout >= SECONDS_SELECT(2)) {
+    // Unless the cached interface is what just timed out, try that again first:
+    // after a scan found nothing, or when a radar that was seen went quiet.
+    bool retry_cached = m_probes > 0 || !m_radar_addr.IsNull();
+
+    m_no_data_timeout = 0;
+    CloseProbeSockets();  // Reopened by the next OpenSockets(), for any new cards
+    if (m_report_socket != INVALID_SOCKET) {
+      CloseSocket(m_report_socket);
+      m_ri->m_state.Update(RADAR_OFF);
+      m_interface_addr = NetworkAddress();
+      m_radar_addr = NetworkAddress();
+    }
+    if (retry_cached) {
+      OpenCachedReportSocket();  // When this fails OpenSockets() scans all interfaces
+    }
+  } else {
+    m_no_data_timeout++;
+  }
+
+  if (m_no_spoke_timeout >= SECONDS_SELECT(2)) {
+    m_no_spoke_timeout = 0;
+    m_ri->ResetRadarImage();
+  } else {
+    m_no_spoke_timeout++;
+  }
+}
+
+/*
+ * Send the Halo heading and navigation packets when they are due, and close
+ * the sockets that are no longer valid.
+ */
+void NavicoReceive::Maintain(wxLongLong now) {
+  if (m_pi->m_heading_source > HEADING_FIX_COG && m_pi->m_heading_source < HEADING_RADAR_HDM) {
+    LOG_TRANSMIT(wxT("%s infoSocket=%d received=%lld sent=%lld\n"), m_ri->m_name.c_str(), m_info_socket, now - m_halo_received_info,
+                 now - m_halo_sent_heading);
+    if (m_info_socket != INVALID_SOCKET && m_halo_received_info + 10000 < now) {
+      if (m_halo_sent_heading + 100 < now) {
+        SendHeadingPacket();
+        m_halo_sent_heading = now;
+      }
+      if (m_halo_sent_mystery + 250 < now) {
+        SendNavigationPacket();
+        m_halo_sent_mystery = now;
       }
-      if (infoSocket != INVALID_SOCKET) {
-        ReleaseInfoSocket();
-        infoSocket = INVALID_SOCKET;
+      if (m_halo_sent_speed + 250 < now) {
+        SendSpeedPacket();
+        m_halo_sent_speed = now;
       }
     }
+  }
+
+  if (!(m_info == m_ri->GetRadarLocationInfo())) {
+    // Navicolocate modified the RadarInfo in settings
+    CloseSocket(m_report_socket);
+    CloseProbeSockets();
+  };
+
+  if (m_report_socket == INVALID_SOCKET) {
+    // If we closed the report socket then close the data and info socket
+    CloseSocket(m_data_socket);
+    ReleaseInfoSocket();
+  }
+}
+
+/*
+ * Called by the reactor every MILLIS_PER_SELECT, or more often while frames
+ * are held back. Does what Entry() does after every select().
+ */
+void NavicoReceive::OnTick() {
+  wxLongLong now = wxGetUTCTimeMillis();
+
+  if (!m_receiving) {
+    StartReceiving();
+    m_next_idle = now + MILLIS_PER_SELECT;
+  }
+
+  if (m_held > 0) {
+    ReleaseHeldFrames(false);
+  }
+
+  if (now >= m_next_idle) {
+    if (!m_received) {
+      NothingReceived();
+    }
+    m_received = false;
+    m_next_idle += MILLIS_PER_SELECT;
+    if (m_next_idle <= now) {
+      m_next_idle = now + MILLIS_PER_SELECT;
+    }
+  }
+
+  Maintain(now);
+  if (now >= m_retry_after) {
+    OpenSockets();
+  }
+}
+
+/*
+ * Only the thread needs the localhost socket pair, to wake it from select().
+ */
+bool NavicoReceive::StartThread() {
+  m_receive_socket = GetLocalhostServerTCPSocket();
+  m_send_socket = GetLocalhostSendTCPSocket(m_receive_socket);
+  return RadarReceive::StartThread();
+}
+
+/*
+ * The sockets are opened by the first OnTick(), so that they are only ever
+ * touched on the reactor thread.
+ */
+bool NavicoReceive::StartOnReactor() {
+  int tick = MILLIS_PER_SELECT;
+
+  if (m_pi->m_settings.navico_reorder_millis > 0 && m_pi->m_settings.navico_reorder_millis < tick) {
+    tick = m_pi->m_settings.navico_reorder_millis;  // Do not hold frames for long
+  }
+  m_reactor->AddHandler(this, tick);
+  LOG_VERBOSE(wxT("%s receive added to socket reactor"), m_ri->m_name.c_str());
+  return true;
+}
+
+void NavicoReceive::StopOnReactor() {
+  m_reactor->RemoveHandler(this);
+  StopReceiving();
+  LOG_VERBOSE(wxT("%s receive removed from socket reactor"), m_ri->m_name.c_str());
+  m_is_shutdown = true;
+}
+
+/*
+ * Entry
+ *
+ * Called by wxThread when the new thread is running.
+ * It should remain running until Shutdown is called.
+ */
+void *NavicoReceive::Entry(void) {
+  int r = 0;
+
+  LOG_VERBOSE(wxT("%s thread starting"), m_ri->m_name.c_str());
+  StartReceiving();
+
+  while (m_receive_socket != INVALID_SOCKET) {
+    OpenSockets();
 
     fd_set fdin;
     FD_ZERO(&fdin);
@@ -750,198 +1363,85 @@ void *NavicoReceive::Entry(void) {
       FD_SET(m_receive_socket, &fdin);
       maxFd = MAX(m_receive_socket, maxFd);
     }
-    if (reportSocket != INVALID_SOCKET) {
-      FD_SET(reportSocket, &fdin);
-      maxFd = MAX(reportSocket, maxFd);
+    if (m_report_socket != INVALID_SOCKET) {
+      FD_SET(m_report_socket, &fdin);
+      maxFd = MAX(m_report_socket, maxFd);
+    }
+    if (m_data_socket != INVALID_SOCKET) {
+      FD_SET(m_data_socket, &fdin);
+      maxFd = MAX(m_data_socket, maxFd);
     }
-    if (dataSocket != INVALID_SOCKET) {
-      FD_SET(dataSocket, &fdin);
-      maxFd = MAX(dataSocket, maxFd);
+    if (m_info_socket != INVALID_SOCKET) {
+      FD_SET(m_info_socket, &fdin);
+      maxFd = MAX(m_info_socket, maxFd);
     }
-    if (infoSocket != INVALID_SOCKET) {
-      FD_SET(infoSocket, &fdin);
-      maxFd = MAX(infoSocket, maxFd);
+    for (size_t i = 0; i < m_probes; i++) {
+      FD_SET(m_probe_socket[i], &fdin);
+      maxFd = MAX(m_probe_socket[i], maxFd);
     }
 
     wxLongLong start = wxGetUTCTimeMillis();
     int64_t wait = MILLIS_PER_SELECT - (start.GetValue() % MILLIS_PER_SELECT);
+    if (m_held > 0) {
+      wait = wxMin(wait, (int64_t)m_pi->m_settings.navico_reorder_millis);  // Do not hold frames for long
+    }
 
     struct timeval tv = {0, (int)(wait * 1000)};
     r = select(maxFd + 1, &fdin, 0, 0, &tv);
     wxLongLong now = wxGetUTCTimeMillis();
     LOG_RECEIVE(wxT("%s select maxFd=%d r=%d elapsed=%lld"), m_ri->m_name.c_str(), maxFd, r, now - start);
 
+    if (m_held > 0) {
+      ReleaseHeldFrames(false);
+    }
+
     if (r > 0) {
-      if (m_receive_socket != INVALID_SOCKET && FD_ISSET(m_receive_socket, &fdin)) {
-        rx_len = sizeof(rx_addr);
-        r = recvfrom(m_receive_socket, (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
+      if (FD_ISSET(m_receive_socket, &fdin)) {
+        char stop[10];
+
+        r = recv(m_receive_socket, stop, sizeof(stop), 0);
         if (r > 0) {
           LOG_VERBOSE(wxT("%s received stop instruction"), m_ri->m_name.c_str());
           break;
         }
       }
 
-      if (dataSocket != INVALID_SOCKET && FD_ISSET(dataSocket, &fdin)) {
-        rx_len = sizeof(rx_addr);
-        r = recvfrom(dataSocket, (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
-        if (r > 0) {
-          ProcessFrame(data, (size_t)r);
-          no_data_timeout = -15;
-          no_spoke_timeout = -5;
-        } else {
-          closesocket(dataSocket);
-          dataSocket = INVALID_SOCKET;
-          wxLogError(wxT("%s illegal frame"), m_ri->m_name.c_str());
-        }
-      }
-
-      if (reportSocket != INVALID_SOCKET && FD_ISSET(reportSocket, &fdin)) {
-        rx_len = sizeof(rx_addr);
-        r = recvfrom(reportSocket, (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
-        if (r > 0) {
-          if (ProcessReport(data, (size_t)r)) {
-            if (radar_address.IsNull()) {
-              radar_address.addr = rx_addr.ipv4.sin_addr;
-              radar_address.port = rx_addr.ipv4.sin_port;
-              wxCriticalSectionLocker lock(m_lock);
-              m_ri->DetectedRadar(m_interface_addr, radar_address);  // enables transmit data
-              DetectedRadar(radar_address);
-
-              // the dataSocket is opened in the next loop
-
-              if (m_ri->m_state.GetValue() == RADAR_OFF) {
-                LOG_INFO(wxT("%s detected at %s"), m_ri->m_name.c_str(), radar_address.FormatNetworkAddress());
-                m_ri->m_state.Update(RADAR_STANDBY);
-              }
-            }
-            no_data_timeout = SECONDS_SELECT(-15);
-          }
-        } else {
-          wxLogError(wxT("%s illegal report"), m_ri->m_name.c_str());
-          closesocket(reportSocket);
-          reportSocket = INVALID_SOCKET;
-        }
-      }
+      // OnReadable can close sockets, so find all readable ones before calling it
+      SOCKET readable[NAVICO_MAX_PROBES + 3];
+      size_t n = 0;
 
-      if (infoSocket != INVALID_SOCKET && FD_ISSET(infoSocket, &fdin)) {
-        rx_len = sizeof(rx_addr);
-        r = recvfrom(infoSocket, (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
-        if (r > 0) {
-          NetworkAddress mfd_address;
-          mfd_address.addr = rx_addr.ipv4.sin_addr;
-          mfd_address.port = 0;
-          if (m_interface_addr == mfd_address) {
-            LOG_RECEIVE(wxT("%s active mfd detected at %s but that is us"), m_ri->m_name.c_str(),
-                        mfd_address.FormatNetworkAddress());
-          } else {
-            LOG_RECEIVE(wxT("%s active mfd detected at %s"), m_ri->m_name.c_str(), mfd_address.FormatNetworkAddress());
-            m_halo_received_info = wxGetUTCTimeMillis();
-          }
-          IF_LOG_AT(LOGLEVEL_RECEIVE, m_pi->logBinaryData(m_ri->m_name, data, r));
-
-          halo_heading_packet *msg = (halo_heading_packet *)data;
-
-          if (msg->u02[0] == 0x12 && msg->u02[1] == 0xf1) {
-            double heading = (double)msg->heading * 360.0 / ((double)0xf800);  // assume that this is a true heading ?
-            if (m_pi->m_heading_source <= HEADING_FIX_COG || m_pi->m_heading_source >= HEADING_RADAR_HDM) {
-              LOG_RECEIVE(wxT("Received and set radar_heading from network %f"), heading);
-              m_pi->SetRadarHeading(heading, true);  // only set HEADING_RADAR_HDT if nothing better is available
-            }
-            LOG_RECEIVE(wxT("msg.counter = %u"), msg->counter);
-            LOG_RECEIVE(wxT("msg.epoch   = %lld"), msg->epoch);
-            LOG_RECEIVE(wxT("msg.heading = %u -> %f"), msg->heading, heading);
-            LOG_RECEIVE(wxT("msg.u05a    = %x"), msg->u05a);
-            LOG_RECEIVE(wxT("msg.u05b    = %x"), msg->u05b);
-          } else {
-            halo_navigation_packet *msg2 = (halo_navigation_packet *)data;
-            LOG_RECEIVE(wxT("msg.counter = %u"), msg2->counter);
-            LOG_RECEIVE(wxT("msg.epoch   = %lld"), msg2->epoch);
-            LOG_RECEIVE(wxT("msg.navigation = %u"), msg2->cog);
-            LOG_RECEIVE(wxT("msg.navigation = %u"), msg2->sog);
-          }
-        }
+      if (m_data_socket != INVALID_SOCKET && FD_ISSET(m_data_socket, &fdin)) {
+        readable[n++] = m_data_socket;
       }
-
-    } else {  // no data received -> select timeout
-      if (no_data_timeout >= SECONDS_SELECT(2)) {
-        no_data_timeout = 0;
-        if (reportSocket != INVALID_SOCKET) {
-          closesocket(reportSocket);
-          reportSocket = INVALID_SOCKET;
-          m_ri->m_state.Update(RADAR_OFF);
-          m_interface_addr = NetworkAddress();
-          radar_address = NetworkAddress();
+      for (size_t i = 0; i < m_probes; i++) {
+        if (FD_ISSET(m_probe_socket[i], &fdin)) {
+          readable[n++] = m_probe_socket[i];
         }
-      } else {
-        no_data_timeout++;
-      }
-
-      if (no_spoke_timeout >= SECONDS_SELECT(2)) {
-        no_spoke_timeout = 0;
-        m_ri->ResetRadarImage();
-      } else {
-        no_spoke_timeout++;
       }
-    }
-
-    if (m_pi->m_heading_source > HEADING_FIX_COG && m_pi->m_heading_source < HEADING_RADAR_HDM) {
-      LOG_TRANSMIT(wxT("%s infoSocket=%d received=%lld sent=%lld\n"), m_ri->m_name.c_str(), infoSocket, now - m_halo_received_info,
-                   now - m_halo_sent_heading);
-      if (infoSocket != INVALID_SOCKET && m_halo_received_info + 10000 < now) {
-        if (m_halo_sent_heading + 100 < now) {
-          SendHeadingPacket();
-          m_halo_sent_heading = now;
-        }
-        if (m_halo_sent_mystery + 250 < now) {
-          SendNavigationPacket();
-          m_halo_sent_mystery = now;
-        }
-        if (m_halo_sent_speed + 250 < now) {
-          SendSpeedPacket();
-          m_halo_sent_speed = now;
-        }
+      if (m_report_socket != INVALID_SOCKET && FD_ISSET(m_report_socket, &fdin)) {
+        readable[n++] = m_report_socket;
       }
-    }
-
-    if (!(m_info == m_ri->GetRadarLocationInfo())) {
-      // Navicolocate modified the RadarInfo in settings
-      closesocket(reportSocket);
-      reportSocket = INVALID_SOCKET;
-    };
-
-    if (reportSocket == INVALID_SOCKET) {
-      // If we closed the reportSocket then close the command and data socket
-      if (dataSocket != INVALID_SOCKET) {
-        closesocket(dataSocket);
-        dataSocket = INVALID_SOCKET;
+      if (m_info_socket != INVALID_SOCKET && FD_ISSET(m_info_socket, &fdin)) {
+        readable[n++] = m_info_socket;
       }
-      if (infoSocket != INVALID_SOCKET) {
-        ReleaseInfoSocket();
-        infoSocket = INVALID_SOCKET;
+      for (size_t i = 0; i < n; i++) {
+        OnReadable(readable[i]);
       }
+    } else {  // no data received -> select timeout
+      NothingReceived();
     }
 
+    Maintain(now);
   }  // endless loop until thread destroy
 
-  if (dataSocket != INVALID_SOCKET) {
-    closesocket(dataSocket);
-  }
-  if (infoSocket != INVALID_SOCKET) {
-    ReleaseInfoSocket();
-  }
-  if (reportSocket != INVALID_SOCKET) {
-    closesocket(reportSocket);
-  }
+  StopReceiving();
   if (m_send_socket != INVALID_SOCKET) {
     closesocket(m_send_socket);
     m_send_socket = INVALID_SOCKET;
   }
   if (m_receive_socket != INVALID_SOCKET) {
     closesocket(m_receive_socket);
-  }
-
-  if (m_interface_array) {
-    freeifaddrs(m_interface_array);
+    m_receive_socket = INVALID_SOCKET;
   }
 
 #ifdef TEST_THREAD_RACES
@@ -1441,8 +1941,8 @@ bool NavicoReceive::ProcessReport(const uint8_t *report, size_t len) {
 
 // Called from the main thread to stop this thread.
 // We send a simple one byte message to the thread so that it awakens from the select() call with
-// this message ready for it to be read on 'm_receive_socket'. See the constructor in NavicoReceive.h
-// for the setup of these two sockets.
+// this message ready for it to be read on 'm_receive_socket'. See StartThread() for the setup of
+// these two sockets. When served by the reactor Stop() calls StopOnReactor() instead.
 
 void NavicoReceive::Shutdown() {
   if (m_send_socket != INVALID_SOCKET) {
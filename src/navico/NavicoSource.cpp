@@ -0,0 +1,495 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+// Stand-in for a Navico radar on the local network, for end-to-end tests of
+// NavicoLocate and NavicoReceive without radar hardware.
+//
+// It answers the 01 B1 wake request on the locator group with an 01 B2
+// report, sends 01 C4 'transmitting' status reports and sends spoke frames
+// (radar_frame_pkt, 32 spokes each) to the data group. The frames are either
+// synthetic or replayed from a RadarCapture (.rcap) file.
+//
+// The plugin ignores loopback interfaces, so run it on a dummy interface:
+//
+//   ip link add radar0 type dummy
+//   ip addr add 10.56.0.1/24 dev radar0
+//   ip link set radar0 multicast on up
+//
+// Usage: navico-source [-t br24|halo] [-i address] [-r rpm] [-x speed]
+//                      [-s seconds] [capture.rcap]
+//
+//   -t  frame and discovery format; 'halo' also covers 3G and 4G (default halo)
+//   -i  interface address to send from (default 10.56.0.1)
+//   -r  rotations per minute of the synthetic picture (default 24)
+//   -x  rate multiplier, also for replay (default 1)
+//   -s  stop after this many seconds (default run until killed)
+//
+// Once per second it prints what was sent. Frames the plugin did not get show
+// up as missing spokes in its statistics and telemetry.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "RadarCaptureFile.h"
+#include "navico/NavicoFrame.h"
+
+typedef enum RadarType {
+#define DEFINE_RADAR(t, n, s, l, a, b, c, d) t,
+#include "RadarType.h"
+  RT_MAX
+} RadarType;
+
+#define SPOKES_PER_FRAME (32)
+#define RANGE_METERS (1852)
+#define REPORT_MILLIS (1000)     // Status and location reports
+#define SCAN_MAX (4096)          // br24_header.scan_number wraps at this
+
+// A HALO24 01 B2 report, with the radar address at offset 18 and the
+// addresses of radar A: data at 88, send at 98 and report at 108.
+static const uint8_t report_01B2[] = {
+    0x01, 0xb2, 0x31, 0x39, 0x30, 0x32, 0x35, 0x30, 0x31, 0x30, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0a, 0x00,
+    0x43, 0xc6, 0x20, 0x31, 0x06, 0x00, 0xfd, 0xff, 0x20, 0x01, 0x02, 0x00, 0x10, 0x00, 0x00, 0x00, 0xec, 0x06, 0x08, 0x20,
+    0x19, 0x70, 0x11, 0x00, 0x00, 0x00, 0xec, 0x06, 0x07, 0x16, 0x1a, 0x26, 0x1f, 0x00, 0x20, 0x01, 0x02, 0x00, 0x10, 0x00,
+    0x00, 0x00, 0xec, 0x06, 0x08, 0x21, 0x19, 0x71, 0x11, 0x00, 0x00, 0x00, 0xec, 0x06, 0x08, 0x22, 0x19, 0x72, 0x10, 0x00,
+    0x20, 0x01, 0x03, 0x00, 0x10, 0x00, 0x00, 0x00, 0xec, 0x06, 0x08, 0x23, 0x19, 0x73, 0x11, 0x00, 0x00, 0x00, 0xec, 0x06,
+    0x08, 0x24, 0x19, 0x74, 0x12, 0x00, 0x00, 0x00, 0xec, 0x06, 0x08, 0x23, 0x19, 0x75, 0x10, 0x00, 0x20, 0x02, 0x03, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0xec, 0x06, 0x08, 0x25, 0x19, 0x76, 0x11, 0x00, 0x00, 0x00, 0xec, 0x06, 0x08, 0x26, 0x19, 0x77,
+    0x12, 0x00, 0x00, 0x00, 0xec, 0x06, 0x08, 0x25, 0x19, 0x78, 0x12, 0x00, 0x20, 0x01, 0x03, 0x00, 0x10, 0x00, 0x00, 0x00,
+    0xec, 0x06, 0x08, 0x23, 0x19, 0x79, 0x11, 0x00, 0x00, 0x00, 0xec, 0x06, 0x08, 0x27, 0x19, 0x7a, 0x12, 0x00, 0x00, 0x00,
+    0xec, 0x06, 0x08, 0x23, 0x19, 0x7b, 0x12, 0x00, 0x20, 0x02, 0x03, 0x00, 0x10, 0x00, 0x00, 0x00, 0xec, 0x06, 0x08, 0x25,
+    0x19, 0x7c, 0x11, 0x00, 0x00, 0x00, 0xec, 0x06, 0x08, 0x28, 0x19, 0x7d, 0x12, 0x00, 0x00, 0x00, 0xec, 0x06, 0x08, 0x25,
+    0x19, 0x7e};
+
+#define REPORT_RADAR_ADDR (18)
+#define REPORT_DATA_A (88)
+#define REPORT_REPORT_A (108)
+
+// 01 C4 status report, byte 2 = 0x02 is transmitting
+static const uint8_t report_01C4[18] = {0x01, 0xc4, 0x02};
+
+struct Frame {
+  std::vector<uint8_t> data;
+  int64_t time;  // millis, only for replay
+};
+
+static int64_t NowMicros() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static sockaddr_in PackedToSockaddr(const uint8_t *packed) {
+  sockaddr_in sa;
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  memcpy(&sa.sin_addr, packed, 4);
+  memcpy(&sa.sin_port, packed + 4, 2);
+  return sa;
+}
+
+static sockaddr_in MakeSockaddr(const char *addr, int port) {
+  sockaddr_in sa;
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = inet_addr(addr);
+  sa.sin_port = htons(port);
+  return sa;
+}
+
+// A socket that sends multicast out of 'interface_addr' and loops it back
+// to listeners on this host.
+static int MakeSendSocket(in_addr interface_addr) {
+  int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  unsigned char loop = 1;
+  unsigned char ttl = 1;
+  int sndbuf = 4 * 1024 * 1024;
+  sockaddr_in sa;
+
+  if (s < 0) {
+    return -1;
+  }
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr = interface_addr;
+  if (bind(s, (sockaddr *)&sa, sizeof(sa)) < 0 ||
+      setsockopt(s, IPPROTO_IP, IP_MULTICAST_IF, &interface_addr, sizeof(interface_addr)) < 0 ||
+      setsockopt(s, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0 ||
+      setsockopt(s, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0) {
+    close(s);
+    return -1;
+  }
+  setsockopt(s, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+  return s;
+}
+
+// Listen on the locator group for wake requests
+static int MakeLocatorSocket(in_addr interface_addr, const sockaddr_in &group) {
+  int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  int one = 1;
+  sockaddr_in sa;
+  ip_mreq mreq;
+
+  if (s < 0) {
+    return -1;
+  }
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = group.sin_port;
+  mreq.imr_multiaddr = group.sin_addr;
+  mreq.imr_interface = interface_addr;
+  if (setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0 || bind(s, (sockaddr *)&sa, sizeof(sa)) < 0 ||
+      setsockopt(s, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+    close(s);
+    return -1;
+  }
+  return s;
+}
+
+static void Put16(uint8_t *p, unsigned int v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+// Line i of a frame; frames hold fewer lines than radar_frame_pkt has room for
+static radar_line *FrameLine(Frame *frame, size_t i) {
+  return (radar_line *)(&frame->data[0] + offsetof(radar_frame_pkt, line) + i * sizeof(radar_line));
+}
+
+static size_t FrameLines(const Frame &frame) {
+  size_t hdr = offsetof(radar_frame_pkt, line);
+
+  return frame.data.size() >= hdr ? (frame.data.size() - hdr) / sizeof(radar_line) : 0;
+}
+
+/*
+ * One rotation of synthetic frames: range rings, a target every 45 degrees
+ * and some noise, encoded as 4 bit samples.
+ */
+static void MakeSyntheticRotation(bool br24, std::vector<Frame> *frames) {
+  unsigned int seed = 42;
+
+  for (int first = 0; first < NAVICO_SPOKES; first += SPOKES_PER_FRAME) {
+    Frame frame;
+    frame.data.assign(offsetof(radar_frame_pkt, line) + SPOKES_PER_FRAME * sizeof(radar_line), 0);
+    frame.time = 0;
+
+    for (int i = 0; i < SPOKES_PER_FRAME; i++) {
+      radar_line *line = FrameLine(&frame, i);
+      int spoke = first + i;
+      int angle_raw = spoke * 2;  // The radar counts 4096 per rotation
+
+      line->br24.headerLen = 0x18;
+      line->br24.status = 0x02;
+      Put16(line->br24.angle, angle_raw);
+      Put16(line->br24.heading, 0xffff);  // No heading from the radar
+      if (br24) {
+        unsigned int range_raw = (unsigned int)(RANGE_METERS * sqrt(2.0) / 10.0);
+        line->br24.mark[1] = 0x44;
+        line->br24.mark[2] = 0x0d;
+        line->br24.mark[3] = 0x0e;
+        line->br24.range[0] = (uint8_t)range_raw;
+        line->br24.range[1] = (uint8_t)(range_raw >> 8);
+        line->br24.range[2] = (uint8_t)(range_raw >> 16);
+      } else {
+        Put16(line->br4g.u00, 0x44);
+        Put16(line->br4g.largerange, 0x80);
+        Put16(line->br4g.smallrange, RANGE_METERS * 4);
+        Put16(line->br4g.rotation, 0xffff);
+      }
+      for (size_t b = 0; b < sizeof(line->data); b++) {
+        uint8_t low = 0;
+        uint8_t high = 0;
+
+        if (b % 128 == 127) {
+          low = high = 0x8;  // Range ring
+        }
+        if (spoke % (NAVICO_SPOKES / 8) < 6 && b >= 200 && b < 206) {
+          low = high = 0xf;  // Target
+        }
+        seed = seed * 1103515245 + 12345;
+        if ((seed >> 16) % 64 == 0) {
+          low |= (seed >> 8) & 0x7;  // Noise
+        }
+        line->data[b] = (uint8_t)(low | (high << 4));
+      }
+    }
+    frames->push_back(frame);
+  }
+}
+
+/*
+ * Read all frames of a capture file. Returns false if it is not one, or if it
+ * was not recorded from a Navico radar.
+ */
+static bool ReadCapture(const char *filename, std::vector<Frame> *frames) {
+  FILE *f = fopen(filename, "rb");
+  RadarCaptureFileHeader header;
+  RadarCaptureTrailer trailer;
+  long end;
+
+  if (!f) {
+    fprintf(stderr, "Cannot open %s: %s\n", filename, strerror(errno));
+    return false;
+  }
+  if (fread(&header, sizeof(header), 1, f) != 1 || memcmp(header.magic, RADAR_CAPTURE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != RADAR_CAPTURE_VERSION) {
+    fprintf(stderr, "%s is not a radar capture file\n", filename);
+    fclose(f);
+    return false;
+  }
+  if (header.radar_type < RT_BR24 || header.radar_type > RT_HaloB) {
+    fprintf(stderr, "%s was not recorded from a Navico radar\n", filename);
+    fclose(f);
+    return false;
+  }
+
+  // Records stop at the index, or at the end of a file without a trailer
+  fseek(f, 0, SEEK_END);
+  end = ftell(f);
+  if (end >= (long)(sizeof(header) + sizeof(trailer))) {
+    fseek(f, end - (long)sizeof(trailer), SEEK_SET);
+    if (fread(&trailer, sizeof(trailer), 1, f) == 1 && memcmp(trailer.magic, RADAR_CAPTURE_INDEX_MAGIC, sizeof(trailer.magic)) == 0) {
+      end = (long)trailer.index_offset;
+    }
+  }
+  fseek(f, sizeof(header), SEEK_SET);
+
+  RadarCaptureRecord record;
+  while (ftell(f) + (long)sizeof(record) <= end && fread(&record, sizeof(record), 1, f) == 1) {
+    Frame frame;
+
+    if (record.len > 65536) {
+      break;
+    }
+    if (record.len == 0) {
+      continue;
+    }
+    frame.data.resize(record.len);
+    frame.time = record.time;
+    if (fread(&frame.data[0], record.len, 1, f) != 1) {
+      break;
+    }
+    frames->push_back(frame);
+  }
+  fclose(f);
+  return !frames->empty();
+}
+
+int main(int argc, char **argv) {
+  const char *type = "halo";
+  const char *interface_name = "10.56.0.1";
+  double rpm = 24.0;
+  double speed = 1.0;
+  double seconds = 0.;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "t:i:r:x:s:")) != -1) {
+    switch (opt) {
+      case 't':
+        type = optarg;
+        break;
+      case 'i':
+        interface_name = optarg;
+        break;
+      case 'r':
+        rpm = atof(optarg);
+        break;
+      case 'x':
+        speed = atof(optarg);
+        break;
+      case 's':
+        seconds = atof(optarg);
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-t br24|halo] [-i address] [-r rpm] [-x speed] [-s seconds] [capture.rcap]\n", argv[0]);
+        return 1;
+    }
+  }
+  bool br24 = !strcmp(type, "br24");
+  if ((!br24 && strcmp(type, "halo")) || rpm <= 0. || speed <= 0.) {
+    fprintf(stderr, "%s: bad arguments\n", argv[0]);
+    return 1;
+  }
+
+  in_addr interface_addr;
+  if (!inet_aton(interface_name, &interface_addr)) {
+    fprintf(stderr, "%s: bad interface address %s\n", argv[0], interface_name);
+    return 1;
+  }
+
+  std::vector<Frame> frames;
+  bool replay = optind < argc;
+  if (replay) {
+    if (!ReadCapture(argv[optind], &frames)) {
+      return 1;
+    }
+  } else {
+    MakeSyntheticRotation(br24, &frames);
+  }
+
+  // Where to send: fixed groups on BR24, the groups we announce otherwise
+  uint8_t location[sizeof(report_01B2)];
+  sockaddr_in data_group;
+  sockaddr_in report_group;
+  sockaddr_in locator_group = MakeSockaddr("236.6.7.5", 6878);
+
+  memcpy(location, report_01B2, sizeof(location));
+  memcpy(location + REPORT_RADAR_ADDR, &interface_addr, 4);
+  if (br24) {
+    data_group = MakeSockaddr("236.6.7.8", 6678);
+    report_group = MakeSockaddr("236.6.7.9", 6679);
+  } else {
+    data_group = PackedToSockaddr(location + REPORT_DATA_A);
+    report_group = PackedToSockaddr(location + REPORT_REPORT_A);
+  }
+
+  int send_socket = MakeSendSocket(interface_addr);
+  int locator_socket = br24 ? -1 : MakeLocatorSocket(interface_addr, locator_group);
+  if (send_socket < 0 || (!br24 && locator_socket < 0)) {
+    fprintf(stderr, "%s: cannot set up multicast on %s: %s\n", argv[0], interface_name, strerror(errno));
+    return 1;
+  }
+
+  printf("Sending %s frames (%s) from %s to %s:%d, %g rpm x %g\n", type, replay ? argv[optind] : "synthetic", interface_name,
+         inet_ntoa(data_group.sin_addr), ntohs(data_group.sin_port), rpm, speed);
+
+  // Synthetic frames go out at 'rpm', replayed frames at their recorded pace
+  double frame_micros = 60e6 / rpm / (NAVICO_SPOKES / SPOKES_PER_FRAME) / speed;
+  int64_t start = NowMicros();
+  int64_t next_frame = start;
+  int64_t next_report = start;
+  int64_t next_print = start + 1000000;
+  size_t index = 0;
+  unsigned int scan = 0;
+  unsigned long frames_sent = 0, bytes_sent = 0, send_errors = 0, late = 0, wakes = 0;
+  unsigned long last_frames = 0, last_bytes = 0;
+
+  for (;;) {
+    int64_t now = NowMicros();
+
+    if (seconds > 0. && now - start >= (int64_t)(seconds * 1e6)) {
+      break;
+    }
+
+    // Answer wake requests, without waiting
+    if (locator_socket >= 0) {
+      uint8_t buf[1500];
+      ssize_t r;
+
+      while ((r = recv(locator_socket, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        if (r == 2 && buf[0] == 0x01 && buf[1] == 0xb1) {
+          wakes++;
+          next_report = now;
+        }
+      }
+    }
+
+    if (now >= next_report) {
+      if (!br24) {
+        sendto(send_socket, location, sizeof(location), 0, (sockaddr *)&locator_group, sizeof(locator_group));
+      }
+      sendto(send_socket, report_01C4, sizeof(report_01C4), 0, (sockaddr *)&report_group, sizeof(report_group));
+      next_report = now + REPORT_MILLIS * 1000;
+    }
+
+    if (now >= next_frame) {
+      Frame &frame = frames[index];
+
+      // Renumber, so loops of a capture do not look like lost spokes
+      size_t lines = FrameLines(frame);
+      for (size_t i = 0; i < lines; i++) {
+        Put16(FrameLine(&frame, i)->br24.scan_number, scan);
+        scan = (scan + 1) % SCAN_MAX;
+      }
+
+      if (sendto(send_socket, &frame.data[0], frame.data.size(), 0, (sockaddr *)&data_group, sizeof(data_group)) < 0) {
+        send_errors++;
+      } else {
+        frames_sent++;
+        bytes_sent += frame.data.size();
+      }
+
+      size_t next = (index + 1) % frames.size();
+      double wait = frame_micros;
+      if (replay) {
+        int64_t gap = frames[next].time - frame.time;
+        wait = (gap > 0 && gap < 1000 ? gap * 1000. : 0.) / speed;
+      }
+      index = next;
+      next_frame += (int64_t)wait;
+      if (now - next_frame > 100000) {
+        late++;  // More than 100 ms behind, do not try to catch up
+        next_frame = now;
+      }
+    }
+
+    if (now >= next_print) {
+      printf("%5.0f s: %lu frames/s, %.1f MB/s, %lu frames, %lu send errors, %lu late, %lu wakes\n", (now - start) / 1e6,
+             frames_sent - last_frames, (bytes_sent - last_bytes) / 1e6, frames_sent, send_errors, late, wakes);
+      fflush(stdout);
+      last_frames = frames_sent;
+      last_bytes = bytes_sent;
+      next_print += 1000000;
+    }
+
+    int64_t until = next_frame < next_report ? next_frame : next_report;
+    until = until < next_print ? until : next_print;
+    if (until > now) {
+      int64_t nap = until - now;
+      if (locator_socket >= 0 && nap > 10000) {
+        nap = 10000;  // Look at the locator socket often enough
+      }
+      struct timespec ts = {(time_t)(nap / 1000000), (long)(nap % 1000000) * 1000};
+      nanosleep(&ts, 0);
+    }
+  }
+
+  close(send_socket);
+  if (locator_socket >= 0) {
+    close(locator_socket);
+  }
+  return 0;
+}
@@ -41,7 +41,10 @@
 #include "MessageBox.h"
 #include "OptionsDialog.h"
 #include "RadarPanel.h"
+#include "RadarReplay.h"
 #include "SelectDialog.h"
+#include "SocketReactor.h"
+#include "SpokePipeline.h"
 #include "icons.h"
 #include "navico/NavicoLocate.h"
 #include "nmea0183.h"
@@ -284,6 +287,7 @@ int radar_pi::Init(void) {
 
   m_navico_locator = 0;
   m_raymarine_locator = 0;
+  m_reactor = 0;
 
   // Create objects before config, so config can set data in it
   // This does not start any threads or generate any UI.
@@ -332,6 +336,7 @@ int radar_pi::Init(void) {
 
   // CacheSetToolbarToolBitmaps(BM_ID_RED, BM_ID_BLANK);
   // Now that the settings are made we can initialize the RadarInfos
+  StartSocketReactor();
   for (size_t r = 0; r < M_SETTINGS.radar_count; r++) {
     m_radar[r]->Init();
     StartRadarLocators(r);
@@ -384,6 +389,7 @@ int radar_pi::Init(void) {
   LOG_VERBOSE(wxT("Initialized plugin transmit=%d/%d "), m_settings.show_radar[0], m_settings.show_radar[1]);
 
   m_notify_time_ms = 0;
+  m_telemetry_time_ms = 0;
   m_timer = new wxTimer(this, TIMER_ID);
   m_update_timer = new wxTimer(this, UPDATE_TIMER_ID);
   m_update_timer->Start(UPDATE_INTERVAL);
@@ -392,17 +398,21 @@ int radar_pi::Init(void) {
 }
 
 void radar_pi::StartRadarLocators(size_t r) {
-  if ((m_radar[r]->m_radar_type == RT_3G || m_radar[r]->m_radar_type == RT_4GA || m_radar[r]->m_radar_type == RT_HaloA ||
-       m_radar[r]->m_radar_type == RT_HaloB) &&
-      m_navico_locator == NULL) {
-    m_navico_locator = new NavicoLocate(this);
-    if (m_navico_locator->Run() != wxTHREAD_NO_ERROR) {
+  bool navico = (m_radar[r]->m_radar_type == RT_3G || m_radar[r]->m_radar_type == RT_4GA ||
+                 m_radar[r]->m_radar_type == RT_HaloA || m_radar[r]->m_radar_type == RT_HaloB) &&
+                m_navico_locator == NULL;
+  bool raymarine = (m_radar[r]->m_radar_type == RM_E120 || m_radar[r]->m_radar_type == RM_QUANTUM) && m_raymarine_locator == NULL;
+
+  StartSocketReactor();
+  if (navico) {
+    m_navico_locator = new NavicoLocate(this, m_reactor);
+    if (!m_navico_locator->Start()) {
       wxLogError(wxT("unable to start Navico Radar Locator thread"));
     }
   }
-  if ((m_radar[r]->m_radar_type == RM_E120 || m_radar[r]->m_radar_type == RM_QUANTUM) && m_raymarine_locator == NULL) {
-    m_raymarine_locator = new RaymarineLocate(this);
-    if (m_raymarine_locator->Run() != wxTHREAD_NO_ERROR) {
+  if (raymarine) {
+    m_raymarine_locator = new RaymarineLocate(this, m_reactor);
+    if (!m_raymarine_locator->Start()) {
       wxLogError(wxT("unable to start Raymarine Radar Locator thread"));
     } else {
       LOG_INFO(wxT("radar_pi Raymarine locator started"));
@@ -412,20 +422,41 @@ void radar_pi::StartRadarLocators(size_t r) {
 
 void radar_pi::StopRadarLocators() {
   if (m_navico_locator) {
-    m_navico_locator->Shutdown();
-    m_navico_locator->Wait();
+    m_navico_locator->Stop();
     delete m_navico_locator;
     m_navico_locator = 0;
   }
 
   if (m_raymarine_locator) {
-    m_raymarine_locator->Shutdown();
-    m_raymarine_locator->Wait();
+    m_raymarine_locator->Stop();
     delete m_raymarine_locator;
     m_raymarine_locator = 0;
   }
 }
 
+/*
+ * The reactor serves both the locators and the receive objects of the radars
+ * that support it, so it is started before any of them and stopped after
+ * all of them.
+ */
+void radar_pi::StartSocketReactor() {
+  if (m_settings.shared_reactor && !m_reactor && SocketReactor::IsSupported()) {
+    m_reactor = new SocketReactor();
+    if (!m_reactor->Start()) {
+      delete m_reactor;
+      m_reactor = 0;
+    }
+  }
+}
+
+void radar_pi::StopSocketReactor() {
+  if (m_reactor) {
+    m_reactor->Shutdown();
+    delete m_reactor;
+    m_reactor = 0;
+  }
+}
+
 /**
  * DeInit() is called when OpenCPN is quitting or when the user disables the plugin.
  *
@@ -462,6 +493,7 @@ bool radar_pi::DeInit(void) {
   }
 
   StopRadarLocators();
+  StopSocketReactor();
 
   if (m_bogey_dialog) {
     delete m_bogey_dialog;  // This will also save its current pos in m_settings
@@ -567,6 +599,7 @@ bool radar_pi::MakeRadarSelection() {
       }
     }
     LOG_INFO(wxT("All radars deleted by MakeRadarSelection"));
+    StopSocketReactor();
     m_settings.radar_count = 0;
     r = 0;
     for (size_t i = 0; i < RT_MAX; i++) {
@@ -577,6 +610,7 @@ bool radar_pi::MakeRadarSelection() {
           m_radar[r] = new RadarInfo(this, r);
         }
         m_radar[r]->m_radar_type = (RadarType)i;  // modify type of existing radar ?
+        m_radar[r]->m_config_radar_type = wxEmptyString;
         StartRadarLocators(r);
         r++;
         M_SETTINGS.radar_count = r;
@@ -1126,12 +1160,55 @@ void radar_pi::TimedControlUpdate() {
     wxString t;
     for (size_t r = 0; r < M_SETTINGS.radar_count; r++) {
       if (m_radar[r]->m_state.GetValue() != RADAR_OFF) {
-        wxCriticalSectionLocker lock(m_radar[r]->m_exclusive);
+        m_radar[r]->UpdateQueueStatistics();
+        wxCriticalSectionLocker lock(m_radar[r]->m_receive_exclusive);
 
         t << wxString::Format(wxT("%s\npackets %d/%d\nspokes %d/%d/%d\n"), m_radar[r]->m_name.c_str(),
                               m_radar[r]->m_statistics.packets, m_radar[r]->m_statistics.broken_packets,
                               m_radar[r]->m_statistics.spokes, m_radar[r]->m_statistics.broken_spokes,
                               m_radar[r]->m_statistics.missing_spokes);
+        if (m_radar[r]->m_statistics.reordered_spokes > 0 || m_radar[r]->m_statistics.late_spokes > 0) {
+          t << wxString::Format(wxT("reordered %d late %d\n"), m_radar[r]->m_statistics.reordered_spokes,
+                                m_radar[r]->m_statistics.late_spokes);
+        }
+        if (m_radar[r]->m_statistics.wakeups > 0) {
+          t << wxString::Format(wxT("frames/wakeup %.1f (max %d)\n"),
+                                (double)m_radar[r]->m_statistics.wakeup_frames / m_radar[r]->m_statistics.wakeups,
+                                m_radar[r]->m_statistics.max_wakeup_frames);
+        }
+        t << wxString::Format(wxT("queue %d (max %d) dropped %d\n"), m_radar[r]->m_statistics.queue_depth,
+                              m_radar[r]->m_statistics.queue_high_water, m_radar[r]->m_statistics.queue_overflows);
+
+        SpokeStageTiming timing[SPOKE_STAGES];
+        size_t stages = m_radar[r]->m_pipeline->GetTimings(timing);
+        int shown = 0;
+        t << wxT("ns/spoke");
+        for (size_t i = 0; i < stages; i++) {
+          if (timing[i].spokes > 0 || !timing[i].enabled) {
+            t << ((shown % 3 == 0) ? wxT("\n") : wxT(" "));
+            if (timing[i].enabled) {
+              t << wxString::Format(wxT("%s %d"), timing[i].name, timing[i].ns_per_spoke);
+            } else {
+              t << wxString::Format(wxT("%s off"), timing[i].name);
+            }
+            shown++;
+          }
+        }
+        t << wxT("\n");
+
+        RadarTelemetrySnapshot telemetry;
+        m_radar[r]->m_telemetry.GetSnapshot(&telemetry);
+        t << wxString::Format(wxT("%.0f pkt/s %.0f kB/s\ndecode %d/%d us (p50/p99)\n"), telemetry.packets_per_second,
+                              telemetry.bytes_per_second / 1024., telemetry.decode_p50, telemetry.decode_p99);
+        t << wxString::Format(wxT("lock wait %.1f/%d hold %.1f/%d us (mean/max)\n"), telemetry.lock_wait_mean,
+                              telemetry.lock_wait_max, telemetry.lock_hold_mean, telemetry.lock_hold_max);
+        if (telemetry.socket_drops > 0) {
+          t << wxString::Format(wxT("socket drops %lld\n"), (long long)telemetry.socket_drops);
+        }
+        wxString capture = m_radar[r]->GetCaptureStatus();
+        if (!capture.IsEmpty()) {
+          t << capture << wxT("\n");
+        }
         if (m_radar[r]->m_radar_type == RM_E120) {
           t << wxString::Format(wxT("Magnetron current %d\n"), m_radar[r]->m_magnetron_current.GetValue());
           double mag_hours = (double)m_radar[r]->m_magnetron_time.GetValue() / 10.;
@@ -1161,13 +1238,20 @@ void radar_pi::TimedControlUpdate() {
 
   // Always reset the counters, so they don't show huge numbers after IsShown changes
   for (size_t r = 0; r < M_SETTINGS.radar_count; r++) {
-    wxCriticalSectionLocker lock(m_radar[r]->m_exclusive);
+    wxCriticalSectionLocker lock(m_radar[r]->m_receive_exclusive);
 
     m_radar[r]->m_statistics.broken_packets = 0;
     m_radar[r]->m_statistics.broken_spokes = 0;
     m_radar[r]->m_statistics.missing_spokes = 0;
+    m_radar[r]->m_statistics.reordered_spokes = 0;
+    m_radar[r]->m_statistics.late_spokes = 0;
     m_radar[r]->m_statistics.packets = 0;
     m_radar[r]->m_statistics.spokes = 0;
+    m_radar[r]->m_statistics.wakeups = 0;
+    m_radar[r]->m_statistics.wakeup_frames = 0;
+    m_radar[r]->m_statistics.max_wakeup_frames = 0;
+    m_radar[r]->m_statistics.queue_high_water = 0;
+    m_radar[r]->m_statistics.queue_overflows = 0;
   }
 
   wxString info;
@@ -1252,18 +1336,25 @@ void radar_pi::TimedUpdate(wxTimerEvent& event) {
   // Update radar position offset from GPS
   if (m_heading_source != HEADING_NONE && !wxIsNaN(m_hdt)) {
     for (size_t r = 0; r < M_SETTINGS.radar_count; r++) {
-      wxCriticalSectionLocker lock(m_radar[r]->m_exclusive);
       if (m_radar[r]) {
         m_radar[r]->SetRadarPosition(m_ownship, m_hdt);
       }
     }
   }
 
+  for (size_t r = 0; r < M_SETTINGS.radar_count; r++) {
+    if (m_radar[r] && m_radar[r]->m_receive) {
+      m_radar[r]->m_receive->OnTimer();
+    }
+  }
+
   // refresh ARPA targets
   for (size_t r = 0; r < M_SETTINGS.radar_count; r++) {
     bool arpa_on = false;
     if (m_radar[r]) {
       wxCriticalSectionLocker lock(m_radar[r]->m_exclusive);
+      int64_t hold_start = RadarTelemetry::Now();
+
       if (m_radar[r]->m_arpa) {
         for (int i = 0; i < GUARD_ZONES; i++) {
           if (m_radar[r]->m_guard_zone[i]->m_arpa_on) {
@@ -1280,6 +1371,7 @@ void radar_pi::TimedUpdate(wxTimerEvent& event) {
       if (arpa_on) {
         m_radar[r]->m_arpa->RefreshArpaTargets();
       }
+      m_radar[r]->m_telemetry.AddLockHold(hold_start);
     }
   }
 
@@ -1289,8 +1381,7 @@ void radar_pi::TimedUpdate(wxTimerEvent& event) {
   bool any_data_seen = false;
   for (size_t r = 0; r < M_SETTINGS.radar_count; r++) {
     if (m_radar[r]) {
-      wxCriticalSectionLocker lock(m_radar[r]->m_exclusive);
-      int state = m_radar[r]->m_state.GetValue();  // Safe, protected by lock
+      int state = m_radar[r]->m_state.GetValue();
       if (state == RADAR_TRANSMIT) {
         any_data_seen = true;
       }
@@ -1298,6 +1389,7 @@ void radar_pi::TimedUpdate(wxTimerEvent& event) {
           || state != RADAR_TRANSMIT  // Radar not transmitting
           || !m_bpos_set) {           // No overlay possible (yet)
                                       // Conditions for ARPA not fulfilled, delete all targets
+        wxCriticalSectionLocker lock(m_radar[r]->m_exclusive);
         m_radar[r]->m_arpa->RadarLost();
       }
       m_radar[r]->UpdateTransmitState();
@@ -1310,6 +1402,38 @@ void radar_pi::TimedUpdate(wxTimerEvent& event) {
   if (m_settings.pass_heading_to_opencpn && m_heading_source >= HEADING_RADAR_HDM) {
     PassHeadingToOpenCPN();
   }
+
+  if (!m_settings.telemetry_file.IsEmpty()) {
+    wxLongLong now = wxGetUTCTimeMillis();
+    if (TIMED_OUT(now, m_telemetry_time_ms + m_settings.telemetry_interval * MILLISECONDS_PER_SECOND)) {
+      DumpTelemetry(now);
+    }
+  }
+}
+
+/*
+ * Append one JSON line per active radar with its receive telemetry to the
+ * TelemetryFile, so receive health can be watched on unattended installations.
+ */
+void radar_pi::DumpTelemetry(wxLongLong now) {
+  m_telemetry_time_ms = now;
+
+  FILE *file = fopen(m_settings.telemetry_file.mb_str(), "a");
+  if (!file) {
+    wxLogError(wxT("Cannot append telemetry to %s, disabled"), m_settings.telemetry_file.c_str());
+    m_settings.telemetry_file = wxEmptyString;
+    return;
+  }
+  for (size_t r = 0; r < M_SETTINGS.radar_count; r++) {
+    if (m_radar[r] && m_radar[r]->m_state.GetValue() != RADAR_OFF) {
+      RadarTelemetrySnapshot telemetry;
+
+      m_radar[r]->m_telemetry.GetSnapshot(&telemetry);
+      wxString line = RadarTelemetry::FormatJSON(m_radar[r]->m_name, now, telemetry);
+      fprintf(file, "%s\n", (const char *)line.mb_str());
+    }
+  }
+  fclose(file);
 }
 
 void radar_pi::UpdateAllControlStates(bool all) {
@@ -1533,6 +1657,7 @@ bool radar_pi::LoadConfig(void) {
     pConf->Read(wxT("FixedLatValue"), &m_settings.fixed_pos.lat, 0);
     pConf->Read(wxT("FixedLonValue"), &m_settings.fixed_pos.lon, 0);
     pConf->Read(wxT("RadarDescription"), &m_settings.radar_description_text, _("empty"));
+    pConf->Read(wxT("EmulatorRadars"), &m_settings.emulator_radars, 0);
 
     size_t n = 0;
     for (int r = 0; r < RADARS; r++) {
@@ -1542,6 +1667,8 @@ bool radar_pi::LoadConfig(void) {
         continue;
       }
       pConf->Read(wxString::Format(wxT("Radar%dType"), r), &s, "unknown");
+      wxString config_type = s;
+      ri->m_config_radar_type = wxEmptyString;
       ri->m_radar_type = RT_MAX;  // = not used
       for (int i = 0; i < RT_MAX; i++) {
         if (s.IsSameAs(RadarTypeName[i])) {
@@ -1549,6 +1676,23 @@ bool radar_pi::LoadConfig(void) {
           break;
         }
       }
+      pConf->Read(wxString::Format(wxT("Radar%dReplayFile"), r), &m_settings.replay_file[n], wxEmptyString);
+      pConf->Read(wxString::Format(wxT("Radar%dReplaySpeed"), r), &m_settings.replay_speed[n], 1.0);
+      if (!m_settings.replay_file[n].IsEmpty()) {
+        // The radar type is whatever the capture file was recorded with
+        RadarCaptureFileHeader header;
+        if (RadarReplay::ReadFileHeader(m_settings.replay_file[n], &header)) {
+          ri->m_radar_type = (RadarType)header.radar_type;
+          ri->m_config_radar_type = config_type;  // Not what we save
+        } else {
+          wxLogError(wxT("Radar %d: %s is not a valid radar capture file"), r + 1, m_settings.replay_file[n].c_str());
+          m_settings.replay_file[n] = wxEmptyString;
+        }
+      }
+      if (ri->m_radar_type == RT_MAX && r < m_settings.emulator_radars) {
+        ri->m_radar_type = RT_EMULATOR;  // Load testing with more than one emulator
+        ri->m_config_radar_type = config_type;  // Not what we save
+      }
       if (ri->m_radar_type == RT_MAX) {
         continue;  // This happens if someone changed the name in the config file or
                    // we drop support for a type or rename it.
@@ -1610,6 +1754,8 @@ bool radar_pi::LoadConfig(void) {
       pConf->Read(wxString::Format(wxT("Radar%dControlShow"), r), &m_settings.show_radar_control[n], false);
       pConf->Read(wxString::Format(wxT("Radar%dTargetShow"), r), &v, true);
       ri->m_target_on_ppi.Update(v);
+      pConf->Read(wxString::Format(wxT("Radar%dSpokeStagesOff"), r), &s, wxEmptyString);
+      ri->m_pipeline->SetDisabledStages(s);
 
       pConf->Read(wxString::Format(wxT("Radar%dControlPosX"), r), &x, wxDefaultPosition.x);
       pConf->Read(wxString::Format(wxT("Radar%dControlPosY"), r), &y, wxDefaultPosition.y);
@@ -1654,6 +1800,23 @@ bool radar_pi::LoadConfig(void) {
     pConf->Read(wxT("ColourDopplerReceding"), &s, "cyan");
     m_settings.doppler_receding_colour = wxColour(s);
     pConf->Read(wxT("DeveloperMode"), &m_settings.developer_mode, false);
+    pConf->Read(wxT("CaptureDirectory"), &m_settings.capture_directory, wxEmptyString);
+    pConf->Read(wxT("KernelTimestamps"), &m_settings.kernel_timestamps, false);
+    pConf->Read(wxT("NavicoReorderMillis"), &m_settings.navico_reorder_millis, 5);
+    m_settings.navico_reorder_millis = wxMax(wxMin(m_settings.navico_reorder_millis, 100), 0);
+    pConf->Read(wxT("SharedReactor"), &m_settings.shared_reactor, false);
+    pConf->Read(wxT("EmulatorSpokes"), &m_settings.emulator_spokes, EMULATOR_SPOKES);
+    m_settings.emulator_spokes = wxMax(wxMin(m_settings.emulator_spokes, SPOKES_MAX), 64);
+    pConf->Read(wxT("EmulatorSpokeLength"), &m_settings.emulator_spoke_len, EMULATOR_MAX_SPOKE_LEN);
+    m_settings.emulator_spoke_len = wxMax(wxMin(m_settings.emulator_spoke_len, SPOKE_LEN_MAX), 64);
+    pConf->Read(wxT("EmulatorRPM"), &m_settings.emulator_rpm, 24.0);
+    m_settings.emulator_rpm = wxMax(m_settings.emulator_rpm, 1.0);
+    pConf->Read(wxT("EmulatorClutter"), &m_settings.emulator_clutter, 0);
+    m_settings.emulator_clutter = wxMax(wxMin(m_settings.emulator_clutter, 100), 0);
+    pConf->Read(wxT("EmulatorScenario"), &m_settings.emulator_scenario, wxEmptyString);
+    pConf->Read(wxT("TelemetryFile"), &m_settings.telemetry_file, wxEmptyString);
+    pConf->Read(wxT("TelemetryInterval"), &m_settings.telemetry_interval, 10);
+    m_settings.telemetry_interval = wxMax(m_settings.telemetry_interval, 1);
     pConf->Read(wxT("DrawingMethod"), &m_settings.drawing_method, 1);
     pConf->Read(wxT("GuardZoneDebugInc"), &m_settings.guard_zone_debug_inc, 0);
     pConf->Read(wxT("GuardZoneOnOverlay"), &m_settings.guard_zone_on_overlay, true);
@@ -1701,6 +1864,9 @@ bool radar_pi::SaveConfig(void) {
     pConf->Write(wxT("AlarmPosX"), m_settings.alarm_pos.x);
     pConf->Write(wxT("AlarmPosY"), m_settings.alarm_pos.y);
     pConf->Write(wxT("AlertAudioFile"), m_settings.alert_audio_file);
+    if (!m_settings.capture_directory.IsEmpty()) {
+      pConf->Write(wxT("CaptureDirectory"), m_settings.capture_directory);
+    }
     pConf->Write(wxT("DeveloperMode"), m_settings.developer_mode);
     pConf->Write(wxT("DrawingMethod"), m_settings.drawing_method);
     pConf->Write(wxT("EnableCOGHeading"), m_settings.enable_cog_heading);
@@ -1711,6 +1877,21 @@ bool radar_pi::SaveConfig(void) {
     pConf->Write(wxT("GuardZonesRenderStyle"), m_settings.guard_zone_render_style);
     pConf->Write(wxT("GuardZonesThreshold"), m_settings.guard_zone_threshold);
     pConf->Write(wxT("IgnoreRadarHeading"), m_settings.ignore_radar_heading);
+    pConf->Write(wxT("KernelTimestamps"), m_settings.kernel_timestamps);
+    pConf->Write(wxT("NavicoReorderMillis"), m_settings.navico_reorder_millis);
+    pConf->Write(wxT("SharedReactor"), m_settings.shared_reactor);
+    pConf->Write(wxT("EmulatorRadars"), m_settings.emulator_radars);
+    pConf->Write(wxT("EmulatorSpokes"), m_settings.emulator_spokes);
+    pConf->Write(wxT("EmulatorSpokeLength"), m_settings.emulator_spoke_len);
+    pConf->Write(wxT("EmulatorRPM"), m_settings.emulator_rpm);
+    pConf->Write(wxT("EmulatorClutter"), m_settings.emulator_clutter);
+    if (!m_settings.emulator_scenario.IsEmpty()) {
+      pConf->Write(wxT("EmulatorScenario"), m_settings.emulator_scenario);
+    }
+    if (!m_settings.telemetry_file.IsEmpty()) {
+      pConf->Write(wxT("TelemetryFile"), m_settings.telemetry_file);
+      pConf->Write(wxT("TelemetryInterval"), m_settings.telemetry_interval);
+    }
     pConf->Write(wxT("ShowExtremeRange"), m_settings.show_extreme_range);
     pConf->Write(wxT("MenuAutoHide"), m_settings.menu_auto_hide);
     pConf->Write(wxT("HeadingTimeout"), m_settings.heading_timeout);
@@ -1749,7 +1930,11 @@ bool radar_pi::SaveConfig(void) {
     pConf->Write(wxT("TargetMixerAddress"), m_settings.target_mixer_address.to_string());
 
     for (int r = 0; r < (int)m_settings.radar_count; r++) {
-      pConf->Write(wxString::Format(wxT("Radar%dType"), r), RadarTypeName[m_radar[r]->m_radar_type]);
+      if (m_radar[r]->m_config_radar_type.IsEmpty()) {
+        pConf->Write(wxString::Format(wxT("Radar%dType"), r), RadarTypeName[m_radar[r]->m_radar_type]);
+      } else {
+        pConf->Write(wxString::Format(wxT("Radar%dType"), r), m_radar[r]->m_config_radar_type);
+      }
       pConf->Write(wxString::Format(wxT("Radar%dLocationInfo"), r), m_radar[r]->GetRadarLocationInfo().to_string());
       pConf->Write(wxString::Format(wxT("Radar%dAddress"), r), m_radar[r]->m_radar_address.FormatNetworkAddress());
       pConf->Write(wxString::Format(wxT("Radar%dInterface"), r), m_radar[r]->GetRadarInterfaceAddress().FormatNetworkAddress());
@@ -1760,6 +1945,10 @@ bool radar_pi::SaveConfig(void) {
       pConf->Write(wxString::Format(wxT("Radar%dWindowDock"), r), m_settings.dock_radar[r]);
       pConf->Write(wxString::Format(wxT("Radar%dControlShow"), r), m_settings.show_radar_control[r]);
       pConf->Write(wxString::Format(wxT("Radar%dTargetShow"), r), m_radar[r]->m_target_on_ppi.GetValue());
+      wxString stages_off = m_radar[r]->m_pipeline->GetDisabledStages();
+      if (!stages_off.IsEmpty()) {
+        pConf->Write(wxString::Format(wxT("Radar%dSpokeStagesOff"), r), stages_off);
+      }
       pConf->Write(wxString::Format(wxT("Radar%dThreshold"), r), m_radar[r]->m_threshold.GetValue());
       pConf->Write(wxString::Format(wxT("Radar%dTrailsState"), r), (int)m_radar[r]->m_target_trails.GetState());
       pConf->Write(wxString::Format(wxT("Radar%dTrails"), r), m_radar[r]->m_target_trails.GetValue());
@@ -1775,6 +1964,10 @@ bool radar_pi::SaveConfig(void) {
       pConf->Write(wxString::Format(wxT("Radar%dRunTimeOnIdle"), r), m_radar[r]->m_timed_run.GetValue());
       pConf->Write(wxString::Format(wxT("Radar%dDopplerAutoTrack"), r), m_radar[r]->m_autotrack_doppler.GetValue());
       pConf->Write(wxString::Format(wxT("Radar%dMinContourLength"), r), m_radar[r]->m_min_contour_length);
+      if (!m_settings.replay_file[r].IsEmpty()) {
+        pConf->Write(wxString::Format(wxT("Radar%dReplayFile"), r), m_settings.replay_file[r]);
+        pConf->Write(wxString::Format(wxT("Radar%dReplaySpeed"), r), m_settings.replay_speed[r]);
+      }
 
       for (int i = 0; i < MAX_CHART_CANVAS; i++) {
         pConf->Write(wxString::Format(wxT("Radar%dOverlayCanvas%d"), r, i), m_radar[r]->m_overlay_canvas[i].GetValue());
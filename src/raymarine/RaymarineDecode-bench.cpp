@@ -0,0 +1,270 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+// Microbenchmark and cross check of the Raymarine spoke decoders in
+// RaymarineDecode.cpp against the byte-by-byte loops that were used in
+// RaymarineReceive::ProcessScanData and ProcessQuantumScanData before.
+//
+// Usage: raymarine-decode-bench [spokes]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+// Build the decoders into this program, without the rest of the plugin
+#define PLUGIN_BEGIN_NAMESPACE namespace RadarPlugin {
+#define PLUGIN_END_NAMESPACE }
+#include "RaymarineDecode.cpp"
+#include "../simdutil.cpp"
+
+using namespace RadarPlugin;
+
+#define ENCODED_MAX (4096)
+
+enum DecodeFormat { FORMAT_HD, FORMAT_NON_HD, FORMAT_QUANTUM, FORMATS };
+
+static const char *format_name[FORMATS] = {"E120 HD", "E120 non-HD", "Quantum"};
+static const size_t format_returns[FORMATS] = {1024, 512, 252};
+
+struct EncodedSpoke {
+  uint8_t data[ENCODED_MAX];
+  size_t data_len;  // encoded part
+  size_t src_len;   // including unencoded tail
+};
+
+// The E120 loop from RaymarineReceive::ProcessScanData, unchanged except for
+// the unpacked buffer being passed in.
+static void LegacyDecodeE120(bool HDtype, const uint8_t *data, size_t data_len, size_t length, uint8_t *unpacked_data,
+                             unsigned int returns_per_line) {
+  uint8_t *dData = unpacked_data;
+  uint8_t *sData = (uint8_t *)data;
+  unsigned int iS = 0;
+  unsigned int iD = 0;
+  while (iS < data_len) {
+    if (HDtype) {
+      if (iD >= 1024) {
+        break;
+      }
+      if (*sData != 0x5c) {
+        *dData++ = *sData;
+        sData++;
+        iS++;
+        iD++;
+      } else {
+        uint8_t nFill = sData[1];
+        uint8_t cFill = sData[2];
+        for (unsigned int i = 0; i < nFill; i++) {
+          *dData++ = cFill;
+        }
+        sData += 3;
+        iS += 3;
+        iD += nFill;
+      }
+    } else {
+      if (*sData != 0x5c) {
+        *dData++ = (((*sData) & 0x0f) << 4) + 0x0f;
+        *dData++ = ((*sData) & 0xf0) + 0x0f;
+        sData++;
+        iS++;
+        iD += 2;
+      } else {
+        uint8_t nFill = sData[1];
+        uint8_t cFill = sData[2];
+        for (unsigned int i = 0; i < nFill; i++) {
+          *dData++ = ((cFill & 0x0f) << 4) + 0x0f;
+          *dData++ = (cFill & 0xf0) + 0x0f;
+        }
+        sData += 3;
+        iS += 3;
+        iD += nFill * 2;
+      }
+    }
+  }
+  if (iD != returns_per_line) {
+    while (iS < length && iD <= returns_per_line) {
+      if (HDtype) {
+        *dData++ = *sData;
+        sData++;
+        iS++;
+        iD++;
+      } else {
+        *dData++ = ((*sData) & 0x0f) << 4;
+        *dData++ = (*sData) & 0xf0;
+        sData++;
+        iS++;
+        iD += 2;
+      }
+    }
+  }
+}
+
+// The loop from RaymarineReceive::ProcessQuantumScanData
+static void LegacyDecodeQuantum(const uint8_t *data, size_t data_len, uint8_t *unpacked_data) {
+  uint8_t *dData = unpacked_data;
+  uint8_t *sData = (uint8_t *)data;
+  unsigned int iS = 0;
+  unsigned int iD = 0;
+  while (iS < data_len) {
+    if (iD >= 1024) {
+      break;
+    }
+    if (*sData != 0x5c) {
+      *dData++ = *sData;
+      sData++;
+      iS++;
+      iD++;
+    } else {
+      uint8_t nFill = sData[1];
+      uint8_t cFill = sData[2];
+      for (unsigned int i = 0; i < nFill; i++) {
+        *dData++ = cFill;
+      }
+      sData += 3;
+      iS += 3;
+      iD += nFill;
+    }
+  }
+}
+
+// Make a spoke that looks like radar data: runs of equal values (mostly zero)
+// between stretches of literal returns.
+static void MakeSpoke(EncodedSpoke *spoke, DecodeFormat format) {
+  size_t samples_per_byte = format == FORMAT_NON_HD ? 2 : 1;
+  size_t samples = 0;
+  size_t n = 0;
+  size_t returns = format_returns[format];
+
+  while (samples + 8 < returns && n + 300 < ENCODED_MAX) {
+    if (rand() % 3 == 0) {
+      size_t run = 2 + rand() % 60;
+      spoke->data[n++] = RAYMARINE_RLE_MARKER;
+      spoke->data[n++] = (uint8_t)run;
+      spoke->data[n++] = rand() % 4 ? 0 : (uint8_t)rand();
+      samples += run * samples_per_byte;
+    } else {
+      size_t literals = 1 + rand() % 40;
+      for (size_t i = 0; i < literals; i++) {
+        uint8_t v = (uint8_t)rand();
+        spoke->data[n++] = v == RAYMARINE_RLE_MARKER ? v + 1 : v;
+      }
+      samples += literals * samples_per_byte;
+    }
+  }
+  spoke->data_len = n;
+  if (format != FORMAT_QUANTUM) {
+    for (int i = 0; i < 4; i++) {
+      spoke->data[n++] = (uint8_t)rand();  // unencoded tail
+    }
+  }
+  spoke->src_len = n;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char **argv) {
+  int count = argc > 1 ? atoi(argv[1]) : 20000;
+  int ret = 0;
+
+  if (count <= 0) {
+    fprintf(stderr, "Usage: %s [spokes]\n", argv[0]);
+    return 1;
+  }
+  printf("vector instructions: %s\n", GetSimdName());
+
+  EncodedSpoke *spokes = (EncodedSpoke *)malloc(sizeof(EncodedSpoke) * 256);
+  uint8_t legacy[10240];
+  uint8_t decoded[1024];
+
+  for (int format = 0; format < FORMATS; format++) {
+    size_t returns = format_returns[format];
+    double ns[2] = {0, 0};
+    int mismatches = 0;
+    volatile uint8_t sink = 0;
+
+    srand(42 + format);
+    for (int i = 0; i < 256; i++) {
+      MakeSpoke(&spokes[i], (DecodeFormat)format);
+    }
+
+    for (int i = 0; i < 256; i++) {
+      EncodedSpoke *s = &spokes[i];
+      memset(legacy, 0, sizeof(legacy));
+      if (format == FORMAT_QUANTUM) {
+        LegacyDecodeQuantum(s->data, s->data_len, legacy);
+        RaymarineDecodeQuantum(s->data, s->data_len, decoded, returns);
+      } else if (format == FORMAT_HD) {
+        LegacyDecodeE120(true, s->data, s->data_len, s->src_len, legacy, returns);
+        RaymarineDecodeHD(s->data, s->data_len, s->src_len, decoded, returns);
+      } else {
+        LegacyDecodeE120(false, s->data, s->data_len, s->src_len, legacy, returns);
+        RaymarineDecodeNonHD(s->data, s->data_len, s->src_len, decoded, returns);
+      }
+      if (memcmp(legacy, decoded, returns) != 0) {
+        mismatches++;
+      }
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+      Clock::time_point start = Clock::now();
+      for (int i = 0; i < count; i++) {
+        EncodedSpoke *s = &spokes[i & 255];
+        if (pass == 0) {
+          if (format == FORMAT_QUANTUM) {
+            LegacyDecodeQuantum(s->data, s->data_len, legacy);
+          } else {
+            LegacyDecodeE120(format == FORMAT_HD, s->data, s->data_len, s->src_len, legacy, returns);
+          }
+          sink ^= legacy[i % returns];
+        } else {
+          if (format == FORMAT_QUANTUM) {
+            RaymarineDecodeQuantum(s->data, s->data_len, decoded, returns);
+          } else if (format == FORMAT_HD) {
+            RaymarineDecodeHD(s->data, s->data_len, s->src_len, decoded, returns);
+          } else {
+            RaymarineDecodeNonHD(s->data, s->data_len, s->src_len, decoded, returns);
+          }
+          sink ^= decoded[i % returns];
+        }
+      }
+      ns[pass] = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / count;
+    }
+
+    printf("%-12s legacy %7.1f ns/spoke, new %7.1f ns/spoke, speedup %.2fx, %d mismatches\n", format_name[format], ns[0], ns[1],
+           ns[0] / ns[1], mismatches);
+    if (mismatches) {
+      ret = 1;
+    }
+  }
+  free(spokes);
+  return ret;
+}
@@ -0,0 +1,147 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "RaymarineDecode.h"
+
+#include <string.h>
+
+#include "simdutil.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+// Non-HD samples are nibbles that are moved to the high half of the byte.
+// Encoded samples get 0x0f in the low half, the unencoded tail does not.
+static const uint8_t nibbleEncoded[16] = {0x0f, 0x1f, 0x2f, 0x3f, 0x4f, 0x5f, 0x6f, 0x7f,
+                                          0x8f, 0x9f, 0xaf, 0xbf, 0xcf, 0xdf, 0xef, 0xff};
+static const uint8_t nibbleTail[16] = {0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70,
+                                       0x80, 0x90, 0xa0, 0xb0, 0xc0, 0xd0, 0xe0, 0xf0};
+
+// Length of the run of literals at the start of src, up to len bytes.
+static size_t LiteralRun(const uint8_t *src, size_t len) {
+  const uint8_t *marker = (const uint8_t *)memchr(src, RAYMARINE_RLE_MARKER, len);
+  return marker ? (size_t)(marker - src) : len;
+}
+
+static size_t Min(size_t a, size_t b) { return a < b ? a : b; }
+
+// Decode a byte per sample stream. Returns the number of source bytes used in *used.
+static size_t DecodeBytes(const uint8_t *src, size_t data_len, uint8_t *dst, size_t returns_per_line, size_t *used) {
+  size_t iS = 0;
+  size_t iD = 0;
+
+  while (iS < data_len && iD < returns_per_line) {
+    if (src[iS] != RAYMARINE_RLE_MARKER) {
+      size_t n = Min(LiteralRun(src + iS, data_len - iS), returns_per_line - iD);
+      memcpy(dst + iD, src + iS, n);
+      iS += n;
+      iD += n;
+    } else {
+      if (iS + 3 > data_len) {
+        break;  // truncated run
+      }
+      size_t n = Min(src[iS + 1], returns_per_line - iD);
+      memset(dst + iD, src[iS + 2], n);
+      iS += 3;
+      iD += n;
+    }
+  }
+  *used = iS;
+  return iD;
+}
+
+size_t RaymarineDecodeHD(const uint8_t *src, size_t data_len, size_t src_len, uint8_t *dst, size_t returns_per_line) {
+  size_t iS;
+  size_t iD;
+
+  data_len = Min(data_len, src_len);
+  iD = DecodeBytes(src, data_len, dst, returns_per_line, &iS);
+
+  // Unencoded samples after the encoded data
+  size_t n = Min(src_len - iS, returns_per_line - iD);
+  memcpy(dst + iD, src + iS, n);
+  iD += n;
+
+  memset(dst + iD, 0, returns_per_line - iD);
+  return iD;
+}
+
+size_t RaymarineDecodeNonHD(const uint8_t *src, size_t data_len, size_t src_len, uint8_t *dst, size_t returns_per_line) {
+  size_t iS = 0;
+  size_t iD = 0;
+
+  data_len = Min(data_len, src_len);
+  while (iS < data_len && iD < returns_per_line) {
+    if (src[iS] != RAYMARINE_RLE_MARKER) {
+      size_t n = Min(LiteralRun(src + iS, data_len - iS), (returns_per_line - iD) / 2);
+      if (n == 0) {
+        break;  // room for one sample only
+      }
+      ExpandNibbles(nibbleEncoded, src + iS, dst + iD, n);
+      iS += n;
+      iD += 2 * n;
+    } else {
+      if (iS + 3 > data_len) {
+        break;  // truncated run
+      }
+      size_t n = Min(src[iS + 1], (returns_per_line - iD) / 2);
+      uint8_t low = nibbleEncoded[src[iS + 2] & 0x0f];
+      uint8_t high = nibbleEncoded[src[iS + 2] >> 4];
+      if (low == high) {
+        memset(dst + iD, low, 2 * n);
+      } else {
+        for (size_t i = 0; i < n; i++) {
+          dst[iD + 2 * i] = low;
+          dst[iD + 2 * i + 1] = high;
+        }
+      }
+      iS += 3;
+      iD += 2 * n;
+    }
+  }
+
+  // Unencoded samples after the encoded data
+  size_t n = Min(src_len - iS, (returns_per_line - iD) / 2);
+  ExpandNibbles(nibbleTail, src + iS, dst + iD, n);
+  iD += 2 * n;
+
+  memset(dst + iD, 0, returns_per_line - iD);
+  return iD;
+}
+
+size_t RaymarineDecodeQuantum(const uint8_t *src, size_t data_len, uint8_t *dst, size_t returns_per_line) {
+  size_t iS;
+  size_t iD = DecodeBytes(src, data_len, dst, returns_per_line, &iS);
+
+  memset(dst + iD, 0, returns_per_line - iD);
+  return iD;
+}
+
+PLUGIN_END_NAMESPACE
@@ -56,8 +56,11 @@ void RaymarineLocate::CleanupCards() {
     m_interface_addr = 0;
   }
   if (m_socket) {
-    for (size_t i = 0; i < m_interface_count; i++) {
+    for (size_t i = 0; i < m_interface_count * 2; i++) {
       if (m_socket[i] != INVALID_SOCKET) {
+        if (m_reactor) {
+          m_reactor->Remove(m_socket[i]);
+        }
         closesocket(m_socket[i]);
       }
     }
@@ -108,6 +111,13 @@ void RaymarineLocate::UpdateEthernetCards() {
           i++;
         }
       }
+
+      // Only now that the arrays are complete can OnReadable be called
+      for (i = 0; m_reactor && i < m_interface_count * 2; i++) {
+        if (m_socket[i] != INVALID_SOCKET) {
+          m_reactor->Add(m_socket[i], this);
+        }
+      }
     }
 
     freeifaddrs(addr_list);
@@ -144,6 +154,39 @@ void RaymarineLocate::UpdateEthernetCards() {
 //   }
 // }
 
+/*
+ * Start
+ *
+ * Start listening, either by adding the sockets to the reactor or by
+ * starting our own thread.
+ */
+bool RaymarineLocate::Start() {
+  if (m_reactor) {
+    m_is_shutdown = false;
+    UpdateEthernetCards();
+    m_reactor->AddHandler(this);
+    return true;
+  }
+
+  if (Create(64 * 1024) != wxTHREAD_NO_ERROR) {
+    return false;
+  }
+  SetPriority(wxPRIORITY_MAX);
+  return Run() == wxTHREAD_NO_ERROR;
+}
+
+void RaymarineLocate::Stop() {
+  if (m_reactor) {
+    m_reactor->RemoveHandler(this);
+    CleanupCards();
+    m_is_shutdown = true;
+    return;
+  }
+
+  Shutdown();
+  Wait();
+}
+
 /*
  * Entry
  *
@@ -152,18 +195,8 @@ void RaymarineLocate::UpdateEthernetCards() {
  */
 void *RaymarineLocate::Entry(void) {
   int r = 0;
-  int rescan_network_cards = 0;
   bool success = false;
 
-  union {
-    sockaddr_storage addr;
-    sockaddr_in ipv4;
-  } rx_addr;
-  socklen_t rx_len;
-
-#define MAX_DATA 500
-  uint8_t data[MAX_DATA];
-
   LOG_INFO(wxT("RaymarineLocate thread starting"));
 
   m_is_shutdown = false;
@@ -187,30 +220,18 @@ void *RaymarineLocate::Entry(void) {
     r = select(maxFd + 1, &fdin, 0, 0, &tv);
     if (r <= 0 && errno != 0) {
       UpdateEthernetCards();
-      rescan_network_cards = 0;
+      m_rescan_network_cards = 0;
     }
     if (r > 0) {
       for (size_t i = 0; i < m_interface_count * 2; i++) {
         if (m_socket[i] != INVALID_SOCKET && FD_ISSET(m_socket[i], &fdin)) {
-          rx_len = sizeof(rx_addr);
-          r = recvfrom(m_socket[i], (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
-          if (r > 2) {  // we are not interested in 2 byte messages
-            if (r > MAX_DATA) wxLogError(wxT("Buffer overflow on reading Raymarine Locate"));
-            NetworkAddress radar_address;
-            radar_address.addr = rx_addr.ipv4.sin_addr;
-            radar_address.port = rx_addr.ipv4.sin_port;
-            if (ProcessReport(radar_address, m_interface_addr[i], data, (size_t)r)) {
-              rescan_network_cards = -PERIOD_UNTIL_CARD_REFRESH;  // Give double time until we rescan
-              success = true;
-            }
+          if (ReceiveReport(i)) {
+            success = true;
           }
         }
       }
     } else {  // no data received -> select timeout
-      if (++rescan_network_cards >= PERIOD_UNTIL_CARD_REFRESH) {
-        UpdateEthernetCards();
-        rescan_network_cards = 0;
-      }
+      OnTick();
     }
 
   }  // endless loop until thread destroy
@@ -223,6 +244,57 @@ void *RaymarineLocate::Entry(void) {
   return 0;
 }
 
+void RaymarineLocate::OnReadable(SOCKET socket) {
+  for (size_t i = 0; i < m_interface_count * 2; i++) {
+    if (m_socket[i] == socket) {
+      if (ReceiveReport(i)) {
+        // Same as the thread: stop once the radar has been found
+        m_reactor->RemoveHandler(this);
+        CleanupCards();
+        LOG_INFO(wxT("Raymarine locate stopped after success"));
+      }
+      return;
+    }
+  }
+}
+
+/*
+ * Called once a second without reports by Entry, or every second by the reactor.
+ */
+void RaymarineLocate::OnTick() {
+  if (++m_rescan_network_cards >= PERIOD_UNTIL_CARD_REFRESH) {
+    UpdateEthernetCards();
+    m_rescan_network_cards = 0;
+  }
+}
+
+/*
+ * Read one report from socket i. Returns true when it contained the location of a radar.
+ */
+bool RaymarineLocate::ReceiveReport(size_t i) {
+  union {
+    sockaddr_storage addr;
+    sockaddr_in ipv4;
+  } rx_addr;
+  socklen_t rx_len = sizeof(rx_addr);
+
+#define MAX_DATA 500
+  uint8_t data[MAX_DATA];
+
+  int r = recvfrom(m_socket[i], (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
+  if (r > 2) {  // we are not interested in 2 byte messages
+    if (r > MAX_DATA) wxLogError(wxT("Buffer overflow on reading Raymarine Locate"));
+    NetworkAddress radar_address;
+    radar_address.addr = rx_addr.ipv4.sin_addr;
+    radar_address.port = rx_addr.ipv4.sin_port;
+    if (ProcessReport(radar_address, m_interface_addr[i], data, (size_t)r)) {
+      m_rescan_network_cards = -PERIOD_UNTIL_CARD_REFRESH;  // Give double time until we rescan
+      return true;
+    }
+  }
+  return false;
+}
+
 #pragma pack(push, 1)
 
 struct LocationInfoBlock {
@@ -38,6 +38,7 @@
 
 #include "MessageBox.h"
 #include "RME120Control.h"
+#include "RaymarineDecode.h"
 
 PLUGIN_BEGIN_NAMESPACE
 
@@ -153,6 +154,10 @@ SOCKET RaymarineReceive::GetNewReportSocket() {
   wxString rep_addr = m_info.report_addr.FormatNetworkAddressPort();
   if (socket != INVALID_SOCKET) {
     LOG_RECEIVE(wxT("%s scanning interface %s for data from %s"), m_ri->m_name, addr.c_str(), rep_addr.c_str());
+    if (m_pi->m_settings.kernel_timestamps && !socketEnableTimestamps(socket)) {
+      LOG_INFO(wxT("%s cannot enable receive timestamps on report socket"), m_ri->m_name.c_str());
+    }
+    socketEnableDropCounter(socket);
 
     s << _("Scanning interface") << wxT(" ") << addr;
     SetInfoStatus(s);
@@ -205,6 +210,10 @@ void *RaymarineReceive::Entry(void) {
         if (m_comm_socket != INVALID_SOCKET) {
           int one = 1;
           setsockopt(m_comm_socket, SOL_SOCKET, SO_REUSEADDR, (const char *)&one, sizeof(one));
+          if (m_pi->m_settings.kernel_timestamps && !socketEnableTimestamps(m_comm_socket)) {
+            LOG_INFO(wxT("%s cannot enable receive timestamps on report socket"), m_ri->m_name.c_str());
+          }
+          socketEnableDropCounter(m_comm_socket);
           m_ri->m_control->RadarStayAlive();
           last_keepalive = time(0);
         }
@@ -244,14 +253,18 @@ void *RaymarineReceive::Entry(void) {
       }
 
       if (m_comm_socket != INVALID_SOCKET && FD_ISSET(m_comm_socket, &fdin)) {
+        wxLongLong time_rec;
+        uint32_t drops;
         rx_len = sizeof(rx_addr);
-        r = recvfrom(m_comm_socket, (char *)data, sizeof(data), 0, (struct sockaddr *)&rx_addr, &rx_len);
+        r = socketReceive(m_comm_socket, data, sizeof(data), (struct sockaddr *)&rx_addr, &rx_len, &time_rec, &drops);
         if (r > 0) {
           NetworkAddress radar_address;
           radar_address.addr = rx_addr.ipv4.sin_addr;
           radar_address.port = rx_addr.ipv4.sin_port;
 
-          ProcessFrame(data, (size_t)r);
+          int64_t start = RadarTelemetry::Now();
+          ProcessFrame(data, (size_t)r, time_rec, radar_address);
+          m_ri->m_telemetry.AddFrame((size_t)r, start, drops);
           if (!radar_addr) {
             wxCriticalSectionLocker lock(m_lock);
             m_ri->DetectedRadar(m_interface_addr,
@@ -329,6 +342,7 @@ void *RaymarineReceive::Entry(void) {
   }
   if (m_receive_socket != INVALID_SOCKET) {
     closesocket(m_receive_socket);
+    m_receive_socket = INVALID_SOCKET;
   }
 
   if (m_interface_array) {
@@ -345,7 +359,8 @@ void *RaymarineReceive::Entry(void) {
   return 0;
 }
 
-void RaymarineReceive::ProcessFrame(const UINT8 *data, size_t len) {  // This is the original ProcessFrame from RMradar_pi
+// This is the original ProcessFrame from RMradar_pi
+void RaymarineReceive::ProcessFrame(const UINT8 *data, size_t len, wxLongLong time_rec, const NetworkAddress &source) {
   time_t now = time(0);
   wxString MOD_serial;
   wxString IF_serial;
@@ -354,6 +369,7 @@ void RaymarineReceive::ProcessFrame(const UINT8 *data, size_t len) {  // This is
   int status;
   wxString stat;
   // LOG_BINARY_RECEIVE(wxT("received frame"), data, len);
+  m_ri->CaptureFrame(data, len, time_rec, source);
   m_ri->resetTimeout(now);
   m_ri->m_radar_timeout = now + WATCHDOG_TIMEOUT;
   m_ri->m_statistics.packets++;
@@ -368,11 +384,11 @@ void RaymarineReceive::ProcessFrame(const UINT8 *data, size_t len) {  // This is
         ProcessFixedReport(data, len);
         break;
       case 0x00010003:
-        ProcessScanData(data, len);
+        ProcessScanData(data, len, time_rec);
         m_ri->m_data_timeout = now + DATA_TIMEOUT;
         break;
       case 0x00280003:
-        ProcessQuantumScanData(data, len);
+        ProcessQuantumScanData(data, len, time_rec);
         m_ri->m_data_timeout = now + DATA_TIMEOUT;
         break;
       case 0x00280002:
@@ -896,7 +912,7 @@ struct SpokeData {
   uint32_t data_len;
 };
 
-void RaymarineReceive::ProcessScanData(const UINT8 *data, int len) {
+void RaymarineReceive::ProcessScanData(const UINT8 *data, int len, wxLongLong time_rec) {
   if (m_range_meters == 1) {
     LOG_RECEIVE(wxT("Invalid range"));
     return;
@@ -921,11 +937,10 @@ void RaymarineReceive::ProcessScanData(const UINT8 *data, int len) {
     if (pHeader->fieldx_4 == 0x400) {
       LOG_RECEIVE(wxT(" different radar type found"));
     }
-    wxLongLong nowMillis = wxGetLocalTimeMillis();
     int headerIdx = 0;
     int nextOffset = sizeof(Header1);
 
-    while (nextOffset < len) {
+    while (nextOffset + (int)sizeof(Header3) + (int)sizeof(Header2) <= len) {
       Header3 *sHeader = (Header3 *)(data + nextOffset);
       if (sHeader->field01 != 0x00000001 || sHeader->length != 0x00000028) {
         LOG_RECEIVE(wxT("ProcessScanData::Scan header #%d (%d) - %x, %x.\n"), headerIdx, nextOffset, sHeader->field01,
@@ -952,78 +967,35 @@ void RaymarineReceive::ProcessScanData(const UINT8 *data, int len) {
         if (nHeader->length != 0x0000001c) {
           LOG_RECEIVE(wxT("ProcessScanData::Opt header #%d part 2 check failed.\n"), headerIdx);
         }
+        if (nHeader->length > (uint32_t)len) {
+          break;
+        }
         nextOffset += nHeader->length;
       }
+      if (nextOffset + (int)sizeof(SpokeData) > len) {
+        LOG_RECEIVE(wxT("ProcessScanData::Scan data header #%d truncated.\n"), headerIdx);
+        break;
+      }
       SpokeData *pSData = (SpokeData *)(data + nextOffset);
       if ((pSData->field01 & 0x7fffffff) != 0x00000003 || pSData->length < pSData->data_len + 8) {
         LOG_RECEIVE(wxT("ProcessScanData::Scan data header #%d check failed %x, %d, %d.\n"), headerIdx, pSData->field01,
                     pSData->length, pSData->data_len);
         break;
       }
-      UINT8 unpacked_data[10240], *dataPtr = 0;
-
-      uint8_t *dData = (uint8_t *)unpacked_data;
-      uint8_t *sData = (uint8_t *)data + nextOffset + sizeof(SpokeData);
+      // Samples after data_len up to the end of the record are sent unencoded
+      size_t src_len = pSData->length - 8;
+      size_t avail = len - nextOffset - sizeof(SpokeData);
+      if (src_len > avail) {
+        src_len = avail;
+      }
+      const uint8_t *sData = data + nextOffset + sizeof(SpokeData);
+      UINT8 unpacked_data[RM_E120_SPOKE_LEN], *dataPtr = 0;
 
-      unsigned int iS = 0;
-      unsigned int iD = 0;
       // LOG_BINARY_RECEIVE(wxT("spoke data sData"), sData, pSData->data_len);
-      while (iS < pSData->data_len) {
-        if (HDtype) {
-          if (iD >= 1024) {  // remove trailing zero's
-            break;
-          }
-          if (*sData != 0x5c) {
-            *dData++ = *sData;
-            sData++;
-            iS++;
-            iD++;
-          } else {
-            uint8_t nFill = sData[1];  // number to be filled
-            uint8_t cFill = sData[2];  // data to be filled
-            for (unsigned int i = 0; i < nFill; i++) {
-              *dData++ = cFill;
-            }
-            sData += 3;
-            iS += 3;
-            iD += nFill;
-          }
-        } else {  // not HDtype
-          if (*sData != 0x5c) {
-            *dData++ = (((*sData) & 0x0f) << 4) + 0x0f;
-            *dData++ = ((*sData) & 0xf0) + 0x0f;
-            sData++;
-            iS++;
-            iD += 2;
-          } else {
-            uint8_t nFill = sData[1];
-            uint8_t cFill = sData[2];
-
-            for (unsigned int i = 0; i < nFill; i++) {
-              *dData++ = ((cFill & 0x0f) << 4) + 0x0f;
-              *dData++ = (cFill & 0xf0) + 0x0f;
-            }
-            sData += 3;
-            iS += 3;
-            iD += nFill * 2;
-          }
-        }
-      }
-      if (iD != returns_per_line) {
-        while (iS < pSData->length - 8 && iD <= returns_per_line) {
-          if (HDtype) {
-            *dData++ = *sData;
-            sData++;
-            iS++;
-            iD++;
-          } else {
-            *dData++ = ((*sData) & 0x0f) << 4;
-            *dData++ = (*sData) & 0xf0;
-            sData++;
-            iS++;
-            iD += 2;
-          }
-        }
+      if (HDtype) {
+        RaymarineDecodeHD(sData, pSData->data_len, src_len, unpacked_data, returns_per_line);
+      } else {
+        RaymarineDecodeNonHD(sData, pSData->data_len, src_len, unpacked_data, returns_per_line);
       }
 
       // LOG_BINARY_RECEIVE(wxT("spoke data dData"), unpacked_data, pSData->data_len);
@@ -1069,10 +1041,10 @@ void RaymarineReceive::ProcessScanData(const UINT8 *data, int len) {
       }
       /*LOG_INFO(wxT("ProcessRadarSpoke a=%i, angle_raw=%i b=%i, bearing_raw=%i, returns_per_line=%i range=%i spokes=%i"), angle,
          angle_raw, bearing, bearing_raw, returns_per_line, m_range_meters, m_ri->m_spokes);*/
-      m_ri->ProcessRadarSpoke(angle, bearing, dataPtr, returns_per_line, m_range_meters, nowMillis);
+      m_ri->QueueRadarSpoke(angle, bearing, dataPtr, returns_per_line, m_range_meters, time_rec);
       // When te HD radar is transmitting in a mode with 1024 spokes, insert additional spokes to fill the image
       if (spokes_1024 && angle + 1 < (int)m_ri->m_spokes && bearing + 1 < (int)m_ri->m_spokes) {
-        m_ri->ProcessRadarSpoke(angle + 1, bearing + 1, dataPtr, returns_per_line, m_range_meters, nowMillis);
+        m_ri->QueueRadarSpoke(angle + 1, bearing + 1, dataPtr, returns_per_line, m_range_meters, time_rec);
       }
     }
   }
@@ -1100,7 +1072,7 @@ struct SQuantumScanDataHeader {
   uint16_t data_len;
 };
 
-void RaymarineReceive::ProcessQuantumScanData(const UINT8 *data, int len) {
+void RaymarineReceive::ProcessQuantumScanData(const UINT8 *data, int len, wxLongLong time_rec) {
   if (m_range_meters == 1) {
     LOG_RECEIVE(wxT("Invalid range"));
     return;
@@ -1115,42 +1087,22 @@ void RaymarineReceive::ProcessQuantumScanData(const UINT8 *data, int len) {
     m_ri->m_data_timeout = now + DATA_TIMEOUT;
     m_ri->m_state.Update(RADAR_TRANSMIT);
 
-    wxLongLong nowMillis = wxGetLocalTimeMillis();
-    int nextOffset = sizeof(QuantumHeader);
-    UINT8 unpacked_data[1024], *dataPtr = 0;
-
-    uint8_t *dData = (uint8_t *)unpacked_data;
-    uint8_t *sData = (uint8_t *)data + nextOffset;
-
-    unsigned int iS = 0;
-    unsigned int iD = 0;
-    while (iS < qheader->data_len) {
-      if (iD >= 1024) {  // remove trailing zero's
-        break;
-      }
-      if (*sData != 0x5c) {
-        *dData++ = *sData;
-        sData++;
-        iS++;
-        iD++;
-      } else {
-        uint8_t nFill = sData[1];  // number to be filled
-        uint8_t cFill = sData[2];  // data to be filled
-        for (unsigned int i = 0; i < nFill; i++) {
-          *dData++ = cFill;
-        }
-        sData += 3;
-        iS += 3;
-        iD += nFill;
-      }
-    }  // end of while, only one spoke per packet
-
     returns_per_line = qheader->scan_len;
     if (returns_per_line > RM_QUANTUM_SPOKE_LEN) {
       LOG_VERBOSE(wxT("Error returns_per_line too large %i"), returns_per_line);
       returns_per_line = RM_QUANTUM_SPOKE_LEN;
     }
-    dataPtr = unpacked_data;
+    size_t data_len = qheader->data_len;
+    if (data_len > len - sizeof(QuantumHeader)) {
+      data_len = len - sizeof(QuantumHeader);
+    }
+    UINT8 unpacked_data[RM_QUANTUM_SPOKE_LEN], *dataPtr = 0;
+
+    dataPtr = m_ri->ReserveRadarSpoke(returns_per_line);  // Decode straight into the spoke queue
+    if (!dataPtr) {
+      dataPtr = unpacked_data;
+    }
+    RaymarineDecodeQuantum(data + sizeof(QuantumHeader), data_len, dataPtr, returns_per_line);  // only one spoke per packet
     m_ri->m_statistics.spokes++;
     unsigned int spoke = qheader->azimuth;
     if (m_next_spoke >= 0 && (int)spoke != m_next_spoke) {
@@ -1189,8 +1141,8 @@ void RaymarineReceive::ProcessQuantumScanData(const UINT8 *data, int len) {
       LOG_INFO(wxT("Error range invalid"));
       return;
     }
-    m_ri->ProcessRadarSpoke(angle, bearing, dataPtr, returns_per_line,
-                            m_range_meters * returns_per_line / qheader->returns_per_range / 2, nowMillis);
+    m_ri->QueueRadarSpoke(angle, bearing, dataPtr, returns_per_line,
+                            m_range_meters * returns_per_line / qheader->returns_per_range / 2, time_rec);
   }
 }
 
@@ -0,0 +1,392 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "simdutil.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SIMD_X86
+#include <tmmintrin.h>  // SSSE3, includes SSE2
+#ifdef _MSC_VER
+#include <intrin.h>  // __cpuid
+#define SIMD_TARGET_SSSE3
+#else
+#define SIMD_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_NEON
+#define SIMD_NEON_A64
+#include <arm_neon.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM)
+#define SIMD_NEON  // 32 bit ARM built with NEON enabled, e.g. -mfpu=neon
+#include <arm_neon.h>
+#endif
+
+PLUGIN_BEGIN_NAMESPACE
+
+typedef void (*ExpandNibblesFunction)(const uint8_t table[16], const uint8_t *src, uint8_t *dst, size_t len);
+typedef void (*ExpandBitsFunction)(const uint8_t *src, uint8_t *dst, size_t len);
+typedef size_t (*ConditionSpokeFunction)(uint8_t *data, size_t len, size_t main_bang, uint8_t threshold, uint8_t strong,
+                                         uint64_t *strong_bits, uint64_t *doppler_bits, size_t words);
+typedef void (*MaxPool2x2Function)(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t len);
+
+static uint8_t bitsToBytes[256][8];  // Filled when the dispatch is set up
+
+static void ExpandNibblesScalar(const uint8_t table[16], const uint8_t *src, uint8_t *dst, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    dst[2 * i] = table[src[i] & 0x0f];
+    dst[2 * i + 1] = table[src[i] >> 4];
+  }
+}
+
+static void ExpandBitsScalar(const uint8_t *src, uint8_t *dst, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    memcpy(dst + 8 * i, bitsToBytes[src[i]], 8);
+  }
+}
+
+static size_t ConditionSpokeScalar(uint8_t *data, size_t len, size_t main_bang, uint8_t threshold, uint8_t strong,
+                                   uint64_t *strong_bits, uint64_t *doppler_bits, size_t words) {
+  size_t doppler = 0;
+  size_t w = 0;
+
+  for (size_t i = 0; i < len; i += 64, w++) {
+    size_t end = len - i < 64 ? len : i + 64;
+    uint64_t s = 0;
+    uint64_t d = 0;
+
+    for (size_t j = i; j < end; j++) {
+      uint8_t v = (j < main_bang || data[j] < threshold) ? 0 : data[j];
+      uint64_t bit = (uint64_t)1 << (j - i);
+
+      if (v >= strong) {
+        s |= bit;
+      }
+      if (v == 255) {
+        s |= bit;
+        d |= bit;
+        doppler++;
+      }
+      data[j] = v;
+    }
+    strong_bits[w] = s;
+    doppler_bits[w] = d;
+  }
+  for (; w < words; w++) {
+    strong_bits[w] = 0;
+    doppler_bits[w] = 0;
+  }
+  return doppler;
+}
+
+static void MaxPool2x2Scalar(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t len) {
+  size_t i = 0;
+
+  for (; i + 2 <= len; i += 2) {
+    uint8_t m = a[i] > a[i + 1] ? a[i] : a[i + 1];
+    uint8_t n = b[i] > b[i + 1] ? b[i] : b[i + 1];
+    dst[i / 2] = m > n ? m : n;
+  }
+  if (i < len) {
+    dst[i / 2] = a[i] > b[i] ? a[i] : b[i];
+  }
+}
+
+#ifdef SIMD_X86
+
+static bool HasSSSE3() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 9)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("ssse3") != 0;
+#endif
+}
+
+SIMD_TARGET_SSSE3 static void ExpandNibblesSSSE3(const uint8_t table[16], const uint8_t *src, uint8_t *dst, size_t len) {
+  const __m128i lut = _mm_loadu_si128((const __m128i *)table);
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+    __m128i low = _mm_shuffle_epi8(lut, _mm_and_si128(in, mask));
+    __m128i high = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+    _mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi8(low, high));
+    _mm_storeu_si128((__m128i *)(dst + 2 * i + 16), _mm_unpackhi_epi8(low, high));
+  }
+  ExpandNibblesScalar(table, src + i, dst + 2 * i, len - i);
+}
+
+SIMD_TARGET_SSSE3 static void ExpandBitsSSSE3(const uint8_t *src, uint8_t *dst, size_t len) {
+  const __m128i bits = _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+  __m128i spread = _mm_set_epi8(1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i two = _mm_set1_epi8(2);
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+    __m128i index = spread;
+    for (int j = 0; j < 8; j++) {
+      // Copy two source bytes into the low and high half, then test one bit per byte
+      __m128i v = _mm_and_si128(_mm_shuffle_epi8(in, index), bits);
+      _mm_storeu_si128((__m128i *)(dst + 8 * i + 16 * j), _mm_cmpeq_epi8(v, bits));
+      index = _mm_add_epi8(index, two);
+    }
+  }
+  ExpandBitsScalar(src + i, dst + 8 * i, len - i);
+}
+
+SIMD_TARGET_SSSE3 static size_t ConditionSpokeSSSE3(uint8_t *data, size_t len, size_t main_bang, uint8_t threshold,
+                                                    uint8_t strong, uint64_t *strong_bits, uint64_t *doppler_bits, size_t words) {
+  const __m128i all = _mm_set1_epi8(-1);
+  const __m128i thresholds = _mm_set1_epi8((char)threshold);
+  const __m128i strongs = _mm_set1_epi8((char)strong);
+  size_t doppler = 0;
+  size_t i = 0;
+  size_t w = 0;
+
+  if (main_bang > len) {
+    main_bang = len;
+  }
+  memset(data, 0, main_bang);  // Only a few dozen bytes, the loop below passes the zeros through
+
+  for (; i + 64 <= len; i += 64, w++) {
+    uint64_t s = 0;
+    uint64_t d = 0;
+
+    for (int k = 0; k < 4; k++) {
+      __m128i v = _mm_loadu_si128((const __m128i *)(data + i + 16 * k));
+      // Unsigned a >= b is max(a, b) == a
+      v = _mm_and_si128(v, _mm_cmpeq_epi8(_mm_max_epu8(v, thresholds), v));
+      _mm_storeu_si128((__m128i *)(data + i + 16 * k), v);
+      __m128i is_doppler = _mm_cmpeq_epi8(v, all);
+      __m128i is_strong = _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, strongs), v), is_doppler);
+      s |= (uint64_t)(uint16_t)_mm_movemask_epi8(is_strong) << (16 * k);
+      d |= (uint64_t)(uint16_t)_mm_movemask_epi8(is_doppler) << (16 * k);
+    }
+    strong_bits[w] = s;
+    doppler_bits[w] = d;
+    doppler += PopCount64(d);
+  }
+
+  return doppler + ConditionSpokeScalar(data + i, len - i, 0, threshold, strong, strong_bits + w, doppler_bits + w, words - w);
+}
+
+SIMD_TARGET_SSSE3 static void MaxPool2x2SSSE3(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t len) {
+  const __m128i low_bytes = _mm_set1_epi16(0x00ff);
+  size_t i = 0;
+
+  for (; i + 32 <= len; i += 32) {
+    __m128i v0 = _mm_max_epu8(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i)));
+    __m128i v1 = _mm_max_epu8(_mm_loadu_si128((const __m128i *)(a + i + 16)), _mm_loadu_si128((const __m128i *)(b + i + 16)));
+    // Each 16 bit lane holds a pair of samples, pool them into its low byte
+    v0 = _mm_max_epu8(_mm_and_si128(v0, low_bytes), _mm_srli_epi16(v0, 8));
+    v1 = _mm_max_epu8(_mm_and_si128(v1, low_bytes), _mm_srli_epi16(v1, 8));
+    _mm_storeu_si128((__m128i *)(dst + i / 2), _mm_packus_epi16(v0, v1));
+  }
+  MaxPool2x2Scalar(a + i, b + i, dst + i / 2, len - i);
+}
+
+#endif
+
+#ifdef SIMD_NEON
+
+// table[index] for 16 indices below 16. 32 bit ARM has no 16 byte table
+// lookup, so it looks up both halves in the table as a pair of 8 byte registers.
+static inline uint8x16_t TableLookupNEON(uint8x16_t table, uint8x16_t index) {
+#ifdef SIMD_NEON_A64
+  return vqtbl1q_u8(table, index);
+#else
+  uint8x8x2_t pair;
+  pair.val[0] = vget_low_u8(table);
+  pair.val[1] = vget_high_u8(table);
+  return vcombine_u8(vtbl2_u8(pair, vget_low_u8(index)), vtbl2_u8(pair, vget_high_u8(index)));
+#endif
+}
+
+static void ExpandNibblesNEON(const uint8_t table[16], const uint8_t *src, uint8_t *dst, size_t len) {
+  const uint8x16_t lut = vld1q_u8(table);
+  const uint8x16_t mask = vdupq_n_u8(0x0f);
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    uint8x16_t in = vld1q_u8(src + i);
+    uint8x16x2_t out;
+    out.val[0] = TableLookupNEON(lut, vandq_u8(in, mask));
+    out.val[1] = TableLookupNEON(lut, vshrq_n_u8(in, 4));
+    vst2q_u8(dst + 2 * i, out);  // interleaves low, high
+  }
+  ExpandNibblesScalar(table, src + i, dst + 2 * i, len - i);
+}
+
+static void ExpandBitsNEON(const uint8_t *src, uint8_t *dst, size_t len) {
+  static const uint8_t bit_table[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  static const uint8_t spread_table[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1};
+  const uint8x16_t bits = vld1q_u8(bit_table);
+  const uint8x16_t two = vdupq_n_u8(2);
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    uint8x16_t in = vld1q_u8(src + i);
+    uint8x16_t index = vld1q_u8(spread_table);
+    for (int j = 0; j < 8; j++) {
+      vst1q_u8(dst + 8 * i + 16 * j, vtstq_u8(TableLookupNEON(in, index), bits));
+      index = vaddq_u8(index, two);
+    }
+  }
+  ExpandBitsScalar(src + i, dst + 8 * i, len - i);
+}
+
+// One bit per byte of a compare result, like _mm_movemask_epi8
+static inline uint64_t MoveMaskNEON(uint8x16_t v) {
+  static const uint8_t weight_table[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t m = vandq_u8(v, vld1q_u8(weight_table));
+#ifdef SIMD_NEON_A64
+  return (uint64_t)vaddv_u8(vget_low_u8(m)) | ((uint64_t)vaddv_u8(vget_high_u8(m)) << 8);
+#else
+  // No horizontal add: three pairwise adds leave the sum of each half in lanes 0 and 1
+  uint8x8_t sum = vpadd_u8(vget_low_u8(m), vget_high_u8(m));
+  sum = vpadd_u8(sum, sum);
+  sum = vpadd_u8(sum, sum);
+  return (uint64_t)vget_lane_u8(sum, 0) | ((uint64_t)vget_lane_u8(sum, 1) << 8);
+#endif
+}
+
+static size_t ConditionSpokeNEON(uint8_t *data, size_t len, size_t main_bang, uint8_t threshold, uint8_t strong,
+                                 uint64_t *strong_bits, uint64_t *doppler_bits, size_t words) {
+  const uint8x16_t all = vdupq_n_u8(255);
+  const uint8x16_t thresholds = vdupq_n_u8(threshold);
+  const uint8x16_t strongs = vdupq_n_u8(strong);
+  size_t doppler = 0;
+  size_t i = 0;
+  size_t w = 0;
+
+  if (main_bang > len) {
+    main_bang = len;
+  }
+  memset(data, 0, main_bang);  // Only a few dozen bytes, the loop below passes the zeros through
+
+  for (; i + 64 <= len; i += 64, w++) {
+    uint64_t s = 0;
+    uint64_t d = 0;
+
+    for (int k = 0; k < 4; k++) {
+      uint8x16_t v = vld1q_u8(data + i + 16 * k);
+      v = vandq_u8(v, vcgeq_u8(v, thresholds));
+      vst1q_u8(data + i + 16 * k, v);
+      uint8x16_t is_doppler = vceqq_u8(v, all);
+      s |= MoveMaskNEON(vorrq_u8(vcgeq_u8(v, strongs), is_doppler)) << (16 * k);
+      d |= MoveMaskNEON(is_doppler) << (16 * k);
+    }
+    strong_bits[w] = s;
+    doppler_bits[w] = d;
+    doppler += PopCount64(d);
+  }
+
+  return doppler + ConditionSpokeScalar(data + i, len - i, 0, threshold, strong, strong_bits + w, doppler_bits + w, words - w);
+}
+
+static void MaxPool2x2NEON(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t len) {
+  size_t i = 0;
+
+  for (; i + 32 <= len; i += 32) {
+    // vld2 splits even and odd samples
+    uint8x16x2_t va = vld2q_u8(a + i);
+    uint8x16x2_t vb = vld2q_u8(b + i);
+    vst1q_u8(dst + i / 2, vmaxq_u8(vmaxq_u8(va.val[0], va.val[1]), vmaxq_u8(vb.val[0], vb.val[1])));
+  }
+  MaxPool2x2Scalar(a + i, b + i, dst + i / 2, len - i);
+}
+
+#endif
+
+struct SimdDispatch {
+  const char *name;
+  ExpandNibblesFunction expand_nibbles;
+  ExpandBitsFunction expand_bits;
+  ConditionSpokeFunction condition_spoke;
+  MaxPool2x2Function max_pool_2x2;
+
+  SimdDispatch() {
+    for (int i = 0; i < 256; i++) {
+      for (int bit = 0; bit < 8; bit++) {
+        bitsToBytes[i][bit] = (i & (1 << bit)) ? 255 : 0;
+      }
+    }
+
+    name = "none";
+    expand_nibbles = ExpandNibblesScalar;
+    expand_bits = ExpandBitsScalar;
+    condition_spoke = ConditionSpokeScalar;
+    max_pool_2x2 = MaxPool2x2Scalar;
+#if defined(SIMD_X86)
+    if (HasSSSE3()) {
+      name = "SSSE3";
+      expand_nibbles = ExpandNibblesSSSE3;
+      expand_bits = ExpandBitsSSSE3;
+      condition_spoke = ConditionSpokeSSSE3;
+      max_pool_2x2 = MaxPool2x2SSSE3;
+    }
+#elif defined(SIMD_NEON)
+    name = "NEON";  // Always present on AArch64, and the build enabled it on 32 bit ARM
+    expand_nibbles = ExpandNibblesNEON;
+    expand_bits = ExpandBitsNEON;
+    condition_spoke = ConditionSpokeNEON;
+    max_pool_2x2 = MaxPool2x2NEON;
+#endif
+  }
+};
+
+static const SimdDispatch &GetDispatch() {
+  static const SimdDispatch dispatch;  // Initialized once, thread safe
+  return dispatch;
+}
+
+const char *GetSimdName() { return GetDispatch().name; }
+
+void ExpandNibbles(const uint8_t table[16], const uint8_t *src, uint8_t *dst, size_t len) {
+  GetDispatch().expand_nibbles(table, src, dst, len);
+}
+
+void ExpandBits(const uint8_t *src, uint8_t *dst, size_t len) { GetDispatch().expand_bits(src, dst, len); }
+
+size_t ConditionSpoke(uint8_t *data, size_t len, size_t main_bang, uint8_t threshold, uint8_t strong, uint64_t *strong_bits,
+                      uint64_t *doppler_bits, size_t words) {
+  return GetDispatch().condition_spoke(data, len, main_bang, threshold, strong, strong_bits, doppler_bits, words);
+}
+
+void MaxPool2x2(const uint8_t *a, const uint8_t *b, uint8_t *dst, size_t len) { GetDispatch().max_pool_2x2(a, b, dst, len); }
+
+PLUGIN_END_NAMESPACE
@@ -277,6 +277,103 @@ SOCKET GetLocalhostSendTCPSocket(SOCKET server) {
   return client;
 }
 
+bool socketEnableTimestamps(SOCKET sockfd) {
+  int one = 1;
+
+#if defined(SO_TIMESTAMPNS)
+  return setsockopt(sockfd, SOL_SOCKET, SO_TIMESTAMPNS, (const char *)&one, sizeof(one)) == 0;
+#elif defined(SO_TIMESTAMP)
+  return setsockopt(sockfd, SOL_SOCKET, SO_TIMESTAMP, (const char *)&one, sizeof(one)) == 0;
+#else
+  return false;
+#endif
+}
+
+bool socketEnableDropCounter(SOCKET sockfd) {
+#ifdef SO_RXQ_OVFL
+  int one = 1;
+
+  return setsockopt(sockfd, SOL_SOCKET, SO_RXQ_OVFL, (const char *)&one, sizeof(one)) == 0;
+#else
+  return false;
+#endif
+}
+
+#ifndef __WXMSW__
+
+bool socketMessageInfo(struct msghdr *msg, wxLongLong *time_rec, uint32_t *drops) {
+  bool stamped = false;
+
+  *drops = 0;
+  for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET) {
+      continue;
+    }
+#ifdef SCM_TIMESTAMPNS
+    if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+      struct timespec ts;
+      memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+      *time_rec = wxLongLong((wxLongLong_t)ts.tv_sec * MILLISECONDS_PER_SECOND + ts.tv_nsec / 1000000);
+      stamped = true;
+    }
+#endif
+#ifdef SCM_TIMESTAMP
+    if (cmsg->cmsg_type == SCM_TIMESTAMP) {
+      struct timeval tv;
+      memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+      *time_rec = wxLongLong((wxLongLong_t)tv.tv_sec * MILLISECONDS_PER_SECOND + tv.tv_usec / 1000);
+      stamped = true;
+    }
+#endif
+#ifdef SO_RXQ_OVFL
+    if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+      memcpy(drops, CMSG_DATA(cmsg), sizeof(*drops));
+    }
+#endif
+  }
+  return stamped;
+}
+
+int socketReceive(SOCKET sockfd, uint8_t *data, size_t len, struct sockaddr *from, socklen_t *from_len, wxLongLong *time_rec,
+                  uint32_t *drops) {
+  struct iovec iov;
+  struct msghdr msg;
+  SocketControl control;
+
+  iov.iov_base = data;
+  iov.iov_len = len;
+  CLEAR_STRUCT(msg);
+  msg.msg_name = from;
+  msg.msg_namelen = from_len ? *from_len : 0;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+
+  int r = recvmsg(sockfd, &msg, 0);
+  if (r >= 0) {
+    if (from_len) {
+      *from_len = msg.msg_namelen;
+    }
+    if (!socketMessageInfo(&msg, time_rec, drops)) {
+      *time_rec = wxGetUTCTimeMillis();
+    }
+  }
+  return r;
+}
+
+#else
+
+int socketReceive(SOCKET sockfd, uint8_t *data, size_t len, struct sockaddr *from, socklen_t *from_len, wxLongLong *time_rec,
+                  uint32_t *drops) {
+  int r = recvfrom(sockfd, (char *)data, (int)len, 0, from, from_len);
+  *time_rec = wxGetUTCTimeMillis();
+  *drops = 0;
+  return r;
+}
+
+#endif
+
 #ifdef __WXMSW__
 
 int getifaddrs(struct ifaddrs **ifap) {
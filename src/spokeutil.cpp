@@ -0,0 +1,109 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Radar Plugin
+ * Author:   David Register
+ *           Dave Cowell
+ *           Kees Verruijt
+ *           Douwe Fokkema
+ *           Sean D'Epagnier
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register              bdbcat@yahoo.com *
+ *   Copyright (C) 2012-2013 by Dave Cowell                                *
+ *   Copyright (C) 2012-2016 by Kees Verruijt         canboat@verruijt.net *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ */
+
+#include "spokeutil.h"
+
+PLUGIN_BEGIN_NAMESPACE
+
+void UpdateTrueTrailSpoke(const PointInt *lookup, uint8_t *trails, size_t trail_size, int centre_x, int centre_y, uint8_t *data,
+                          size_t len, size_t len_max, uint8_t weak, uint8_t strong, uint8_t max_age, const uint8_t *trail_colour) {
+  size_t trail_len = len > 0 ? len - 1 : 0;  // len - 1 : no trails on range circle
+  size_t radius = 0;
+
+  for (; radius < trail_len; radius++) {
+    int x = lookup[radius].x + centre_x;
+    int y = lookup[radius].y + centre_y;
+
+    if (x >= 0 && x < (int)trail_size && y >= 0 && y < (int)trail_size) {
+      uint8_t *trail = &trails[x * trail_size + y];
+      if (data[radius] >= strong) {
+        *trail = 1;
+      } else if (*trail > 0 && *trail < max_age) {
+        (*trail)++;
+      }
+
+      if (trail_colour && data[radius] < weak) {
+        data[radius] = trail_colour[*trail];
+      }
+    }
+  }
+
+  // The rest of the spoke from len to len_max, only when the current spoke is
+  // shorter than the maximum: those points still age.
+  for (; radius < len_max; radius++) {
+    int x = lookup[radius].x + centre_x;
+    int y = lookup[radius].y + centre_y;
+
+    if (x >= 0 && x < (int)trail_size && y >= 0 && y < (int)trail_size) {
+      uint8_t *trail = &trails[x * trail_size + y];
+      if (*trail > 0 && *trail < max_age) {
+        (*trail)++;
+      }
+    }
+  }
+}
+
+void UpdateRelativeTrailSpoke(uint8_t *trail, uint8_t *data, size_t len, size_t len_max, uint8_t weak, uint8_t strong,
+                              uint8_t max_age, const uint8_t *trail_colour) {
+  size_t trail_len = len > 0 ? len - 1 : 0;  // len - 1 : no trails on range circle
+  size_t radius = 0;
+
+  for (; radius < trail_len; radius++, trail++) {
+    uint8_t sample = data[radius];
+    uint8_t age = *trail;
+
+    if (sample >= strong) {
+      age = 1;
+    } else if (age > 0 && age < max_age) {
+      age++;
+    }
+    *trail = age;
+    if (trail_colour && sample < weak) {
+      data[radius] = trail_colour[age];
+    }
+  }
+
+  for (; radius < len_max; radius++, trail++) {  // And clear out empty bit of spoke when len < len_max
+    *trail = 0;
+  }
+}
+
+size_t CountReturns(const uint8_t *data, size_t len, size_t r_first, size_t r_last, uint8_t threshold) {
+  size_t r_end = r_last < len ? r_last + 1 : len;
+  size_t count = 0;
+
+  for (size_t r = r_first; r < r_end; r++) {
+    count += data[r] >= threshold;
+  }
+  return count;
+}
+
+PLUGIN_END_NAMESPACE